@@ -42,12 +42,15 @@
         'clock_mock.cc',
         'cpu_stats.cc',
         'crash_report_util.cc',
+        'executor.cc',
         'iconv.cc',
         'process.cc',
         'process_mutex.cc',
         'run_level.cc',
         'scheduler.cc',
+        'startup_trace.cc',
         'stopwatch.cc',
+        'thread_pool.cc',
         'timer.cc',
         'unnamed_event.cc',
         'update_checker.cc',
@@ -83,8 +83,11 @@
         'codegen_bytearray_stream_test.cc',
         'cpu_stats_test.cc',
         'crash_report_util_test.cc',
+        'executor_test.cc',
         'process_mutex_test.cc',
+        'startup_trace_test.cc',
         'stopwatch_test.cc',
+        'thread_pool_test.cc',
         'timer_test.cc',
         'unnamed_event_test.cc',
         'update_util_test.cc',
@@ -187,6 +190,16 @@
         'test_size': 'small',
       },
     },
+    {
+      'target_name': 'util_benchmark_main',
+      'type': 'executable',
+      'sources': [
+        'util_benchmark_main.cc',
+      ],
+      'dependencies': [
+        'base.gyp:base',
+      ],
+    },
     {
       'target_name': 'number_util_test',
       'type': 'executable',
@@ -0,0 +1,421 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/executor.h"
+
+#include <algorithm>
+
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/thread.h"
+#include "base/unnamed_event.h"
+
+// One of the workers is reserved for HIGH tasks, so the default leaves two
+// workers for the periodic jobs of the scheduler, which must not block each
+// other.
+DEFINE_int32(executor_num_threads, 3,
+             "number of worker threads of the shared background executor");
+
+namespace mozc {
+namespace {
+// The timer thread wakes up at least once in this period, so that a long
+// delay never overflows the wait time.
+const int64 kMaxTimerWaitMsec = 60 * 60 * 1000;
+
+once_t g_executor_once = MOZC_ONCE_INIT;
+Executor *g_executor = NULL;
+
+void InitExecutor() {
+  g_executor = new Executor(max(1, FLAGS_executor_num_threads));
+}
+}  // namespace
+
+struct Executor::Entry {
+  TaskId id;
+  string name;
+  Task *task;
+  Priority priority;
+  uint32 interval_msec;
+  TaskState state;
+  // Due time while WAITING, the time it became due while QUEUED, and the
+  // time it started while RUNNING.
+  int64 state_usec;
+  bool cancelled;
+  uint32 run_count;
+  int64 last_queue_latency_usec;
+  int64 last_run_usec;
+  // Threads waiting in Cancel() or Wait().
+  vector<UnnamedEvent *> waiters;
+};
+
+class Executor::RunNextTask : public ThreadPool::Task {
+ public:
+  explicit RunNextTask(Executor *executor) : executor_(executor) {}
+  virtual ~RunNextTask() {}
+
+  virtual void Run() {
+    executor_->RunNext();
+  }
+
+ private:
+  Executor *executor_;
+
+  DISALLOW_COPY_AND_ASSIGN(RunNextTask);
+};
+
+class Executor::TimerThread : public Thread {
+ public:
+  explicit TimerThread(Executor *executor) : executor_(executor) {}
+  virtual ~TimerThread() {}
+
+  virtual void Run() {
+    while (true) {
+      bool stopped = false;
+      const int32 wait_msec = executor_->ProcessTimers(&stopped);
+      if (stopped) {
+        return;
+      }
+      // Schedule() and RunNext() call WakeUp() after they release the lock,
+      // so a timer added while ProcessTimers() computes |wait_msec| leaves
+      // the event signaled and the deadline is recomputed right away.
+      wakeup_.Wait(wait_msec);
+    }
+  }
+
+  void WakeUp() {
+    wakeup_.Notify();
+  }
+
+ private:
+  Executor *executor_;
+  UnnamedEvent wakeup_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerThread);
+};
+
+Executor::Executor(size_t num_workers)
+    : stopwatch_(Stopwatch::StartNew()),
+      next_id_(kInvalidTaskId + 1),
+      stopped_(false),
+      max_running_background_(num_workers > 1 ? num_workers - 1 : 1),
+      num_running_background_(0),
+      num_deferred_(0),
+      run_next_task_(new RunNextTask(this)),
+      pool_(new ThreadPool(num_workers)),
+      timer_thread_(new TimerThread(this)) {
+  timer_thread_->Start();
+}
+
+Executor::~Executor() {
+  {
+    scoped_lock l(&mutex_);
+    stopped_ = true;
+    timers_.clear();
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i) {
+      ready_[i].clear();
+    }
+    // Running entries are deleted by RunNext() when they finish.
+    map<TaskId, Entry *>::iterator it = entries_.begin();
+    while (it != entries_.end()) {
+      Entry *entry = it->second;
+      ++it;
+      if (entry->state != RUNNING) {
+        DeleteEntryLocked(entry);
+      }
+    }
+  }
+  timer_thread_->WakeUp();
+  timer_thread_->Join();
+  // Waits for the running tasks.
+  pool_.reset(NULL);
+  DCHECK(entries_.empty());
+}
+
+Executor *Executor::GetInstance() {
+  CallOnce(&g_executor_once, &InitExecutor);
+  return g_executor;
+}
+
+Executor::TaskId Executor::Schedule(const string &name, Task *task,
+                                    Priority priority, uint32 delay_msec,
+                                    uint32 interval_msec) {
+  DCHECK(task);
+  DCHECK_GE(priority, HIGH);
+  DCHECK_LT(priority, NUM_PRIORITIES);
+  TaskId id = kInvalidTaskId;
+  {
+    scoped_lock l(&mutex_);
+    if (stopped_) {
+      LOG(WARNING) << "Executor is stopping: " << name;
+      return kInvalidTaskId;
+    }
+    Entry *entry = new Entry;
+    id = next_id_++;
+    entry->id = id;
+    entry->name = name;
+    entry->task = task;
+    entry->priority = priority;
+    entry->interval_msec = interval_msec;
+    entry->cancelled = false;
+    entry->run_count = 0;
+    entry->last_queue_latency_usec = 0;
+    entry->last_run_usec = 0;
+    entries_[id] = entry;
+
+    const int64 now = GetElapsedMicroseconds();
+    if (delay_msec > 0) {
+      entry->state = WAITING;
+      entry->state_usec = now + delay_msec * static_cast<int64>(1000);
+      timers_.insert(make_pair(entry->state_usec, id));
+    } else {
+      EnqueueLocked(entry, now);
+    }
+  }
+  if (delay_msec > 0) {
+    timer_thread_->WakeUp();
+  } else {
+    pool_->Schedule(run_next_task_.get());
+  }
+  return id;
+}
+
+bool Executor::Cancel(TaskId id) {
+  UnnamedEvent done;
+  {
+    scoped_lock l(&mutex_);
+    map<TaskId, Entry *>::iterator it = entries_.find(id);
+    if (it == entries_.end()) {
+      return false;
+    }
+    Entry *entry = it->second;
+    switch (entry->state) {
+      case WAITING:
+        timers_.erase(make_pair(entry->state_usec, id));
+        DeleteEntryLocked(entry);
+        return true;
+      case QUEUED: {
+        deque<Entry *> *ready = &ready_[entry->priority];
+        ready->erase(find(ready->begin(), ready->end(), entry));
+        // RunNext() called for this entry will find another one or nothing.
+        DeleteEntryLocked(entry);
+        return true;
+      }
+      case RUNNING:
+        entry->cancelled = true;
+        entry->waiters.push_back(&done);
+        break;
+    }
+  }
+  done.Wait(-1);
+  // Waits for RunNext() to release the lock after notifying |done|.
+  scoped_lock l(&mutex_);
+  return true;
+}
+
+void Executor::Wait(TaskId id) {
+  UnnamedEvent done;
+  {
+    scoped_lock l(&mutex_);
+    map<TaskId, Entry *>::iterator it = entries_.find(id);
+    if (it == entries_.end()) {
+      return;
+    }
+    it->second->waiters.push_back(&done);
+  }
+  done.Wait(-1);
+  scoped_lock l(&mutex_);
+}
+
+bool Executor::IsPending(TaskId id) const {
+  scoped_lock l(&mutex_);
+  return entries_.find(id) != entries_.end();
+}
+
+void Executor::GetTaskInfo(vector<TaskInfo> *infos) const {
+  DCHECK(infos);
+  infos->clear();
+  scoped_lock l(&mutex_);
+  const int64 now = GetElapsedMicroseconds();
+  for (map<TaskId, Entry *>::const_iterator it = entries_.begin();
+       it != entries_.end(); ++it) {
+    const Entry &entry = *it->second;
+    TaskInfo info;
+    info.name = entry.name;
+    info.priority = entry.priority;
+    info.state = entry.state;
+    info.latency_usec = (entry.state == WAITING) ?
+        entry.state_usec - now : now - entry.state_usec;
+    info.run_count = entry.run_count;
+    info.last_queue_latency_usec = entry.last_queue_latency_usec;
+    info.last_run_usec = entry.last_run_usec;
+    infos->push_back(info);
+  }
+}
+
+int64 Executor::GetElapsedMicroseconds() const {
+  return static_cast<int64>(stopwatch_.GetElapsedMicroseconds());
+}
+
+void Executor::EnqueueLocked(Entry *entry, int64 now) {
+  entry->state = QUEUED;
+  entry->state_usec = now;
+  ready_[entry->priority].push_back(entry);
+}
+
+void Executor::DeleteEntryLocked(Entry *entry) {
+  entries_.erase(entry->id);
+  // Notifies while holding the lock. See BlockingCounter::DecrementCount().
+  for (size_t i = 0; i < entry->waiters.size(); ++i) {
+    entry->waiters[i]->Notify();
+  }
+  delete entry;
+}
+
+void Executor::RunNext() {
+  Entry *entry = NULL;
+  {
+    scoped_lock l(&mutex_);
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i) {
+      if (ready_[i].empty()) {
+        continue;
+      }
+      if (i != HIGH && num_running_background_ >= max_running_background_) {
+        // Keeps the last worker for HIGH entries.  The entry is run when one
+        // of the running NORMAL or LOW entries finishes.
+        ++num_deferred_;
+        return;
+      }
+      entry = ready_[i].front();
+      ready_[i].pop_front();
+      break;
+    }
+    if (entry == NULL) {
+      // The entry was cancelled.
+      return;
+    }
+    if (entry->priority != HIGH) {
+      ++num_running_background_;
+    }
+    const int64 now = GetElapsedMicroseconds();
+    entry->last_queue_latency_usec = now - entry->state_usec;
+    entry->state = RUNNING;
+    entry->state_usec = now;
+  }
+
+  VLOG(2) << "Running " << entry->name;
+  entry->task->Run();
+
+  bool timer_added = false;
+  bool run_deferred = false;
+  {
+    scoped_lock l(&mutex_);
+    if (entry->priority != HIGH) {
+      --num_running_background_;
+      if (num_deferred_ > 0 && !stopped_) {
+        --num_deferred_;
+        run_deferred = true;
+      }
+    }
+    const int64 now = GetElapsedMicroseconds();
+    ++entry->run_count;
+    entry->last_run_usec = now - entry->state_usec;
+    if (entry->interval_msec > 0 && !entry->cancelled && !stopped_) {
+      entry->state = WAITING;
+      entry->state_usec =
+          now + entry->interval_msec * static_cast<int64>(1000);
+      timers_.insert(make_pair(entry->state_usec, entry->id));
+      timer_added = true;
+    } else {
+      DeleteEntryLocked(entry);
+    }
+  }
+  if (timer_added) {
+    timer_thread_->WakeUp();
+  }
+  if (run_deferred) {
+    pool_->Schedule(run_next_task_.get());
+  }
+}
+
+int32 Executor::ProcessTimers(bool *stopped) {
+  size_t num_due = 0;
+  int32 wait_msec = -1;
+  {
+    scoped_lock l(&mutex_);
+    *stopped = stopped_;
+    if (stopped_) {
+      return -1;
+    }
+    const int64 now = GetElapsedMicroseconds();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+      map<TaskId, Entry *>::iterator it =
+          entries_.find(timers_.begin()->second);
+      timers_.erase(timers_.begin());
+      DCHECK(it != entries_.end());
+      EnqueueLocked(it->second, now);
+      ++num_due;
+    }
+    if (!timers_.empty()) {
+      // Rounds up not to wake up before the next timer is due.
+      wait_msec = static_cast<int32>(min(
+          (timers_.begin()->first - now + 999) / 1000, kMaxTimerWaitMsec));
+    }
+  }
+  for (size_t i = 0; i < num_due; ++i) {
+    pool_->Schedule(run_next_task_.get());
+  }
+  return wait_msec;
+}
+
+BackgroundTask::BackgroundTask(const string &name,
+                               Executor::Priority priority)
+    : name_(name), priority_(priority), id_(Executor::kInvalidTaskId) {}
+
+BackgroundTask::~BackgroundTask() {}
+
+void BackgroundTask::Start() {
+  if (IsRunning()) {
+    return;
+  }
+  id_ = Executor::GetInstance()->Schedule(name_, this, priority_, 0, 0);
+}
+
+void BackgroundTask::Join() {
+  if (id_ != Executor::kInvalidTaskId) {
+    Executor::GetInstance()->Wait(id_);
+  }
+}
+
+bool BackgroundTask::IsRunning() const {
+  return id_ != Executor::kInvalidTaskId &&
+      Executor::GetInstance()->IsPending(id_);
+}
+
+}  // namespace mozc
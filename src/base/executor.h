@@ -0,0 +1,209 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_BASE_EXECUTOR_H_
+#define MOZC_BASE_EXECUTOR_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/scoped_ptr.h"
+#include "base/stopwatch.h"
+#include "base/thread_pool.h"
+
+namespace mozc {
+
+class UnnamedEvent;
+
+// Runs background tasks of the process on a small fixed number of worker
+// threads.  Delayed and periodic tasks wait in a timer queue handled by a
+// single timer thread, so idle tasks don't occupy any thread.  When several
+// tasks are due at the same time, tasks with higher priority run first.
+// With two or more workers, one of them is reserved for HIGH tasks: NORMAL
+// and LOW tasks never occupy all the workers, so a HIGH task such as a
+// dictionary load starts as soon as it is due even while long NORMAL or LOW
+// tasks are running.  HIGH tasks may still delay each other.
+//
+// Usage:
+//   class MyTask : public Executor::Task {
+//    public:
+//     virtual void Run() { ... }
+//   };
+//
+//   MyTask task;
+//   Executor *executor = Executor::GetInstance();
+//   // Runs the task after 1 sec, and then every minute.
+//   const Executor::TaskId id = executor->Schedule(
+//       "MyTask", &task, Executor::NORMAL, 1000, 60 * 1000);
+//   ...
+//   executor->Cancel(id);
+class Executor {
+ public:
+  class Task {
+   public:
+    virtual ~Task() {}
+    virtual void Run() = 0;
+  };
+
+  enum Priority {
+    HIGH = 0,
+    NORMAL = 1,
+    LOW = 2,
+    NUM_PRIORITIES = 3,
+  };
+
+  enum TaskState {
+    WAITING,  // waiting in the timer queue
+    QUEUED,   // due and waiting for a worker
+    RUNNING,
+  };
+
+  // Snapshot of a registered task for debugging.
+  struct TaskInfo {
+    string name;
+    Priority priority;
+    TaskState state;
+    // WAITING: time until the task is due.  QUEUED: time since the task
+    // became due.  RUNNING: time since the task started.
+    int64 latency_usec;
+    uint32 run_count;
+    // Queueing delay and duration of the last run.
+    int64 last_queue_latency_usec;
+    int64 last_run_usec;
+  };
+
+  typedef uint64 TaskId;
+  static const TaskId kInvalidTaskId = 0;
+
+  // Starts |num_workers| worker threads and the timer thread.
+  explicit Executor(size_t num_workers);
+
+  // Drops the tasks not running yet and waits for the running ones.
+  ~Executor();
+
+  // Returns the executor shared by the process.  The number of its workers
+  // is given by --executor_num_threads.  It is never destroyed, so tasks can
+  // be waited for from destructors of other singletons.
+  static Executor *GetInstance();
+
+  // Runs |task| after |delay_msec|, and then every |interval_msec| after the
+  // previous run finishes if |interval_msec| is not zero.  |name| is used for
+  // debugging.  |task| is not owned and must be alive until it finishes or
+  // Cancel() returns.  Returns kInvalidTaskId if the executor is stopping.
+  TaskId Schedule(const string &name, Task *task, Priority priority,
+                  uint32 delay_msec, uint32 interval_msec);
+
+  // Removes the task.  If the task is running, waits for it to finish.
+  // Returns false if the task has already finished.  Don't call this method
+  // from the task itself.
+  bool Cancel(TaskId id);
+
+  // Waits until the task finishes.  Periodic tasks finish only when they are
+  // cancelled.  Don't call this method from the task itself.
+  void Wait(TaskId id);
+
+  // Returns true until the task finishes or is cancelled.
+  bool IsPending(TaskId id) const;
+
+  // Returns the registered tasks ordered by id.
+  void GetTaskInfo(vector<TaskInfo> *infos) const;
+
+  size_t num_workers() const {
+    return pool_->num_threads();
+  }
+
+ private:
+  class TimerThread;
+  class RunNextTask;
+  struct Entry;
+
+  int64 GetElapsedMicroseconds() const;
+  void EnqueueLocked(Entry *entry, int64 now);
+  void DeleteEntryLocked(Entry *entry);
+  // Pops the highest priority entry due and runs it.  A NORMAL or LOW entry
+  // is left in the queue when it would occupy the worker reserved for HIGH
+  // entries.  Called by the workers.
+  void RunNext();
+  // Moves the due entries to the ready queues, and returns the time to the
+  // next due entry in msec, or -1 if there is none.  Called by the timer
+  // thread.  |*stopped| is set to true if the executor is stopping.
+  int32 ProcessTimers(bool *stopped);
+
+  mutable Mutex mutex_;
+  mutable Stopwatch stopwatch_;
+  TaskId next_id_;
+  bool stopped_;
+  map<TaskId, Entry *> entries_;
+  // Pairs of the due time and the id of WAITING entries.
+  set<pair<int64, TaskId> > timers_;
+  deque<Entry *> ready_[NUM_PRIORITIES];
+  // Number of workers NORMAL and LOW entries may occupy at the same time.
+  const size_t max_running_background_;
+  size_t num_running_background_;
+  // Number of RunNext() calls which left a NORMAL or LOW entry in the queue.
+  // As many calls are scheduled again when such entries finish.
+  size_t num_deferred_;
+  scoped_ptr<RunNextTask> run_next_task_;
+  scoped_ptr<ThreadPool> pool_;
+  scoped_ptr<TimerThread> timer_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(Executor);
+};
+
+// A one-shot task run on the shared executor, with the Start(), Join() and
+// IsRunning() methods of Thread.  Subclasses should call Join() in their
+// destructors like Thread subclasses do.
+class BackgroundTask : public Executor::Task {
+ public:
+  BackgroundTask(const string &name, Executor::Priority priority);
+  virtual ~BackgroundTask();
+
+  // Does nothing if the task is already running.
+  void Start();
+  void Join();
+  bool IsRunning() const;
+
+ private:
+  const string name_;
+  const Executor::Priority priority_;
+  Executor::TaskId id_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundTask);
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_EXECUTOR_H_
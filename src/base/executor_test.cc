@@ -0,0 +1,292 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/executor.h"
+
+#include <string>
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/unnamed_event.h"
+#include "base/util.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace {
+
+// Blocks the worker running it until Release() is called.
+class GateTask : public Executor::Task {
+ public:
+  GateTask() {}
+
+  virtual void Run() {
+    started_.Notify();
+    released_.Wait(-1);
+  }
+
+  void WaitUntilStarted() {
+    started_.Wait(-1);
+  }
+
+  void Release() {
+    released_.Notify();
+  }
+
+ private:
+  UnnamedEvent started_;
+  UnnamedEvent released_;
+
+  DISALLOW_COPY_AND_ASSIGN(GateTask);
+};
+
+class RecordingTask : public Executor::Task {
+ public:
+  RecordingTask(const string &name, Mutex *mutex, vector<string> *log)
+      : name_(name), mutex_(mutex), log_(log) {}
+
+  virtual void Run() {
+    scoped_lock l(mutex_);
+    log_->push_back(name_);
+  }
+
+  int count() const {
+    scoped_lock l(mutex_);
+    int count = 0;
+    for (size_t i = 0; i < log_->size(); ++i) {
+      if ((*log_)[i] == name_) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+ private:
+  const string name_;
+  Mutex *mutex_;
+  vector<string> *log_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingTask);
+};
+
+class SleepingTask : public Executor::Task {
+ public:
+  explicit SleepingTask(uint32 msec) : msec_(msec), finished_(false) {}
+
+  virtual void Run() {
+    Util::Sleep(msec_);
+    finished_ = true;
+  }
+
+  bool finished() const {
+    return finished_;
+  }
+
+ private:
+  const uint32 msec_;
+  volatile bool finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(SleepingTask);
+};
+
+TEST(ExecutorTest, RunsHigherPriorityFirst) {
+  Executor executor(1);
+  Mutex mutex;
+  vector<string> log;
+  GateTask gate;
+  RecordingTask low("low", &mutex, &log);
+  RecordingTask normal("normal", &mutex, &log);
+  RecordingTask high("high", &mutex, &log);
+
+  executor.Schedule("gate", &gate, Executor::NORMAL, 0, 0);
+  gate.WaitUntilStarted();
+  const Executor::TaskId low_id =
+      executor.Schedule("low", &low, Executor::LOW, 0, 0);
+  executor.Schedule("normal", &normal, Executor::NORMAL, 0, 0);
+  executor.Schedule("high", &high, Executor::HIGH, 0, 0);
+  gate.Release();
+  executor.Wait(low_id);
+
+  ASSERT_EQ(3, log.size());
+  EXPECT_EQ("high", log[0]);
+  EXPECT_EQ("normal", log[1]);
+  EXPECT_EQ("low", log[2]);
+}
+
+TEST(ExecutorTest, ReservesWorkerForHighPriority) {
+  Executor executor(2);
+  Mutex mutex;
+  vector<string> log;
+  GateTask gate;
+  RecordingTask low("low", &mutex, &log);
+  RecordingTask high("high", &mutex, &log);
+
+  const Executor::TaskId gate_id =
+      executor.Schedule("gate", &gate, Executor::LOW, 0, 0);
+  gate.WaitUntilStarted();
+  const Executor::TaskId low_id =
+      executor.Schedule("low", &low, Executor::LOW, 0, 0);
+  const Executor::TaskId high_id =
+      executor.Schedule("high", &high, Executor::HIGH, 0, 0);
+
+  // The second worker is idle but only runs the HIGH task.
+  executor.Wait(high_id);
+  EXPECT_EQ(1, high.count());
+  Util::Sleep(100);
+  EXPECT_EQ(0, low.count());
+  EXPECT_TRUE(executor.IsPending(low_id));
+
+  gate.Release();
+  executor.Wait(gate_id);
+  executor.Wait(low_id);
+  EXPECT_EQ(1, low.count());
+}
+
+TEST(ExecutorTest, DelayedAndPeriodicTasks) {
+  Executor executor(2);
+  Mutex mutex;
+  vector<string> log;
+  RecordingTask delayed("delayed", &mutex, &log);
+  RecordingTask periodic("periodic", &mutex, &log);
+
+  const Executor::TaskId delayed_id =
+      executor.Schedule("delayed", &delayed, Executor::NORMAL, 200, 0);
+  const Executor::TaskId periodic_id =
+      executor.Schedule("periodic", &periodic, Executor::NORMAL, 0, 100);
+  Util::Sleep(50);
+  EXPECT_EQ(0, delayed.count());
+  EXPECT_TRUE(executor.IsPending(delayed_id));
+
+  executor.Wait(delayed_id);
+  EXPECT_EQ(1, delayed.count());
+  EXPECT_FALSE(executor.IsPending(delayed_id));
+  EXPECT_FALSE(executor.Cancel(delayed_id));
+
+  Util::Sleep(300);
+  EXPECT_LE(3, periodic.count());
+  EXPECT_TRUE(executor.Cancel(periodic_id));
+  EXPECT_FALSE(executor.IsPending(periodic_id));
+  const int count = periodic.count();
+  Util::Sleep(300);
+  EXPECT_EQ(count, periodic.count());
+}
+
+TEST(ExecutorTest, CancelWaitsForRunningTask) {
+  Executor executor(1);
+  SleepingTask task(300);
+  const Executor::TaskId id =
+      executor.Schedule("sleeping", &task, Executor::NORMAL, 0, 1000);
+  Util::Sleep(100);
+  EXPECT_TRUE(executor.Cancel(id));
+  EXPECT_TRUE(task.finished());
+}
+
+TEST(ExecutorTest, CancelQueuedTask) {
+  Executor executor(1);
+  Mutex mutex;
+  vector<string> log;
+  GateTask gate;
+  RecordingTask queued("queued", &mutex, &log);
+  RecordingTask waiting("waiting", &mutex, &log);
+
+  const Executor::TaskId gate_id =
+      executor.Schedule("gate", &gate, Executor::NORMAL, 0, 0);
+  gate.WaitUntilStarted();
+  const Executor::TaskId queued_id =
+      executor.Schedule("queued", &queued, Executor::NORMAL, 0, 0);
+  const Executor::TaskId waiting_id =
+      executor.Schedule("waiting", &waiting, Executor::NORMAL, 60 * 1000, 0);
+
+  vector<Executor::TaskInfo> infos;
+  executor.GetTaskInfo(&infos);
+  ASSERT_EQ(3, infos.size());
+  EXPECT_EQ("gate", infos[0].name);
+  EXPECT_EQ(Executor::RUNNING, infos[0].state);
+  EXPECT_EQ("queued", infos[1].name);
+  EXPECT_EQ(Executor::QUEUED, infos[1].state);
+  EXPECT_EQ("waiting", infos[2].name);
+  EXPECT_EQ(Executor::WAITING, infos[2].state);
+  EXPECT_LT(0, infos[2].latency_usec);
+
+  EXPECT_TRUE(executor.Cancel(queued_id));
+  EXPECT_TRUE(executor.Cancel(waiting_id));
+  gate.Release();
+  executor.Wait(gate_id);
+
+  executor.GetTaskInfo(&infos);
+  EXPECT_TRUE(infos.empty());
+  EXPECT_TRUE(log.empty());
+}
+
+class CountingBackgroundTask : public BackgroundTask {
+ public:
+  CountingBackgroundTask()
+      : BackgroundTask("CountingBackgroundTask", Executor::NORMAL),
+        count_(0) {}
+
+  virtual ~CountingBackgroundTask() {
+    Join();
+  }
+
+  virtual void Run() {
+    Util::Sleep(100);
+    ++count_;
+  }
+
+  int count() const {
+    return count_;
+  }
+
+ private:
+  volatile int count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingBackgroundTask);
+};
+
+TEST(ExecutorTest, BackgroundTask) {
+  CountingBackgroundTask task;
+  EXPECT_FALSE(task.IsRunning());
+  task.Join();
+
+  task.Start();
+  EXPECT_TRUE(task.IsRunning());
+  // Does nothing while running.
+  task.Start();
+  task.Join();
+  EXPECT_FALSE(task.IsRunning());
+  EXPECT_EQ(1, task.count());
+
+  task.Start();
+  task.Join();
+  EXPECT_EQ(2, task.count());
+}
+
+}  // namespace
+}  // namespace mozc
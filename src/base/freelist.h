@@ -47,7 +47,8 @@ namespace mozc {
 template <class T> class FreeList {
  public:
   explicit FreeList(size_t size)
-      : current_index_(0), chunk_index_(0), size_(size) {
+      : current_index_(0), chunk_index_(0), size_(size),
+        allocation_counter_(NULL) {
   }
 
   ~FreeList() {
@@ -56,6 +57,8 @@ template <class T> class FreeList {
     }
   }
 
+  // Makes all the chunks available again without releasing them.  Note that
+  // the objects are not destructed either, so they keep their contents.
   void Reset() {
     chunk_index_ = current_index_ = 0;
   }
@@ -83,6 +86,9 @@ template <class T> class FreeList {
 
     if (chunk_index_ == pool_.size()) {
       pool_.push_back(new T[size_]);
+      if (allocation_counter_ != NULL) {
+        ++*allocation_counter_;
+      }
     }
 
     T* r = pool_[chunk_index_] + current_index_;
@@ -94,11 +100,18 @@ template <class T> class FreeList {
     size_ = size;
   }
 
+  // Increments |*counter| every time a new chunk is allocated.
+  // |counter| can be NULL and is not owned.
+  void set_allocation_counter(size_t *counter) {
+    allocation_counter_ = counter;
+  }
+
  private:
   vector<T *> pool_;
   size_t current_index_;
   size_t chunk_index_;
   size_t size_;
+  size_t *allocation_counter_;
 
   DISALLOW_COPY_AND_ASSIGN(FreeList);
 };
@@ -116,6 +129,12 @@ template <class T> class ObjectPool {
     freelist_.Free();
   }
 
+  // Same as Free() but keeps all the allocated objects for reuse.
+  void Reset() {
+    released_.clear();
+    freelist_.Reset();
+  }
+
   T* Alloc() {
     if (!released_.empty()) {
       T *result = released_.back();
@@ -133,6 +152,10 @@ template <class T> class ObjectPool {
     freelist_.set_size(size);
   }
 
+  void set_allocation_counter(size_t *counter) {
+    freelist_.set_allocation_counter(counter);
+  }
+
  private:
   vector<T *> released_;
   FreeList<T> freelist_;
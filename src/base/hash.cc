@@ -28,6 +28,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string.h>
+#include <algorithm>
 #include <string>
 #include "base/util.h"
 
@@ -71,26 +72,23 @@ uint32 Util::Fingerprint32WithSeed(const string &key,
                                seed);
 }
 
-uint32 Util::Fingerprint32WithSeed(const char *str,
-                                   size_t length,
-                                   uint32 seed) {
-  uint32 len = static_cast<uint32>(length);
-  uint32 a = 0x9e3779b9;
-  uint32 b = a;
-  uint32 c = seed;
+namespace {
 
-  while (len >= 12) {
-    a += (str[0] + ((uint32)str[1] << 8) + ((uint32)str[2] << 16)
-          + ((uint32)str[3] << 24));
-    b += (str[4] + ((uint32)str[5] << 8) + ((uint32)str[6] << 16)
-          + ((uint32)str[7] << 24));
-    c += (str[8] + ((uint32)str[9] << 8) + ((uint32)str[10] << 16)
-          + ((uint32)str[11] << 24));
-    mix(a, b, c);
-    str += 12;
-    len -= 12;
-  }
+// Mixes a 12-byte block of the input into the state (a, b, c).
+inline void MixBlock(const char *str, uint32 *a, uint32 *b, uint32 *c) {
+  *a += (str[0] + ((uint32)str[1] << 8) + ((uint32)str[2] << 16)
+         + ((uint32)str[3] << 24));
+  *b += (str[4] + ((uint32)str[5] << 8) + ((uint32)str[6] << 16)
+         + ((uint32)str[7] << 24));
+  *c += (str[8] + ((uint32)str[9] << 8) + ((uint32)str[10] << 16)
+         + ((uint32)str[11] << 24));
+  mix(*a, *b, *c);
+}
 
+// Mixes the last |len| (< 12) bytes of the input and the total |length| of
+// the input into the state, and returns the fingerprint.
+inline uint32 MixTail(const char *str, uint32 len, size_t length,
+                      uint32 a, uint32 b, uint32 c) {
   c += static_cast<uint32>(length);
   switch (len) {
     case 11:
@@ -132,6 +130,33 @@ uint32 Util::Fingerprint32WithSeed(const char *str,
   return c;
 }
 
+inline uint64 CombineFingerprint32(uint32 hi, uint32 lo) {
+  uint64 result = static_cast<uint64>(hi) << 32 | static_cast<uint64>(lo);
+  if ((hi == 0) && (lo < 2)) {
+    result ^= GG_ULONGLONG(0x130f9bef94a0a928);
+  }
+  return result;
+}
+
+}  // namespace
+
+uint32 Util::Fingerprint32WithSeed(const char *str,
+                                   size_t length,
+                                   uint32 seed) {
+  uint32 len = static_cast<uint32>(length);
+  uint32 a = 0x9e3779b9;
+  uint32 b = a;
+  uint32 c = seed;
+
+  while (len >= 12) {
+    MixBlock(str, &a, &b, &c);
+    str += 12;
+    len -= 12;
+  }
+
+  return MixTail(str, len, length, a, b, c);
+}
+
 uint32 Util::Fingerprint32WithSeed(const char *str,
                                    uint32 seed) {
   return Fingerprint32WithSeed(str, strlen(str), seed);
@@ -157,11 +182,66 @@ uint64 Util::FingerprintWithSeed(const string &str, uint32 seed) {
 uint64 Util::FingerprintWithSeed(const char *str, size_t length, uint32 seed) {
   const uint32 hi = Fingerprint32WithSeed(str, length, seed);
   const uint32 lo = Fingerprint32WithSeed(str, length, kFingerPrintSeed1);
-  uint64 result = static_cast<uint64>(hi) << 32 | static_cast<uint64>(lo);
-  if ((hi == 0) && (lo < 2)) {
-    result ^= GG_ULONGLONG(0x130f9bef94a0a928);
+  return CombineFingerprint32(hi, lo);
+}
+
+FingerprintBuilder::FingerprintBuilder(uint32 seed)
+    : buffer_size_(0), length_(0) {
+  hi_[0] = hi_[1] = lo_[0] = lo_[1] = 0x9e3779b9;
+  hi_[2] = seed;
+  lo_[2] = kFingerPrintSeed1;
+}
+
+void FingerprintBuilder::Append(StringPiece str) {
+  const char *data = str.data();
+  size_t size = str.size();
+  length_ += size;
+
+  // Fills the pending block first.
+  if (buffer_size_ > 0) {
+    const size_t copy_size = min(size, sizeof(buffer_) - buffer_size_);
+    memcpy(buffer_ + buffer_size_, data, copy_size);
+    buffer_size_ += copy_size;
+    data += copy_size;
+    size -= copy_size;
+    if (buffer_size_ < sizeof(buffer_)) {
+      return;
+    }
+    MixBuffer(buffer_);
+    buffer_size_ = 0;
   }
-  return result;
+
+  // The last block, even if complete, is kept pending because the final
+  // block is mixed with the total length in Get().
+  while (size > sizeof(buffer_)) {
+    MixBuffer(data);
+    data += sizeof(buffer_);
+    size -= sizeof(buffer_);
+  }
+  memcpy(buffer_, data, size);
+  buffer_size_ = size;
+}
+
+uint64 FingerprintBuilder::Get() const {
+  // Util::Fingerprint32WithSeed() mixes complete blocks only while 12 or
+  // more bytes remain, so a complete pending block is mixed here.
+  const char *tail = buffer_;
+  uint32 tail_size = static_cast<uint32>(buffer_size_);
+  uint32 hi[3] = { hi_[0], hi_[1], hi_[2] };
+  uint32 lo[3] = { lo_[0], lo_[1], lo_[2] };
+  if (tail_size == sizeof(buffer_)) {
+    MixBlock(tail, &hi[0], &hi[1], &hi[2]);
+    MixBlock(tail, &lo[0], &lo[1], &lo[2]);
+    tail_size = 0;
+  }
+  return CombineFingerprint32(
+      MixTail(tail, tail_size, length_, hi[0], hi[1], hi[2]),
+      MixTail(tail, tail_size, length_, lo[0], lo[1], lo[2]));
+}
+
+void FingerprintBuilder::MixBuffer(const char *block) {
+  MixBlock(block, &hi_[0], &hi_[1], &hi_[2]);
+  MixBlock(block, &lo_[0], &lo_[1], &lo_[2]);
 }
 
 }  // namespace mozc
@@ -64,6 +64,14 @@ struct hash<std::string> {
     return result;
   }
 };
+
+// Fingerprints (uint64) are already well distributed.
+template <>
+struct hash<unsigned long long> {
+  std::size_t operator()(unsigned long long x) const {
+    return static_cast<std::size_t>(x ^ (x >> 32));
+  }
+};
 }
 #endif  // not OS_WIN
 
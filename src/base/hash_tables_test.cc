@@ -28,6 +28,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "base/hash_tables.h"
+#include "base/port.h"
 #include "testing/base/public/gunit.h"
 
 TEST(HashTables, HashMap) {
@@ -41,3 +42,10 @@ TEST(HashTables, HashSet) {
   test_set.insert("test");
   EXPECT_EQ(1, test_set.count("test"));
 }
+
+TEST(HashTables, HashSetOfUint64) {
+  hash_set<uint64> test_set;
+  test_set.insert(GG_ULONGLONG(0x123456789abcdef0));
+  EXPECT_EQ(1, test_set.count(GG_ULONGLONG(0x123456789abcdef0)));
+  EXPECT_EQ(0, test_set.count(GG_ULONGLONG(0x123456789abcdef1)));
+}
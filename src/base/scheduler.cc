@@ -33,60 +33,48 @@
 #include <map>
 #include <utility>
 
+#include "base/executor.h"
 #include "base/logging.h"
 #include "base/mutex.h"
 #include "base/port.h"
-#include "base/scoped_ptr.h"
 #include "base/singleton.h"
-#include "base/timer.h"
 #include "base/util.h"
 
 namespace mozc {
 namespace {
-class QueueTimer : public Timer {
- public:
-  QueueTimer(void (*callback)(void *),  // NOLINT
-             void *arg,
-             uint32 due_time,
-             uint32 period)
-  : callback_(callback),
-    arg_(arg),
-    due_time_(due_time),
-    period_(period) {
-  }
-
-  virtual ~QueueTimer() {}
-
-  bool Start() {
-    return Timer::Start(due_time_, period_);
-  }
-
-  virtual void Signaled() {
-    callback_(arg_);
-  }
-
- private:
-  void (*callback_)(void *);
-  void *arg_;
-  uint32 due_time_;
-  uint32 period_;
-
-  DISALLOW_COPY_AND_ASSIGN(QueueTimer);
-};
-
-class Job {
+class Job : public Executor::Task {
  public:
   explicit Job(const Scheduler::JobSetting &setting) :
       setting_(setting),
       skip_count_(0),
       backoff_count_(0),
-      timer_(NULL),
+      task_id_(Executor::kInvalidTaskId),
       running_(false) {}
 
-  ~Job() {
-    set_timer(NULL);
+  virtual ~Job() {
+    Stop();
+  }
+
+  // Runs the job on the shared executor after |delay| msec, and then every
+  // default_interval() msec.
+  bool Start(uint32 delay) {
+    Stop();
+    task_id_ = Executor::GetInstance()->Schedule(
+        setting_.name(), this, Executor::LOW, delay,
+        setting_.default_interval());
+    return task_id_ != Executor::kInvalidTaskId;
+  }
+
+  // Waits for the running callback if any.
+  void Stop() {
+    if (task_id_ != Executor::kInvalidTaskId) {
+      Executor::GetInstance()->Cancel(task_id_);
+      task_id_ = Executor::kInvalidTaskId;
+    }
   }
 
+  virtual void Run();
+
   const Scheduler::JobSetting setting() const {
     return setting_;
   }
@@ -107,21 +95,6 @@ class Job {
     return backoff_count_;
   }
 
-  void set_timer(QueueTimer *timer) {
-    if (timer_ != NULL) {
-      delete timer_;
-    }
-    timer_ = timer;
-  }
-
-  const QueueTimer *timer() const {
-    return timer_;
-  }
-
-  QueueTimer *mutable_timer() {
-    return timer_;
-  }
-
   void set_running(bool running) {
     running_ = running;
   }
@@ -134,12 +107,40 @@ class Job {
   Scheduler::JobSetting setting_;
   uint32 skip_count_;
   uint32 backoff_count_;
-  QueueTimer *timer_;
+  Executor::TaskId task_id_;
   bool running_;
 
-  // TODO(hsumita): Use DISALLOW_COPY_AND_ASSIGN(Job).
+  DISALLOW_COPY_AND_ASSIGN(Job);
 };
 
+void Job::Run() {
+  if (running()) {
+    return;
+  }
+  if (skip_count()) {
+    set_skip_count(skip_count() - 1);
+    VLOG(3) << "Backoff = " << backoff_count()
+            << " skip_count = " << skip_count();
+    return;
+  }
+  set_running(true);
+  Scheduler::JobSetting::CallbackFunc callback = setting().callback();
+  DCHECK(callback != NULL);
+  const bool success = callback(setting().data());
+  set_running(false);
+  if (success) {
+    set_backoff_count(0);
+  } else {
+    const uint32 new_backoff_count = (backoff_count() == 0) ?
+        1 : backoff_count() * 2;
+    if (new_backoff_count * setting().default_interval()
+        < setting().max_interval()) {
+      set_backoff_count(new_backoff_count);
+    }
+    set_skip_count(backoff_count());
+  }
+}
+
 class SchedulerImpl : public Scheduler::SchedulerInterface {
  public:
   SchedulerImpl() {
@@ -152,6 +153,10 @@ class SchedulerImpl : public Scheduler::SchedulerInterface {
 
   virtual void RemoveAllJobs() {
     scoped_lock l(&mutex_);
+    for (map<string, Job *>::iterator it = jobs_.begin();
+         it != jobs_.end(); ++it) {
+      delete it->second;
+    }
     jobs_.clear();
   }
 
@@ -172,73 +177,29 @@ class SchedulerImpl : public Scheduler::SchedulerInterface {
       return false;
     }
 
-    pair<map<string, Job>::iterator, bool> insert_result
-        = jobs_.insert(make_pair(job_setting.name(), Job(job_setting)));
-    if (!insert_result.second) {
-      LOG(ERROR) << "insert failed";
-      return false;
-    }
-    Job *job = &insert_result.first->second;
-    DCHECK(job);
-
-    const uint32 delay = CalcDelay(job_setting);
-    // DON'T copy job instance after set_timer() not to delete timer twice.
-    // TODO(hsumita): Make Job class uncopiable.
-    job->set_timer(new QueueTimer(&TimerCallback, job, delay,
-                                  job_setting.default_interval()));
-    if (job->timer() == NULL) {
-      LOG(ERROR) << "failed to create QueueTimer";
-      return false;
-    }
-    const bool started = job->mutable_timer()->Start();
-    if (started) {
-      return true;
-    } else {
-      job->set_timer(NULL);
+    Job *job = new Job(job_setting);
+    if (!job->Start(CalcDelay(job_setting))) {
+      LOG(ERROR) << "failed to start " << job_setting.name();
+      delete job;
       return false;
     }
+    jobs_[job_setting.name()] = job;
+    return true;
   }
 
   virtual bool RemoveJob(const string &name) {
     scoped_lock l(&mutex_);
-    if (!HasJob(name)) {
+    map<string, Job *>::iterator it = jobs_.find(name);
+    if (it == jobs_.end()) {
       LOG(WARNING) << "Job " << name << " is not registered";
       return false;
     }
-    return (jobs_.erase(name) != 0);
+    delete it->second;
+    jobs_.erase(it);
+    return true;
   }
 
  private:
-  static void TimerCallback(void *param) {
-    Job *job = reinterpret_cast<Job *>(param);
-    DCHECK(job);
-    if (job->running()) {
-      return;
-    }
-    if (job->skip_count()) {
-      job->set_skip_count(job->skip_count() - 1);
-      VLOG(3) << "Backoff = " << job->backoff_count()
-              << " skip_count = " << job->skip_count();
-      return;
-    }
-    job->set_running(true);
-    Scheduler::JobSetting::CallbackFunc callback = job->setting().callback();
-    DCHECK(callback != NULL);
-    const bool success = callback(job->setting().data());
-    job->set_running(false);
-    if (success) {
-      job->set_backoff_count(0);
-    } else {
-      const uint32 new_backoff_count = (job->backoff_count() == 0) ?
-          1 : job->backoff_count() * 2;
-      if (new_backoff_count * job->setting().default_interval()
-          < job->setting().max_interval()) {
-        job->set_backoff_count(new_backoff_count);
-      }
-      job->set_skip_count(job->backoff_count());
-    }
-  }
-
   bool HasJob(const string &name) const {
     return (jobs_.find(name) != jobs_.end());
   }
@@ -251,7 +212,7 @@ class SchedulerImpl : public Scheduler::SchedulerInterface {
     return delay;
   }
 
-  map<string, Job> jobs_;
+  map<string, Job *> jobs_;
   Mutex mutex_;
 
   DISALLOW_COPY_AND_ASSIGN(SchedulerImpl);
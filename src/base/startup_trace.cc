@@ -0,0 +1,245 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/startup_trace.h"
+
+#ifdef OS_WIN
+#include <windows.h>
+#else  // OS_WIN
+#include <pthread.h>
+#include <unistd.h>
+#endif  // OS_WIN
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/file_stream.h"
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/mutex.h"
+#include "base/singleton.h"
+#include "base/util.h"
+
+DEFINE_string(startup_trace_file, "",
+              "If set, the time spent in each step of the start-up is "
+              "written to this file in the Chrome trace event format");
+
+namespace mozc {
+namespace {
+
+uint32 GetProcessId() {
+#ifdef OS_WIN
+  return static_cast<uint32>(::GetCurrentProcessId());
+#else  // OS_WIN
+  return static_cast<uint32>(::getpid());
+#endif  // OS_WIN
+}
+
+uint64 GetThreadId() {
+#if defined(OS_WIN)
+  return static_cast<uint64>(::GetCurrentThreadId());
+#elif defined(OS_MACOSX) || defined(__native_client__)
+  // pthread_self() returns a pointer.
+  return static_cast<uint64>(reinterpret_cast<uintptr_t>(pthread_self()));
+#else  // = OS_LINUX
+  // It returns unsigned long.
+  return static_cast<uint64>(pthread_self());
+#endif
+}
+
+// Appends |str| as a JSON string literal.  Only the characters which can
+// appear in the event names are escaped.
+void AppendQuoted(const char *str, ostringstream *os) {
+  *os << '"';
+  for (const char *p = str; *p != '\0'; ++p) {
+    if (*p == '"' || *p == '\\') {
+      *os << '\\';
+    }
+    *os << *p;
+  }
+  *os << '"';
+}
+
+class StartupTraceImpl {
+ public:
+  StartupTraceImpl() : finished_(false) {}
+
+  bool IsEnabled() {
+    scoped_lock l(&mutex_);
+    return IsEnabledLocked();
+  }
+
+  void AddEvent(const char *name, uint64 start_usec, uint64 end_usec) {
+    scoped_lock l(&mutex_);
+    if (!IsEnabledLocked()) {
+      return;
+    }
+    Event event;
+    event.name = name;
+    event.start_usec = start_usec;
+    event.duration_usec = end_usec > start_usec ? end_usec - start_usec : 0;
+    // Thread ids are renumbered from 1 in the order of appearance to keep
+    // the trace readable.
+    const uint64 thread_id = GetThreadId();
+    map<uint64, int>::const_iterator it = thread_indices_.find(thread_id);
+    if (it == thread_indices_.end()) {
+      it = thread_indices_.insert(
+          make_pair(thread_id, static_cast<int>(thread_indices_.size() + 1)))
+          .first;
+    }
+    event.thread_index = it->second;
+    events_.push_back(event);
+  }
+
+  void Finish() {
+    scoped_lock l(&mutex_);
+    if (!IsEnabledLocked()) {
+      return;
+    }
+    finished_ = true;
+    const string json = ToJsonLocked();
+    OutputFileStream ofs(FLAGS_startup_trace_file.c_str(),
+                         ios::out | ios::binary | ios::trunc);
+    if (!ofs) {
+      LOG(ERROR) << "Cannot open " << FLAGS_startup_trace_file;
+      return;
+    }
+    ofs << json;
+    VLOG(1) << events_.size() << " startup trace events are written to "
+            << FLAGS_startup_trace_file;
+  }
+
+  string ToJson() {
+    scoped_lock l(&mutex_);
+    return ToJsonLocked();
+  }
+
+  void Reset() {
+    scoped_lock l(&mutex_);
+    finished_ = false;
+    events_.clear();
+    thread_indices_.clear();
+  }
+
+ private:
+  struct Event {
+    const char *name;
+    uint64 start_usec;
+    uint64 duration_usec;
+    int thread_index;
+  };
+
+  bool IsEnabledLocked() const {
+    return !finished_ && !FLAGS_startup_trace_file.empty();
+  }
+
+  string ToJsonLocked() const {
+    const uint32 process_id = GetProcessId();
+    ostringstream os;
+    os << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events_.size(); ++i) {
+      const Event &event = events_[i];
+      if (i > 0) {
+        os << ',';
+      }
+      os << "\n{\"name\":";
+      AppendQuoted(event.name, &os);
+      os << ",\"cat\":\"startup\",\"ph\":\"X\""
+         << ",\"ts\":" << event.start_usec
+         << ",\"dur\":" << event.duration_usec
+         << ",\"pid\":" << process_id
+         << ",\"tid\":" << event.thread_index << '}';
+    }
+    os << "\n]}\n";
+    return os.str();
+  }
+
+  Mutex mutex_;
+  bool finished_;
+  vector<Event> events_;
+  map<uint64, int> thread_indices_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupTraceImpl);
+};
+
+}  // namespace
+
+bool StartupTrace::IsEnabled() {
+  // Avoids creating the singleton when the trace is not requested.
+  if (FLAGS_startup_trace_file.empty()) {
+    return false;
+  }
+  return Singleton<StartupTraceImpl>::get()->IsEnabled();
+}
+
+uint64 StartupTrace::GetCurrentTimeUsec() {
+  uint64 sec = 0;
+  uint32 usec = 0;
+  Util::GetTimeOfDay(&sec, &usec);
+  return sec * 1000000 + usec;
+}
+
+void StartupTrace::AddEvent(const char *name, uint64 start_usec) {
+  if (FLAGS_startup_trace_file.empty()) {
+    return;
+  }
+  Singleton<StartupTraceImpl>::get()->AddEvent(name, start_usec,
+                                               GetCurrentTimeUsec());
+}
+
+void StartupTrace::Finish() {
+  if (FLAGS_startup_trace_file.empty()) {
+    return;
+  }
+  Singleton<StartupTraceImpl>::get()->Finish();
+}
+
+string StartupTrace::ToJson() {
+  return Singleton<StartupTraceImpl>::get()->ToJson();
+}
+
+void StartupTrace::Reset() {
+  Singleton<StartupTraceImpl>::get()->Reset();
+}
+
+ScopedStartupTrace::ScopedStartupTrace(const char *name)
+    : name_(name),
+      start_usec_(StartupTrace::IsEnabled() ?
+                  StartupTrace::GetCurrentTimeUsec() : 0) {}
+
+ScopedStartupTrace::~ScopedStartupTrace() {
+  if (start_usec_ != 0) {
+    StartupTrace::AddEvent(name_, start_usec_);
+  }
+}
+
+}  // namespace mozc
@@ -0,0 +1,96 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Records where the server spends its time from the process start to the
+// first served session, and writes them to --startup_trace_file in the
+// Chrome trace event format so that the file can be opened with
+// chrome://tracing.  Nothing is recorded unless the flag is set, and the
+// recording stops once the trace is written by StartupTrace::Finish().
+//
+// Usage:
+//   void Engine::Init() {
+//     ScopedStartupTrace trace("Engine::Init");
+//     ...
+//   }
+
+#ifndef MOZC_BASE_STARTUP_TRACE_H_
+#define MOZC_BASE_STARTUP_TRACE_H_
+
+#include <string>
+
+#include "base/port.h"
+
+namespace mozc {
+
+class StartupTrace {
+ public:
+  // Returns true while the events are being recorded.
+  static bool IsEnabled();
+
+  // Returns the current time in micro seconds, which is used as the
+  // timestamp of the events.
+  static uint64 GetCurrentTimeUsec();
+
+  // Records an event |name| which started at |start_usec| and ends now.
+  // |name| must outlive the trace, i.e., should be a string literal.
+  static void AddEvent(const char *name, uint64 start_usec);
+
+  // Writes the recorded events to --startup_trace_file and stops the
+  // recording.  Does nothing if the trace is disabled or already written.
+  static void Finish();
+
+  // Returns the recorded events as a JSON string of the Chrome trace event
+  // format.
+  static string ToJson();
+
+  // Clears the events and restarts the recording.  For unit testing.
+  static void Reset();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(StartupTrace);
+};
+
+// Records the lifetime of this object as an event of the startup trace.
+class ScopedStartupTrace {
+ public:
+  explicit ScopedStartupTrace(const char *name);
+  ~ScopedStartupTrace();
+
+ private:
+  const char *name_;
+  // 0 when the trace is disabled at the construction.
+  uint64 start_usec_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStartupTrace);
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_STARTUP_TRACE_H_
@@ -0,0 +1,107 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/startup_trace.h"
+
+#include <string>
+
+#include "base/file_stream.h"
+#include "base/file_util.h"
+#include "base/flags.h"
+#include "base/util.h"
+#include "testing/base/public/gunit.h"
+
+DECLARE_string(startup_trace_file);
+DECLARE_string(test_tmpdir);
+
+namespace mozc {
+namespace {
+
+class StartupTraceTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    original_trace_file_ = FLAGS_startup_trace_file;
+    trace_file_ = FileUtil::JoinPath(FLAGS_test_tmpdir, "startup_trace.json");
+    FileUtil::Unlink(trace_file_);
+    StartupTrace::Reset();
+  }
+
+  virtual void TearDown() {
+    FileUtil::Unlink(trace_file_);
+    FLAGS_startup_trace_file = original_trace_file_;
+    StartupTrace::Reset();
+  }
+
+  string original_trace_file_;
+  string trace_file_;
+};
+
+TEST_F(StartupTraceTest, Disabled) {
+  FLAGS_startup_trace_file = "";
+  EXPECT_FALSE(StartupTrace::IsEnabled());
+  {
+    ScopedStartupTrace trace("Disabled");
+  }
+  StartupTrace::Finish();
+  EXPECT_EQ(string::npos, StartupTrace::ToJson().find("Disabled"));
+}
+
+TEST_F(StartupTraceTest, WriteTrace) {
+  FLAGS_startup_trace_file = trace_file_;
+  EXPECT_TRUE(StartupTrace::IsEnabled());
+  {
+    ScopedStartupTrace outer("Outer");
+    ScopedStartupTrace inner("Inner \"quoted\"");
+  }
+  StartupTrace::Finish();
+  EXPECT_FALSE(StartupTrace::IsEnabled());
+
+  // Events after Finish() are not recorded.
+  {
+    ScopedStartupTrace trace("AfterFinish");
+  }
+
+  ASSERT_TRUE(FileUtil::FileExists(trace_file_));
+  InputFileStream ifs(trace_file_.c_str());
+  const string json((istreambuf_iterator<char>(ifs)),
+                    istreambuf_iterator<char>());
+  EXPECT_EQ(StartupTrace::ToJson(), json);
+  EXPECT_TRUE(Util::StartsWith(json, "{\"traceEvents\":["));
+  EXPECT_NE(string::npos, json.find("\"name\":\"Outer\""));
+  EXPECT_NE(string::npos, json.find("\"name\":\"Inner \\\"quoted\\\"\""));
+  EXPECT_NE(string::npos, json.find("\"ph\":\"X\""));
+  EXPECT_NE(string::npos, json.find("\"tid\":1"));
+  EXPECT_EQ(string::npos, json.find("AfterFinish"));
+  // The inner scope is destructed first.
+  EXPECT_LT(json.find("Inner"), json.find("Outer"));
+}
+
+}  // namespace
+}  // namespace mozc
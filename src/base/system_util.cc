@@ -34,14 +34,19 @@
 #include <LMCons.h>
 #include <Sddl.h>
 #include <ShlObj.h>
+#include <psapi.h>
 #else  // OS_WIN
 #include <pwd.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #ifdef OS_MACOSX
+#include <mach/mach.h>
 #include <sys/stat.h>
 #include <sys/sysctl.h>
 #endif  // OS_MACOSX
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif  // __GLIBC__
 #endif  // OS_WIN
 
 #ifdef OS_MACOSX
@@ -56,6 +61,7 @@
 #include <string>
 
 #include "base/const.h"
+#include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/mac_util.h"
@@ -1228,6 +1234,51 @@ uint64 SystemUtil::GetTotalPhysicalMemory() {
 #endif  // OS_WIN, OS_MACOSX, OS_LINUX
 }
 
+uint64 SystemUtil::GetResidentMemorySize() {
+#if defined(OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters = { sizeof(PROCESS_MEMORY_COUNTERS) };
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters))) {
+    return 0;
+  }
+  return counters.WorkingSetSize;
+#elif defined(OS_MACOSX)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.resident_size;
+#elif defined(OS_LINUX)
+  // The second field of /proc/self/statm is the number of resident pages.
+  // /proc is not available on NaCl, where this returns 0.
+  InputFileStream ifs("/proc/self/statm");
+  uint64 total_pages = 0;
+  uint64 resident_pages = 0;
+  if (!(ifs >> total_pages >> resident_pages)) {
+    return 0;
+  }
+#if defined(_SC_PAGESIZE)
+  const long page_size = sysconf(_SC_PAGESIZE);
+  if (page_size <= 0) {
+    return 0;
+  }
+  return resident_pages * page_size;
+#else  // defined(_SC_PAGESIZE)
+  return 0;
+#endif  // defined(_SC_PAGESIZE)
+#else  // !(defined(OS_WIN) || defined(OS_MACOSX) || defined(OS_LINUX))
+#error "unknown platform"
+#endif  // OS_WIN, OS_MACOSX, OS_LINUX
+}
+
+void SystemUtil::ReleaseFreeMemory() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif  // __GLIBC__
+}
+
 bool SystemUtil::IsLittleEndian() {
 #ifndef OS_WIN
   union {
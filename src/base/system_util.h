@@ -209,6 +209,16 @@ class SystemUtil {
   // retrieve total physical memory. returns 0 if any error occurs.
   static uint64 GetTotalPhysicalMemory();
 
+  // retrieve the resident set size of the current process in bytes.
+  // returns 0 if any error occurs or the platform doesn't support it.
+  static uint64 GetResidentMemorySize();
+
+  // Returns the free memory of the heap to the system if the allocator
+  // supports it (glibc only for now).  Freed memory usually stays in the
+  // heap of the process, so call this after releasing large data structures
+  // to actually reduce the resident set size.
+  static void ReleaseFreeMemory();
+
   // check endian-ness at runtime.
   static bool IsLittleEndian();
 
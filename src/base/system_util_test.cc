@@ -231,6 +231,16 @@ TEST_F(SystemUtilTest, GetTotalPhysicalMemoryTest) {
   EXPECT_GT(SystemUtil::GetTotalPhysicalMemory(), 0);
 }
 
+#ifndef __native_client__
+TEST_F(SystemUtilTest, GetResidentMemorySizeTest) {
+  const uint64 resident_size = SystemUtil::GetResidentMemorySize();
+  EXPECT_GT(resident_size, 0);
+  EXPECT_LE(resident_size, SystemUtil::GetTotalPhysicalMemory());
+  // Just make sure that it doesn't crash.
+  SystemUtil::ReleaseFreeMemory();
+}
+#endif  // __native_client__
+
 #ifdef OS_ANDROID
 TEST_F(SystemUtilTest, GetOSVersionStringTestForAndroid) {
   string result = SystemUtil::GetOSVersionString();
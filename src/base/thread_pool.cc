@@ -0,0 +1,149 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/thread_pool.h"
+
+#include "base/logging.h"
+#include "base/thread.h"
+
+namespace mozc {
+
+class ThreadPool::Worker : public Thread {
+ public:
+  explicit Worker(ThreadPool *pool) : pool_(pool) {}
+  virtual ~Worker() {}
+
+  virtual void Run() {
+    while (true) {
+      bool stopped = false;
+      Task *task = pool_->PopTask(&stopped);
+      if (task != NULL) {
+        task->Run();
+        continue;
+      }
+      if (stopped) {
+        return;
+      }
+      // UnnamedEvent keeps the notification until it is consumed, so a task
+      // scheduled after PopTask() above is never missed.
+      wakeup_.Wait(-1);
+    }
+  }
+
+  void WakeUp() {
+    wakeup_.Notify();
+  }
+
+ private:
+  ThreadPool *pool_;
+  UnnamedEvent wakeup_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+ThreadPool::ThreadPool(size_t num_threads) : stopped_(false) {
+  DCHECK_GT(num_threads, 0);
+  for (size_t i = 0; i < num_threads; ++i) {
+    Worker *worker = new Worker(this);
+    workers_.push_back(worker);
+    worker->Start();
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    scoped_lock l(&mutex_);
+    stopped_ = true;
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->WakeUp();
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Join();
+    delete workers_[i];
+  }
+}
+
+void ThreadPool::Schedule(Task *task) {
+  DCHECK(task);
+  {
+    scoped_lock l(&mutex_);
+    DCHECK(!stopped_);
+    tasks_.push_back(task);
+  }
+  // Wakes up all the workers since we don't know which ones are idle. The
+  // pool is expected to be small.
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->WakeUp();
+  }
+}
+
+ThreadPool::Task *ThreadPool::PopTask(bool *stopped) {
+  scoped_lock l(&mutex_);
+  *stopped = stopped_;
+  if (tasks_.empty()) {
+    return NULL;
+  }
+  Task *task = tasks_.front();
+  tasks_.pop_front();
+  return task;
+}
+
+BlockingCounter::BlockingCounter(int count) : count_(count) {
+  DCHECK_GE(count, 0);
+}
+
+BlockingCounter::~BlockingCounter() {}
+
+void BlockingCounter::DecrementCount() {
+  // Notifies while holding the lock. Otherwise the waiting thread could
+  // return from Wait() and destroy this object during Notify().
+  scoped_lock l(&mutex_);
+  DCHECK_GT(count_, 0);
+  --count_;
+  if (count_ == 0) {
+    event_.Notify();
+  }
+}
+
+void BlockingCounter::Wait() {
+  {
+    scoped_lock l(&mutex_);
+    if (count_ == 0) {
+      return;
+    }
+  }
+  event_.Wait(-1);
+  // Waits for DecrementCount() to release the lock.
+  scoped_lock l(&mutex_);
+  DCHECK_EQ(0, count_);
+}
+
+}  // namespace mozc
@@ -0,0 +1,119 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_BASE_THREAD_POOL_H_
+#define MOZC_BASE_THREAD_POOL_H_
+
+#include <deque>
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/unnamed_event.h"
+
+namespace mozc {
+
+// A fixed number of worker threads running tasks queued by other threads.
+//
+// Usage:
+//   class MyTask : public ThreadPool::Task {
+//    public:
+//     virtual void Run() { ... }
+//   };
+//
+//   ThreadPool pool(2);
+//   MyTask task;
+//   pool.Schedule(&task);
+class ThreadPool {
+ public:
+  class Task {
+   public:
+    virtual ~Task() {}
+    virtual void Run() = 0;
+  };
+
+  // Starts |num_threads| worker threads.
+  explicit ThreadPool(size_t num_threads);
+
+  // Runs the tasks remaining in the queue, and then stops all the workers.
+  ~ThreadPool();
+
+  // Queues |task| to be run by one of the workers. The ownership of |task|
+  // is not transferred, so it must be alive until its Run() returns.
+  void Schedule(Task *task);
+
+  size_t num_threads() const {
+    return workers_.size();
+  }
+
+ private:
+  class Worker;
+
+  // Pops the oldest task in the queue. Returns NULL if the queue is empty,
+  // setting |stopped| to true if the pool is being destroyed.
+  Task *PopTask(bool *stopped);
+
+  Mutex mutex_;
+  deque<Task *> tasks_;
+  bool stopped_;
+  vector<Worker *> workers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+// Lets a thread wait for a fixed number of tasks run by other threads.
+//
+// Usage:
+//   BlockingCounter counter(2);
+//   // Each of the two tasks calls counter.DecrementCount() when done.
+//   counter.Wait();
+class BlockingCounter {
+ public:
+  explicit BlockingCounter(int count);
+  ~BlockingCounter();
+
+  // Decrements the count, and wakes up the waiting thread when the count
+  // reaches zero.
+  void DecrementCount();
+
+  // Blocks until the count reaches zero.
+  void Wait();
+
+ private:
+  Mutex mutex_;
+  int count_;
+  UnnamedEvent event_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockingCounter);
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_THREAD_POOL_H_
@@ -0,0 +1,119 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/thread_pool.h"
+
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/util.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace {
+
+class CountingTask : public ThreadPool::Task {
+ public:
+  CountingTask(Mutex *mutex, int *count, BlockingCounter *counter)
+      : mutex_(mutex), count_(count), counter_(counter) {}
+
+  virtual void Run() {
+    Util::Sleep(10);
+    {
+      scoped_lock l(mutex_);
+      ++*count_;
+    }
+    counter_->DecrementCount();
+  }
+
+ private:
+  Mutex *mutex_;
+  int *count_;
+  BlockingCounter *counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingTask);
+};
+
+class NoopTask : public ThreadPool::Task {
+ public:
+  NoopTask() : invoked_(false) {}
+  virtual void Run() {
+    invoked_ = true;
+  }
+  bool invoked() const {
+    return invoked_;
+  }
+
+ private:
+  bool invoked_;
+};
+
+TEST(ThreadPoolTest, RunAllTasks) {
+  const int kNumTasks = 20;
+  ThreadPool pool(3);
+  EXPECT_EQ(3, pool.num_threads());
+
+  Mutex mutex;
+  int count = 0;
+  BlockingCounter counter(kNumTasks);
+  vector<CountingTask *> tasks;
+  for (int i = 0; i < kNumTasks; ++i) {
+    tasks.push_back(new CountingTask(&mutex, &count, &counter));
+    pool.Schedule(tasks.back());
+  }
+  counter.Wait();
+  EXPECT_EQ(kNumTasks, count);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    delete tasks[i];
+  }
+}
+
+TEST(ThreadPoolTest, RunRemainingTasksOnDestruction) {
+  NoopTask tasks[10];
+  {
+    ThreadPool pool(1);
+    for (size_t i = 0; i < arraysize(tasks); ++i) {
+      pool.Schedule(&tasks[i]);
+    }
+  }
+  for (size_t i = 0; i < arraysize(tasks); ++i) {
+    EXPECT_TRUE(tasks[i].invoked());
+  }
+}
+
+TEST(BlockingCounterTest, ZeroCount) {
+  BlockingCounter counter(0);
+  // Should return immediately.
+  counter.Wait();
+}
+
+}  // namespace
+}  // namespace mozc
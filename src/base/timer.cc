@@ -29,62 +29,25 @@
 
 #include "base/timer.h"
 
+#include "base/compiler_specific.h"
 #include "base/logging.h"
-#include "base/thread.h"
-#include "base/unnamed_event.h"
-#include "base/util.h"
 
 namespace mozc {
 
-class Timer::TimerThread : public Thread {
+class Timer::TimerTask : public Executor::Task {
  public:
-  TimerThread(uint32 due_time, uint32 interval, Timer *timer)
-      : Thread(),
-        due_time_(due_time),
-        interval_(interval),
-        timer_(timer),
-        event_(new UnnamedEvent) {}
-
-  virtual ~TimerThread() {
-    SignalQuit();
-    Join();
-  }
+  explicit TimerTask(Timer *timer) : timer_(timer) {}
+  virtual ~TimerTask() {}
 
   virtual void Run() {
-    if (event_->Wait(due_time_)) {
-      VLOG(1) << "Received notification event";
-      return;
-    }
     VLOG(2) << "call TimerCallback()";
     timer_->TimerCallback();
-
-    if (interval_ == 0) {
-      VLOG(2) << "Run() end";
-      return;
-    } else {
-      while (true) {
-        if (event_->Wait(interval_)) {
-          VLOG(1) << "Received notification event";
-          return;
-        }
-        VLOG(2) << "call TimerCallback()";
-        timer_->TimerCallback();
-      }
-    }
-  }
-
-  void SignalQuit() {
-    const bool result = event_->Notify();
-    DCHECK(result);
   }
 
  private:
-  uint32 due_time_;
-  uint32 interval_;
   Timer *timer_;
-  scoped_ptr<UnnamedEvent> event_;
 
-  DISALLOW_COPY_AND_ASSIGN(TimerThread);
+  DISALLOW_COPY_AND_ASSIGN(TimerTask);
 };
 
 void Timer::TimerCallback() {
@@ -94,21 +57,24 @@ void Timer::TimerCallback() {
 
 bool Timer::Start(uint32 due_time, uint32 interval) {
   VLOG(1) << "Starting " << due_time << " " << interval;
-  // Note: We can simply destroy |*timer_thread_.get()| since
-  // TimerThread::~TimerThread internally joins its background thread.
-  timer_thread_.reset(new TimerThread(due_time, interval, this));
-  timer_thread_->Start();
-  return true;
+  Stop();
+  task_id_ = Executor::GetInstance()->Schedule(
+      "Timer", task_.get(), Executor::NORMAL, due_time, interval);
+  return task_id_ != Executor::kInvalidTaskId;
 }
 
 void Timer::Stop() {
-  // Note: We can simply destroy |*timer_thread_.get()| since
-  // TimerThread::~TimerThread internally joins its background thread.
-  timer_thread_.reset(NULL);
+  // Executor::Cancel() waits for the running callback.
+  if (task_id_ != Executor::kInvalidTaskId) {
+    Executor::GetInstance()->Cancel(task_id_);
+    task_id_ = Executor::kInvalidTaskId;
+  }
 }
 
 Timer::Timer()
-    : num_signaled_(0) {}
+    : ALLOW_THIS_IN_INITIALIZER_LIST(task_(new TimerTask(this))),
+      task_id_(Executor::kInvalidTaskId),
+      num_signaled_(0) {}
 
 Timer::~Timer() {
   Stop();
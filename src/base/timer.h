@@ -30,11 +30,14 @@
 #ifndef MOZC_BASE_TIMER_H_
 #define MOZC_BASE_TIMER_H_
 
+#include "base/executor.h"
 #include "base/port.h"
 #include "base/scoped_ptr.h"
 
 namespace mozc {
 
+// Calls Signaled() on a worker of the shared Executor.  Timers don't have
+// their own threads.
 class Timer {
  public:
   // Start timer.
@@ -74,8 +77,9 @@ class Timer {
   virtual void Signaled();
 
  private:
-  class TimerThread;
-  scoped_ptr<TimerThread> timer_thread_;
+  class TimerTask;
+  scoped_ptr<TimerTask> task_;
+  Executor::TaskId task_id_;
   uint32 num_signaled_;
 
   DISALLOW_COPY_AND_ASSIGN(Timer);
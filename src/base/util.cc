@@ -68,6 +68,11 @@
 #include "base/string_piece.h"
 #include "base/text_converter.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOZC_USE_SSE2
+#include <emmintrin.h>
+#endif  // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
 
 namespace {
 
@@ -1125,7 +1130,9 @@ class ClockImpl : public Util::ClockInterface {
 #elif defined(OS_LINUX)
 #if defined(HAVE_LIBRT)
     struct timespec timestamp;
-    if (-1 == clock_gettime(CLOCK_REALTIME, &timestamp)) {
+    // CLOCK_MONOTONIC is not affected by changes of the system time, so the
+    // elapsed time never goes backward.
+    if (-1 == clock_gettime(CLOCK_MONOTONIC, &timestamp)) {
       return 0;
     }
     return timestamp.tv_sec * 1000000000uLL + timestamp.tv_nsec;
@@ -1222,23 +1229,243 @@ void EscapeInternal(char input, const string &prefix, string *output) {
 // Load  Rules
 #include "base/japanese_util_rule.h"
 
+namespace {
+
+// Returns the first position in [begin, end) whose byte is not 7-bit ASCII,
+// or |end| if all the bytes are ASCII. Uses SSE2 when it is available so
+// that long ASCII candidates are scanned 16 bytes at a time.
+const char *FindNonAscii(const char *begin, const char *end) {
+#ifdef MOZC_USE_SSE2
+  while (end - begin >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    const int mask = _mm_movemask_epi8(chunk);
+    if (mask != 0) {
+      for (int i = 0; i < 16; ++i) {
+        if (mask & (1 << i)) {
+          return begin + i;
+        }
+      }
+    }
+    begin += 16;
+  }
+#else  // MOZC_USE_SSE2
+  while (end - begin >= 8) {
+    uint64 chunk = 0;
+    memcpy(&chunk, begin, sizeof(chunk));
+    if (chunk & GG_ULONGLONG(0x8080808080808080)) {
+      break;
+    }
+    begin += 8;
+  }
+#endif  // MOZC_USE_SSE2
+  for (; begin < end; ++begin) {
+    if (static_cast<uint8>(*begin) >= 0x80) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+// Table-driven fast path of TextConverter::Convert().
+//
+// All the conversion rules in japanese_util_rule.h are context free for ASCII
+// and for the Hiragana/Katakana block (U+3040 - U+30FF) except for the voiced
+// sound marks (e.g. "う゛" is converted to "ヴ"). Since most of the keys and
+// candidates consist only of those characters, they are converted here by
+// looking up the UTF-8 bytes directly. The tables are filled by running
+// TextConverter on each character, so that the results are always consistent
+// with the rules. Other inputs fall back to TextConverter.
+class ScriptConversionTable {
+ public:
+  ScriptConversionTable(const TextConverter::DoubleArray *da,
+                        const char *ctable)
+      : da_(da), ctable_(ctable), ascii_identity_(true) {
+    string input, output;
+    for (size_t i = 0; i < arraysize(ascii_); ++i) {
+      input.assign(1, static_cast<char>(i));
+      TextConverter::Convert(da_, ctable_, input, &output);
+      SetEntry(output, &ascii_[i]);
+      if (output != input) {
+        ascii_identity_ = false;
+      }
+    }
+    for (size_t i = 0; i < arraysize(kana_); ++i) {
+      const char32 ucs4 = kKanaBlockBegin + i;
+      if (ucs4 >= kVoicedSoundMarkBegin && ucs4 <= kVoicedSoundMarkEnd) {
+        kana_[i].length = kNoEntry;
+        continue;
+      }
+      Util::UCS4ToUTF8(ucs4, &input);
+      TextConverter::Convert(da_, ctable_, input, &output);
+      SetEntry(output, &kana_[i]);
+    }
+  }
+
+  void Convert(const StringPiece input, string *output) const {
+    output->clear();
+    const size_t converted = ConvertWithTable(input, output);
+    if (converted == input.size()) {
+      return;
+    }
+    if (converted == 0) {
+      TextConverter::Convert(da_, ctable_, input, output);
+      return;
+    }
+    string rest;
+    TextConverter::Convert(da_, ctable_, input.substr(converted), &rest);
+    output->append(rest);
+  }
+
+ private:
+  // U+3040 - U+30FF are encoded to "\xE3\x81\x80" - "\xE3\x83\xBF".
+  static const char32 kKanaBlockBegin = 0x3040;
+  // "゙", "゚", "゛" and "゜" may be combined with the preceding character.
+  static const char32 kVoicedSoundMarkBegin = 0x3099;
+  static const char32 kVoicedSoundMarkEnd = 0x309C;
+  static const uint8 kNoEntry = 0xFF;
+
+  struct Entry {
+    uint8 length;
+    char value[7];
+  };
+
+  static void SetEntry(const string &value, Entry *entry) {
+    memset(entry, 0, sizeof(*entry));
+    if (value.size() > sizeof(entry->value)) {
+      entry->length = kNoEntry;
+      return;
+    }
+    entry->length = static_cast<uint8>(value.size());
+    memcpy(entry->value, value.data(), value.size());
+  }
+
+  const Entry *GetEntry(const char *begin, const char *end) const {
+    const uint8 c = static_cast<uint8>(*begin);
+    if (c < 0x80) {
+      return ascii_[c].length == kNoEntry ? NULL : &ascii_[c];
+    }
+    if (c != 0xE3 || end - begin < 3) {
+      return NULL;
+    }
+    const uint8 c1 = static_cast<uint8>(begin[1]);
+    const uint8 c2 = static_cast<uint8>(begin[2]);
+    if (c1 < 0x81 || c1 > 0x83 || c2 < 0x80 || c2 > 0xBF) {
+      return NULL;
+    }
+    const Entry *entry = &kana_[(c1 - 0x81) * 0x40 + (c2 - 0x80)];
+    return entry->length == kNoEntry ? NULL : entry;
+  }
+
+  // Appends the conversion of the longest prefix of |input| which can be
+  // converted by the tables, and returns its length in bytes. As the
+  // character just before an unknown one might be combined with it (e.g.
+  // "う" + "゛"), that character is left to TextConverter as well.
+  size_t ConvertWithTable(const StringPiece input, string *output) const {
+    const char *const input_begin = input.data();
+    const char *const end = input.data() + input.size();
+    if (ascii_identity_ && FindNonAscii(input_begin, end) == end) {
+      output->assign(input_begin, input.size());
+      return input.size();
+    }
+
+    char buf[256];
+    size_t buf_size = 0;
+    const char *begin = input_begin;
+    const char *last_char = input_begin;
+    size_t last_char_buf_size = 0;
+    while (begin < end) {
+      if (ascii_identity_ && static_cast<uint8>(*begin) < 0x80) {
+        const char *run_end = FindNonAscii(begin, end);
+        output->append(buf, buf_size);
+        buf_size = 0;
+        output->append(begin, run_end - begin);
+        // ASCII characters are never combined with the following ones.
+        last_char = run_end;
+        begin = run_end;
+        continue;
+      }
+      const Entry *entry = GetEntry(begin, end);
+      if (entry == NULL) {
+        if (last_char < begin) {
+          buf_size = last_char_buf_size;
+          begin = last_char;
+        }
+        break;
+      }
+      if (buf_size + sizeof(entry->value) > sizeof(buf)) {
+        output->append(buf, buf_size);
+        buf_size = 0;
+      }
+      last_char = begin;
+      last_char_buf_size = buf_size;
+      memcpy(buf + buf_size, entry->value, sizeof(entry->value));
+      buf_size += entry->length;
+      begin += (static_cast<uint8>(*begin) < 0x80) ? 1 : 3;
+    }
+    output->append(buf, buf_size);
+    return begin - input_begin;
+  }
+
+  const TextConverter::DoubleArray *da_;
+  const char *ctable_;
+  bool ascii_identity_;
+  Entry ascii_[0x80];
+  Entry kana_[0xC0];
+
+  DISALLOW_COPY_AND_ASSIGN(ScriptConversionTable);
+};
+
+class ScriptConversionTables {
+ public:
+  ScriptConversionTables()
+      : hiragana_to_katakana(hiragana_to_katakana_da,
+                             hiragana_to_katakana_table),
+        katakana_to_hiragana(katakana_to_hiragana_da,
+                             katakana_to_hiragana_table),
+        halfwidthascii_to_fullwidthascii(
+            halfwidthascii_to_fullwidthascii_da,
+            halfwidthascii_to_fullwidthascii_table),
+        fullwidthascii_to_halfwidthascii(
+            fullwidthascii_to_halfwidthascii_da,
+            fullwidthascii_to_halfwidthascii_table),
+        halfwidthkatakana_to_fullwidthkatakana(
+            halfwidthkatakana_to_fullwidthkatakana_da,
+            halfwidthkatakana_to_fullwidthkatakana_table),
+        fullwidthkatakana_to_halfwidthkatakana(
+            fullwidthkatakana_to_halfwidthkatakana_da,
+            fullwidthkatakana_to_halfwidthkatakana_table),
+        normalize_voiced_sound(normalize_voiced_sound_da,
+                               normalize_voiced_sound_table) {}
+
+  const ScriptConversionTable hiragana_to_katakana;
+  const ScriptConversionTable katakana_to_hiragana;
+  const ScriptConversionTable halfwidthascii_to_fullwidthascii;
+  const ScriptConversionTable fullwidthascii_to_halfwidthascii;
+  const ScriptConversionTable halfwidthkatakana_to_fullwidthkatakana;
+  const ScriptConversionTable fullwidthkatakana_to_halfwidthkatakana;
+  const ScriptConversionTable normalize_voiced_sound;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScriptConversionTables);
+};
+
+const ScriptConversionTables &GetScriptConversionTables() {
+  return *Singleton<ScriptConversionTables>::get();
+}
+
+}  // namespace
+
 void Util::HiraganaToKatakana(const StringPiece input, string *output) {
-  TextConverter::Convert(hiragana_to_katakana_da,
-                         hiragana_to_katakana_table,
-                         input,
-                         output);
+  GetScriptConversionTables().hiragana_to_katakana.Convert(input, output);
 }
 
 void Util::HiraganaToHalfwidthKatakana(const StringPiece input,
                                        string *output) {
   // combine two rules
   string tmp;
-  TextConverter::Convert(hiragana_to_katakana_da,
-                         hiragana_to_katakana_table,
-                         input, &tmp);
-  TextConverter::Convert(fullwidthkatakana_to_halfwidthkatakana_da,
-                         fullwidthkatakana_to_halfwidthkatakana_table,
-                         tmp, output);
+  HiraganaToKatakana(input, &tmp);
+  FullWidthKatakanaToHalfWidthKatakana(tmp, output);
 }
 
 void Util::HiraganaToRomanji(const StringPiece input, string *output) {
@@ -1250,18 +1477,14 @@ void Util::HiraganaToRomanji(const StringPiece input, string *output) {
 
 void Util::HalfWidthAsciiToFullWidthAscii(const StringPiece input,
                                           string *output) {
-  TextConverter::Convert(halfwidthascii_to_fullwidthascii_da,
-                         halfwidthascii_to_fullwidthascii_table,
-                         input,
-                         output);
+  GetScriptConversionTables().halfwidthascii_to_fullwidthascii.Convert(
+      input, output);
 }
 
 void Util::FullWidthAsciiToHalfWidthAscii(const StringPiece input,
                                           string *output) {
-  TextConverter::Convert(fullwidthascii_to_halfwidthascii_da,
-                         fullwidthascii_to_halfwidthascii_table,
-                         input,
-                         output);
+  GetScriptConversionTables().fullwidthascii_to_halfwidthascii.Convert(
+      input, output);
 }
 
 void Util::HiraganaToFullwidthRomanji(const StringPiece input, string *output) {
@@ -1270,10 +1493,7 @@ void Util::HiraganaToFullwidthRomanji(const StringPiece input, string *output) {
                          hiragana_to_romanji_table,
                          input,
                          &tmp);
-  TextConverter::Convert(halfwidthascii_to_fullwidthascii_da,
-                         halfwidthascii_to_fullwidthascii_table,
-                         tmp,
-                         output);
+  HalfWidthAsciiToFullWidthAscii(tmp, output);
 }
 
 void Util::RomanjiToHiragana(const StringPiece input, string *output) {
@@ -1284,26 +1504,19 @@ void Util::RomanjiToHiragana(const StringPiece input, string *output) {
 }
 
 void Util::KatakanaToHiragana(const StringPiece input, string *output) {
-  TextConverter::Convert(katakana_to_hiragana_da,
-                         katakana_to_hiragana_table,
-                         input,
-                         output);
+  GetScriptConversionTables().katakana_to_hiragana.Convert(input, output);
 }
 
 void Util::HalfWidthKatakanaToFullWidthKatakana(const StringPiece input,
                                                 string *output) {
-  TextConverter::Convert(halfwidthkatakana_to_fullwidthkatakana_da,
-                         halfwidthkatakana_to_fullwidthkatakana_table,
-                         input,
-                         output);
+  GetScriptConversionTables().halfwidthkatakana_to_fullwidthkatakana.Convert(
+      input, output);
 }
 
 void Util::FullWidthKatakanaToHalfWidthKatakana(const StringPiece input,
                                                 string *output) {
-  TextConverter::Convert(fullwidthkatakana_to_halfwidthkatakana_da,
-                         fullwidthkatakana_to_halfwidthkatakana_table,
-                         input,
-                         output);
+  GetScriptConversionTables().fullwidthkatakana_to_halfwidthkatakana.Convert(
+      input, output);
 }
 
 void Util::FullWidthToHalfWidth(const StringPiece input, string *output) {
@@ -1324,10 +1537,7 @@ void Util::HalfWidthToFullWidth(const StringPiece input, string *output) {
 // of some UNICODE only characters (required to display
 // and commit for old clients)
 void Util::NormalizeVoicedSoundMark(StringPiece input, string *output) {
-  TextConverter::Convert(normalize_voiced_sound_da,
-                         normalize_voiced_sound_table,
-                         input,
-                         output);
+  GetScriptConversionTables().normalize_voiced_sound.Convert(input, output);
 }
 
 namespace {
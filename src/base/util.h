@@ -591,6 +591,37 @@ class ConstChar32ReverseIterator {
   DISALLOW_COPY_AND_ASSIGN(ConstChar32ReverseIterator);
 };
 
+// Computes Util::FingerprintWithSeed() of the concatenation of the appended
+// strings without building the concatenated string.
+//
+// Example usage:
+//   FingerprintBuilder builder(seed);
+//   builder.Append(key);
+//   builder.Append("\t");
+//   builder.Append(value);
+//   // Same as Util::FingerprintWithSeed(key + "\t" + value, seed).
+//   const uint64 fp = builder.Get();
+//
+// The builder is copyable so that the state after a common prefix can be
+// reused.
+class FingerprintBuilder {
+ public:
+  explicit FingerprintBuilder(uint32 seed);
+  void Append(StringPiece str);
+  uint64 Get() const;
+
+ private:
+  void MixBuffer(const char *block);
+
+  // The states of the two 32-bit fingerprints.
+  uint32 hi_[3];
+  uint32 lo_[3];
+  // The pending bytes which are not yet mixed into the states.
+  char buffer_[12];
+  size_t buffer_size_;
+  size_t length_;
+};
+
 // Actual definitions of delimiter classes.
 class SingleDelimiter {
  public:
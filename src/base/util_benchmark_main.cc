@@ -0,0 +1,168 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Benchmark of the script conversions in Util over real candidate lists.
+// Compares the table-driven fast path with the plain TextConverter rules.
+//
+// Usage:
+//   util_benchmark_main --input=data/test/dictionary/dictionary.txt
+//
+// Each line of the input is split by TAB. For dictionary files, the reading
+// (the first column) and the value (the fifth column) are used as inputs.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/file_stream.h"
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/stopwatch.h"
+#include "base/text_converter.h"
+#include "base/util.h"
+
+DEFINE_string(input, "", "input file of candidates");
+DEFINE_int32(iterations, 10, "number of iterations");
+
+namespace mozc {
+#include "base/japanese_util_rule.h"
+
+namespace {
+
+typedef void (*ConvertFunc)(const StringPiece, string *);
+
+struct BenchmarkCase {
+  const char *name;
+  ConvertFunc func;
+  const TextConverter::DoubleArray *da;
+  const char *table;
+};
+
+const BenchmarkCase kBenchmarkCases[] = {
+  { "HiraganaToKatakana", &Util::HiraganaToKatakana,
+    hiragana_to_katakana_da, hiragana_to_katakana_table },
+  { "KatakanaToHiragana", &Util::KatakanaToHiragana,
+    katakana_to_hiragana_da, katakana_to_hiragana_table },
+  { "HalfWidthAsciiToFullWidthAscii", &Util::HalfWidthAsciiToFullWidthAscii,
+    halfwidthascii_to_fullwidthascii_da,
+    halfwidthascii_to_fullwidthascii_table },
+  { "FullWidthAsciiToHalfWidthAscii", &Util::FullWidthAsciiToHalfWidthAscii,
+    fullwidthascii_to_halfwidthascii_da,
+    fullwidthascii_to_halfwidthascii_table },
+  { "HalfWidthKatakanaToFullWidthKatakana",
+    &Util::HalfWidthKatakanaToFullWidthKatakana,
+    halfwidthkatakana_to_fullwidthkatakana_da,
+    halfwidthkatakana_to_fullwidthkatakana_table },
+  { "FullWidthKatakanaToHalfWidthKatakana",
+    &Util::FullWidthKatakanaToHalfWidthKatakana,
+    fullwidthkatakana_to_halfwidthkatakana_da,
+    fullwidthkatakana_to_halfwidthkatakana_table },
+  { "NormalizeVoicedSoundMark", &Util::NormalizeVoicedSoundMark,
+    normalize_voiced_sound_da, normalize_voiced_sound_table },
+};
+
+void LoadCandidates(const string &filename, vector<string> *candidates) {
+  InputFileStream ifs(filename.c_str());
+  CHECK(ifs.good()) << "cannot open: " << filename;
+  string line;
+  vector<string> fields;
+  while (getline(ifs, line)) {
+    fields.clear();
+    Util::SplitStringUsing(line, "\t", &fields);
+    if (fields.empty()) {
+      continue;
+    }
+    candidates->push_back(fields[0]);
+    if (fields.size() >= 5) {
+      candidates->push_back(fields[4]);
+    }
+  }
+}
+
+// Returns the elapsed time in microseconds.
+double RunFastPath(const BenchmarkCase &test_case,
+                   const vector<string> &candidates) {
+  string output;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int n = 0; n < FLAGS_iterations; ++n) {
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      (*test_case.func)(candidates[i], &output);
+    }
+  }
+  stopwatch.Stop();
+  return stopwatch.GetElapsedMicroseconds();
+}
+
+double RunRules(const BenchmarkCase &test_case,
+                const vector<string> &candidates) {
+  string output;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int n = 0; n < FLAGS_iterations; ++n) {
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      TextConverter::Convert(test_case.da, test_case.table,
+                             candidates[i], &output);
+    }
+  }
+  stopwatch.Stop();
+  return stopwatch.GetElapsedMicroseconds();
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  vector<string> candidates;
+  mozc::LoadCandidates(FLAGS_input, &candidates);
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    total_bytes += candidates[i].size();
+  }
+  cout << "candidates: " << candidates.size()
+       << ", bytes: " << total_bytes << endl;
+  CHECK_GT(total_bytes, 0);
+
+  const double megabytes =
+      static_cast<double>(total_bytes) * FLAGS_iterations / (1024 * 1024);
+  for (size_t i = 0; i < arraysize(mozc::kBenchmarkCases); ++i) {
+    const mozc::BenchmarkCase &test_case = mozc::kBenchmarkCases[i];
+    // Warm up the tables before measuring.
+    string output;
+    (*test_case.func)(candidates[0], &output);
+    const double rules_usec = mozc::RunRules(test_case, candidates);
+    const double fast_usec = mozc::RunFastPath(test_case, candidates);
+    cout << test_case.name << ": "
+         << "rules " << megabytes * 1000000 / rules_usec << " MB/s, "
+         << "table " << megabytes * 1000000 / fast_usec << " MB/s, "
+         << "speedup " << rules_usec / fast_usec << "x" << endl;
+  }
+  return 0;
+}
@@ -43,6 +43,7 @@
 #include "base/logging.h"
 #include "base/mutex.h"
 #include "base/number_util.h"
+#include "base/text_converter.h"
 #include "base/thread.h"
 #include "testing/base/public/googletest.h"
 #include "testing/base/public/gunit.h"
@@ -51,6 +52,10 @@ DECLARE_string(test_srcdir);
 
 namespace mozc {
 
+// The raw rules are used to verify the table-driven fast path of script
+// conversions.
+#include "base/japanese_util_rule.h"
+
 namespace {
 
 void FillTestCharacterSetMap(map<char32, Util::CharacterSet> *test_map) {
@@ -1088,6 +1093,94 @@ TEST(UtilTest, NormalizeVoicedSoundMark) {
             "\x81\x8a\xe3\x82\x8a\xe3\x82\x93", output);
 }
 
+TEST(UtilTest, ScriptConversionIsConsistentWithRules) {
+  typedef void (*ConvertFunc)(const StringPiece, string *);
+  const struct {
+    ConvertFunc func;
+    const TextConverter::DoubleArray *da;
+    const char *table;
+  } kTestCases[] = {
+    { &Util::HiraganaToKatakana,
+      hiragana_to_katakana_da, hiragana_to_katakana_table },
+    { &Util::KatakanaToHiragana,
+      katakana_to_hiragana_da, katakana_to_hiragana_table },
+    { &Util::HalfWidthAsciiToFullWidthAscii,
+      halfwidthascii_to_fullwidthascii_da,
+      halfwidthascii_to_fullwidthascii_table },
+    { &Util::FullWidthAsciiToHalfWidthAscii,
+      fullwidthascii_to_halfwidthascii_da,
+      fullwidthascii_to_halfwidthascii_table },
+    { &Util::HalfWidthKatakanaToFullWidthKatakana,
+      halfwidthkatakana_to_fullwidthkatakana_da,
+      halfwidthkatakana_to_fullwidthkatakana_table },
+    { &Util::FullWidthKatakanaToHalfWidthKatakana,
+      fullwidthkatakana_to_halfwidthkatakana_da,
+      fullwidthkatakana_to_halfwidthkatakana_table },
+    { &Util::NormalizeVoicedSoundMark,
+      normalize_voiced_sound_da, normalize_voiced_sound_table },
+  };
+
+  // ASCII, the Hiragana/Katakana block, and a few characters outside of the
+  // fast path tables (full-width space, half-width katakana and kanji).
+  vector<string> chars;
+  for (char32 c = 0x01; c < 0x80; ++c) {
+    string s;
+    Util::UCS4ToUTF8(c, &s);
+    chars.push_back(s);
+  }
+  for (char32 c = 0x3040; c < 0x3100; ++c) {
+    string s;
+    Util::UCS4ToUTF8(c, &s);
+    chars.push_back(s);
+  }
+  chars.push_back("\xe3\x80\x80");  // "　"
+  chars.push_back("\xef\xbd\xb3");  // "ｳ"
+  chars.push_back("\xef\xbe\x9e");  // "ﾞ"
+  chars.push_back("\xe6\xbc\xa2");  // "漢"
+
+  for (size_t i = 0; i < arraysize(kTestCases); ++i) {
+    for (size_t j = 0; j < chars.size(); ++j) {
+      for (size_t k = 0; k < chars.size(); ++k) {
+        const string input = chars[j] + chars[k];
+        string expected, actual;
+        TextConverter::Convert(kTestCases[i].da, kTestCases[i].table,
+                               input, &expected);
+        (*kTestCases[i].func)(input, &actual);
+        ASSERT_EQ(expected, actual) << i << ": " << input;
+      }
+    }
+  }
+}
+
+TEST(UtilTest, ScriptConversionOfLongInputs) {
+  // Exercise the ASCII run scanner across its block boundaries.
+  for (size_t pos = 0; pos < 40; ++pos) {
+    string input(40, 'a');
+    // "あ"
+    input.replace(pos, 1, "\xe3\x81\x82");
+    string expected(40, 'a');
+    // "ア"
+    expected.replace(pos, 1, "\xe3\x82\xa2");
+    string output;
+    Util::HiraganaToKatakana(input, &output);
+    EXPECT_EQ(expected, output);
+    string reverted;
+    Util::KatakanaToHiragana(output, &reverted);
+    EXPECT_EQ(input, reverted);
+  }
+
+  // "ぐーぐるの日本語入力"
+  const string input = "\xe3\x81\x90\xe3\x83\xbc\xe3\x81\x90\xe3\x82\x8b"
+                       "\xe3\x81\xae\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e"
+                       "\xe5\x85\xa5\xe5\x8a\x9b";
+  string output;
+  Util::HiraganaToKatakana(input, &output);
+  // "グーグルノ日本語入力"
+  EXPECT_EQ("\xe3\x82\xb0\xe3\x83\xbc\xe3\x82\xb0\xe3\x83\xab\xe3\x83"
+            "\x8e\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe5\x85\xa5\xe5"
+            "\x8a\x9b", output);
+}
+
 TEST(UtilTest, IsFullWidthSymbolInHalfWidthKatakana) {
   // "グーグル"
   EXPECT_FALSE(Util::IsFullWidthSymbolInHalfWidthKatakana("\xe3\x82\xb0\xe3\x83"
@@ -2125,6 +2218,35 @@ TEST(UtilTest, Fingerprint32WithSeed_uint32) {
   EXPECT_EQ(num_hash, str_hash) << num_hash << " != " << str_hash;
 }
 
+TEST(UtilTest, FingerprintBuilder) {
+  const uint32 kSeed = 0xabcdef;
+  // Covers the pieces shorter than, equal to and longer than a 12-byte
+  // block, and the boundaries of the blocks at various offsets.
+  const char *kPieces[] = {
+    "", "a", "\t", "abcdefghijk", "abcdefghijkl", "abcdefghijklm",
+    // "ひらがな" (non-ASCII bytes)
+    "\xE3\x81\xB2\xE3\x82\x89\xE3\x81\x8C\xE3\x81\xAA",
+    "0123456789012345678901234567890123456789",
+  };
+  for (size_t i = 0; i < arraysize(kPieces); ++i) {
+    for (size_t j = 0; j < arraysize(kPieces); ++j) {
+      for (size_t k = 0; k < arraysize(kPieces); ++k) {
+        const string joined =
+            string(kPieces[i]) + kPieces[j] + kPieces[k];
+        FingerprintBuilder builder(kSeed);
+        builder.Append(kPieces[i]);
+        builder.Append(kPieces[j]);
+        builder.Append(kPieces[k]);
+        EXPECT_EQ(Util::FingerprintWithSeed(joined, kSeed), builder.Get())
+            << joined;
+      }
+    }
+  }
+
+  FingerprintBuilder empty(kSeed);
+  EXPECT_EQ(Util::FingerprintWithSeed("", kSeed), empty.Get());
+}
+
 TEST(UtilTest, RandomSeedTest) {
   Util::SetRandomSeed(0);
   const int first_try = Util::Random(INT_MAX);
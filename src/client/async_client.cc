@@ -0,0 +1,238 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "client/async_client.h"
+
+#include "base/logging.h"
+#include "base/thread.h"
+#include "client/client_interface.h"
+
+namespace mozc {
+namespace client {
+namespace {
+
+// Returns true if |input| is a key which only edits the preedit, such that
+// the suggestions for the preedit before it are never shown.  Special keys
+// and shortcuts are excluded since they may operate on the suggestions.
+bool IsPreeditEditingKey(const commands::Input &input) {
+  if (input.type() != commands::Input::SEND_KEY) {
+    return false;
+  }
+  const commands::KeyEvent &key = input.key();
+  return key.has_key_code() && !key.has_special_key() &&
+      key.modifier_keys_size() == 0;
+}
+
+}  // namespace
+
+// A dedicated thread rather than a task of the shared executor: it blocks on
+// the IPC to the server for each request, the requests must be sent in order,
+// and key events must not wait behind background tasks of the process.
+class AsyncClient::Worker : public Thread {
+ public:
+  explicit Worker(AsyncClient *client) : client_(client) {}
+  virtual ~Worker() {}
+
+  virtual void Run() {
+    while (true) {
+      bool request_suggestion = true;
+      bool stopped = false;
+      scoped_ptr<Request> request(
+          client_->PopRequest(&request_suggestion, &stopped));
+      if (request.get() != NULL) {
+        client_->ProcessRequest(*request, request_suggestion);
+        continue;
+      }
+      if (stopped) {
+        return;
+      }
+      // PushRequest() notifies once per key event.  Keys typed while a
+      // request is in flight leave the event signaled, so this loop drains
+      // them all, coalescing their suggestions, before it sleeps again.
+      wakeup_.Wait(-1);
+    }
+  }
+
+  void WakeUp() {
+    wakeup_.Notify();
+  }
+
+ private:
+  AsyncClient *client_;
+  UnnamedEvent wakeup_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+AsyncClient::AsyncClient(ClientInterface *client, Callback *callback)
+    : client_(client),
+      callback_(callback),
+      next_request_id_(1),
+      num_unfinished_requests_(0),
+      coalesced_keys_count_(0),
+      stopped_(false) {
+  DCHECK(client_);
+  DCHECK(callback_);
+  worker_.reset(new Worker(this));
+  worker_->Start();
+}
+
+AsyncClient::~AsyncClient() {
+  {
+    scoped_lock l(&mutex_);
+    stopped_ = true;
+  }
+  worker_->WakeUp();
+  worker_->Join();
+  DCHECK(requests_.empty());
+}
+
+uint64 AsyncClient::SendKeyAsync(const commands::KeyEvent &key,
+                                 const commands::Context &context) {
+  Request *request = new Request;
+  request->input.set_type(commands::Input::SEND_KEY);
+  request->input.mutable_key()->CopyFrom(key);
+  // Keeps the context unset for the default instance as Client does.
+  if (&context != &commands::Context::default_instance()) {
+    request->input.mutable_context()->CopyFrom(context);
+  }
+  return PushRequest(request);
+}
+
+uint64 AsyncClient::SendCommandAsync(const commands::SessionCommand &command,
+                                     const commands::Context &context) {
+  Request *request = new Request;
+  request->input.set_type(commands::Input::SEND_COMMAND);
+  request->input.mutable_command()->CopyFrom(command);
+  // Keeps the context unset for the default instance as Client does.
+  if (&context != &commands::Context::default_instance()) {
+    request->input.mutable_context()->CopyFrom(context);
+  }
+  return PushRequest(request);
+}
+
+void AsyncClient::Flush() {
+  while (true) {
+    {
+      scoped_lock l(&mutex_);
+      if (num_unfinished_requests_ == 0) {
+        return;
+      }
+    }
+    finished_event_.Wait(-1);
+  }
+}
+
+uint64 AsyncClient::coalesced_keys_count() const {
+  scoped_lock l(&mutex_);
+  return coalesced_keys_count_;
+}
+
+bool AsyncClient::HasPendingRequest() const {
+  scoped_lock l(&mutex_);
+  return !requests_.empty();
+}
+
+uint64 AsyncClient::PushRequest(Request *request) {
+  uint64 id = 0;
+  {
+    scoped_lock l(&mutex_);
+    DCHECK(!stopped_);
+    id = next_request_id_++;
+    request->id = id;
+    requests_.push_back(request);
+    ++num_unfinished_requests_;
+  }
+  worker_->WakeUp();
+  return id;
+}
+
+AsyncClient::Request *AsyncClient::PopRequest(bool *request_suggestion,
+                                              bool *stopped) {
+  scoped_lock l(&mutex_);
+  *stopped = stopped_;
+  *request_suggestion = true;
+  if (requests_.empty()) {
+    return NULL;
+  }
+  Request *request = requests_.front();
+  requests_.pop_front();
+  if (request->input.type() == commands::Input::SEND_KEY &&
+      !requests_.empty() && IsPreeditEditingKey(requests_.front()->input)) {
+    *request_suggestion = false;
+    ++coalesced_keys_count_;
+  }
+  return request;
+}
+
+void AsyncClient::ProcessRequest(const Request &request,
+                                 bool request_suggestion) {
+  const commands::Input &input = request.input;
+  commands::Output output;
+  bool succeeded = false;
+  switch (input.type()) {
+    case commands::Input::SEND_KEY:
+      succeeded = client_->SendKeyWithOption(input.key(), input.context(),
+                                             request_suggestion, &output);
+      break;
+    case commands::Input::SEND_COMMAND:
+      succeeded = client_->SendCommandWithContext(input.command(),
+                                                  input.context(), &output);
+      break;
+    default:
+      LOG(DFATAL) << "Unexpected request type: " << input.type();
+      break;
+  }
+  callback_->OnResponse(request.id, succeeded, output);
+
+  // Fetches the deferred suggestions unless another request is waiting.
+  // The server discards them on that request since they are stale.
+  if (succeeded && output.has_callback() &&
+      output.callback().session_command().type() ==
+          commands::SessionCommand::GET_ASYNC_RESULT &&
+      !HasPendingRequest()) {
+    commands::SessionCommand command;
+    command.set_type(commands::SessionCommand::GET_ASYNC_RESULT);
+    commands::Output async_output;
+    const bool async_succeeded = client_->SendCommandWithContext(
+        command, input.context(), &async_output);
+    callback_->OnResponse(request.id, async_succeeded, async_output);
+  }
+
+  scoped_lock l(&mutex_);
+  DCHECK_GT(num_unfinished_requests_, 0);
+  --num_unfinished_requests_;
+  if (num_unfinished_requests_ == 0) {
+    finished_event_.Notify();
+  }
+}
+
+}  // namespace client
+}  // namespace mozc
@@ -0,0 +1,133 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// AsyncClient lets a frontend submit SEND_KEY and SEND_COMMAND requests
+// without waiting for the server.  The requests are sent in order from a
+// worker thread and the responses are delivered through a callback.
+//
+// While the user types faster than the server responds, the keys queue up.
+// Suggestions for a preedit which is immediately replaced by the next
+// pending key are never shown, so such keys are sent with
+// Input::request_suggestion = false.  Only the last key of a run asks for
+// suggestions.  The keys themselves are never dropped because every one of
+// them updates the composition.
+//
+// When the server defers the suggestions of a key (see
+// Capability::deferred_suggestion), AsyncClient fetches them with
+// GET_ASYNC_RESULT unless another request is already pending, and
+// delivers the result as the second response to the same request id.
+
+#ifndef MOZC_CLIENT_ASYNC_CLIENT_H_
+#define MOZC_CLIENT_ASYNC_CLIENT_H_
+
+#include <deque>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/scoped_ptr.h"
+#include "base/unnamed_event.h"
+#include "session/commands.pb.h"
+
+namespace mozc {
+namespace client {
+
+class ClientInterface;
+
+class AsyncClient {
+ public:
+  class Callback {
+   public:
+    virtual ~Callback() {}
+
+    // Called on the worker thread with the response to the request
+    // |request_id|.  |succeeded| is false when the request failed.  Called
+    // twice for a key whose suggestions are deferred by the server.
+    virtual void OnResponse(uint64 request_id, bool succeeded,
+                            const commands::Output &output) = 0;
+  };
+
+  // Does not take the ownership of |client| and |callback|.  Once this
+  // object is created, |client| must not be used by other threads until
+  // Flush() returns.
+  AsyncClient(ClientInterface *client, Callback *callback);
+
+  // Sends all the pending requests before returning.
+  ~AsyncClient();
+
+  // Queues a request and returns its id, which is passed to the callback.
+  // Ids start from 1 and increase in the order of submission.
+  uint64 SendKeyAsync(const commands::KeyEvent &key,
+                      const commands::Context &context);
+  uint64 SendCommandAsync(const commands::SessionCommand &command,
+                          const commands::Context &context);
+
+  // Blocks until the responses to all the requests submitted so far are
+  // delivered.
+  void Flush();
+
+  // Returns the number of keys sent without requesting suggestions.
+  uint64 coalesced_keys_count() const;
+
+ private:
+  class Worker;
+
+  struct Request {
+    uint64 id;
+    commands::Input input;
+  };
+
+  uint64 PushRequest(Request *request);
+
+  // Called by the worker.  Returns NULL when the queue is empty.  Sets
+  // |request_suggestion| to false if the next pending request is a key
+  // which replaces the preedit made by the returned one.
+  Request *PopRequest(bool *request_suggestion, bool *stopped);
+  void ProcessRequest(const Request &request, bool request_suggestion);
+  bool HasPendingRequest() const;
+
+  ClientInterface *client_;
+  Callback *callback_;
+  mutable Mutex mutex_;
+  deque<Request *> requests_;
+  uint64 next_request_id_;
+  // Number of requests whose responses are not delivered yet.
+  size_t num_unfinished_requests_;
+  uint64 coalesced_keys_count_;
+  bool stopped_;
+  UnnamedEvent finished_event_;
+  scoped_ptr<Worker> worker_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncClient);
+};
+
+}  // namespace client
+}  // namespace mozc
+
+#endif  // MOZC_CLIENT_ASYNC_CLIENT_H_
@@ -0,0 +1,275 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "client/async_client.h"
+
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/port.h"
+#include "base/unnamed_event.h"
+#include "client/client_mock.h"
+#include "session/commands.pb.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace client {
+namespace {
+
+struct SentRequest {
+  commands::Input::CommandType type;
+  int key_code;
+  bool request_suggestion;
+};
+
+// Records the requests.  When |blocking| is set, the first request blocks
+// until Release() is called so that the following ones queue up.
+class RecordingClient : public ClientMock {
+ public:
+  explicit RecordingClient(bool blocking)
+      : blocking_(blocking), defer_suggestion_(false), num_calls_(0) {}
+
+  // Makes the keys ask for GET_ASYNC_RESULT as the server does when it
+  // defers the suggestions.
+  void set_defer_suggestion(bool defer_suggestion) {
+    defer_suggestion_ = defer_suggestion;
+  }
+
+  virtual bool SendKeyWithOption(const commands::KeyEvent &key,
+                                 const commands::Context &context,
+                                 bool request_suggestion,
+                                 commands::Output *output) {
+    SentRequest request;
+    request.type = commands::Input::SEND_KEY;
+    request.key_code = key.has_key_code() ? key.key_code() : -1;
+    request.request_suggestion = request_suggestion;
+    Record(request);
+    output->set_consumed(true);
+    if (defer_suggestion_) {
+      output->mutable_callback()->mutable_session_command()->set_type(
+          commands::SessionCommand::GET_ASYNC_RESULT);
+    }
+    return true;
+  }
+
+  virtual bool SendCommandWithContext(const commands::SessionCommand &command,
+                                      const commands::Context &context,
+                                      commands::Output *output) {
+    SentRequest request;
+    request.type = commands::Input::SEND_COMMAND;
+    request.key_code = -1;
+    request.request_suggestion = true;
+    Record(request);
+    // Fails except for GET_ASYNC_RESULT to test |succeeded|.
+    return command.type() == commands::SessionCommand::GET_ASYNC_RESULT;
+  }
+
+  void WaitForFirstRequest() {
+    started_.Wait(-1);
+  }
+
+  void Release() {
+    released_.Notify();
+  }
+
+  vector<SentRequest> requests() const {
+    scoped_lock l(&mutex_);
+    return requests_;
+  }
+
+ private:
+  void Record(const SentRequest &request) {
+    bool is_first = false;
+    {
+      scoped_lock l(&mutex_);
+      requests_.push_back(request);
+      is_first = (num_calls_++ == 0);
+    }
+    if (blocking_ && is_first) {
+      started_.Notify();
+      released_.Wait(-1);
+    }
+  }
+
+  const bool blocking_;
+  bool defer_suggestion_;
+  mutable Mutex mutex_;
+  vector<SentRequest> requests_;
+  int num_calls_;
+  UnnamedEvent started_;
+  UnnamedEvent released_;
+};
+
+class RecordingCallback : public AsyncClient::Callback {
+ public:
+  virtual void OnResponse(uint64 request_id, bool succeeded,
+                          const commands::Output &output) {
+    scoped_lock l(&mutex_);
+    ids_.push_back(request_id);
+    results_.push_back(succeeded);
+  }
+
+  vector<uint64> ids() const {
+    scoped_lock l(&mutex_);
+    return ids_;
+  }
+
+  vector<bool> results() const {
+    scoped_lock l(&mutex_);
+    return results_;
+  }
+
+ private:
+  mutable Mutex mutex_;
+  vector<uint64> ids_;
+  vector<bool> results_;
+};
+
+commands::KeyEvent CharKey(char c) {
+  commands::KeyEvent key;
+  key.set_key_code(c);
+  return key;
+}
+
+}  // namespace
+
+TEST(AsyncClientTest, DeliversResponsesInOrder) {
+  RecordingClient client(false);
+  RecordingCallback callback;
+  AsyncClient async_client(&client, &callback);
+
+  const commands::Context &context = commands::Context::default_instance();
+  EXPECT_EQ(1, async_client.SendKeyAsync(CharKey('a'), context));
+  commands::SessionCommand command;
+  command.set_type(commands::SessionCommand::REVERT);
+  EXPECT_EQ(2, async_client.SendCommandAsync(command, context));
+  EXPECT_EQ(3, async_client.SendKeyAsync(CharKey('b'), context));
+  async_client.Flush();
+
+  const vector<uint64> ids = callback.ids();
+  ASSERT_EQ(3, ids.size());
+  EXPECT_EQ(1, ids[0]);
+  EXPECT_EQ(2, ids[1]);
+  EXPECT_EQ(3, ids[2]);
+  const vector<bool> results = callback.results();
+  EXPECT_TRUE(results[0]);
+  EXPECT_FALSE(results[1]);
+  EXPECT_TRUE(results[2]);
+
+  const vector<SentRequest> requests = client.requests();
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ(commands::Input::SEND_KEY, requests[0].type);
+  EXPECT_EQ(commands::Input::SEND_COMMAND, requests[1].type);
+  EXPECT_EQ(commands::Input::SEND_KEY, requests[2].type);
+}
+
+TEST(AsyncClientTest, CoalescesSuggestions) {
+  RecordingClient client(true);
+  RecordingCallback callback;
+  AsyncClient async_client(&client, &callback);
+
+  const commands::Context &context = commands::Context::default_instance();
+  async_client.SendKeyAsync(CharKey('k'), context);
+  // The following requests queue up while the first one is in progress.
+  client.WaitForFirstRequest();
+  async_client.SendKeyAsync(CharKey('a'), context);
+  async_client.SendKeyAsync(CharKey('n'), context);
+  async_client.SendKeyAsync(CharKey('j'), context);
+  commands::KeyEvent space;
+  space.set_special_key(commands::KeyEvent::SPACE);
+  async_client.SendKeyAsync(space, context);
+  client.Release();
+  async_client.Flush();
+
+  const vector<SentRequest> requests = client.requests();
+  ASSERT_EQ(5, requests.size());
+  // Sent before the others were queued.
+  EXPECT_EQ('k', requests[0].key_code);
+  EXPECT_TRUE(requests[0].request_suggestion);
+  // Followed by a character key.
+  EXPECT_EQ('a', requests[1].key_code);
+  EXPECT_FALSE(requests[1].request_suggestion);
+  EXPECT_EQ('n', requests[2].key_code);
+  EXPECT_FALSE(requests[2].request_suggestion);
+  // Followed by a special key, which may operate on the suggestions.
+  EXPECT_EQ('j', requests[3].key_code);
+  EXPECT_TRUE(requests[3].request_suggestion);
+  EXPECT_TRUE(requests[4].request_suggestion);
+  EXPECT_EQ(2, async_client.coalesced_keys_count());
+  EXPECT_EQ(5, callback.ids().size());
+}
+
+TEST(AsyncClientTest, FetchesDeferredSuggestions) {
+  RecordingClient client(true);
+  client.set_defer_suggestion(true);
+  RecordingCallback callback;
+  AsyncClient async_client(&client, &callback);
+
+  const commands::Context &context = commands::Context::default_instance();
+  async_client.SendKeyAsync(CharKey('k'), context);
+  client.WaitForFirstRequest();
+  async_client.SendKeyAsync(CharKey('a'), context);
+  client.Release();
+  async_client.Flush();
+
+  // The suggestions for "k" are not fetched since "a" is pending.
+  const vector<SentRequest> requests = client.requests();
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ('k', requests[0].key_code);
+  EXPECT_EQ('a', requests[1].key_code);
+  EXPECT_EQ(commands::Input::SEND_COMMAND, requests[2].type);
+
+  // "a" receives the preedit and then the suggestions.
+  const vector<uint64> ids = callback.ids();
+  ASSERT_EQ(3, ids.size());
+  EXPECT_EQ(1, ids[0]);
+  EXPECT_EQ(2, ids[1]);
+  EXPECT_EQ(2, ids[2]);
+  EXPECT_TRUE(callback.results()[2]);
+}
+
+TEST(AsyncClientTest, DestructorSendsPendingRequests) {
+  RecordingClient client(true);
+  RecordingCallback callback;
+  {
+    AsyncClient async_client(&client, &callback);
+    const commands::Context &context = commands::Context::default_instance();
+    async_client.SendKeyAsync(CharKey('a'), context);
+    client.WaitForFirstRequest();
+    async_client.SendKeyAsync(CharKey('b'), context);
+    async_client.SendKeyAsync(CharKey('c'), context);
+    client.Release();
+  }
+  EXPECT_EQ(3, client.requests().size());
+  EXPECT_EQ(3, callback.ids().size());
+}
+
+}  // namespace client
+}  // namespace mozc
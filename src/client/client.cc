@@ -53,6 +53,7 @@
 #include "base/version.h"
 #include "config/config.pb.h"
 #include "ipc/ipc.h"
+#include "session/candidate_list_delta.h"
 #include "session/commands.pb.h"
 
 #ifdef OS_MACOSX
@@ -216,6 +217,7 @@ void Client::PlaybackHistory() {
   VLOG(1) << "Playback history: size=" << history_inputs_.size();
   for (size_t i = 0; i < history_inputs_.size(); ++i) {
     history_inputs_[i].set_id(id_);
+    history_inputs_[i].clear_all_candidate_words_sequence_number();
     if (!Call(history_inputs_[i], &output)) {
       LOG(ERROR) << "playback history failed: "
                  << history_inputs_[i].DebugString();
@@ -284,6 +286,13 @@ void Client::GetHistoryInputs(vector<commands::Input> *output) const {
 bool Client::SendKeyWithContext(const commands::KeyEvent &key,
                                 const commands::Context &context,
                                 commands::Output *output) {
+  return SendKeyWithOption(key, context, true, output);
+}
+
+bool Client::SendKeyWithOption(const commands::KeyEvent &key,
+                               const commands::Context &context,
+                               bool request_suggestion,
+                               commands::Output *output) {
 #ifdef DEBUG
   if (IsAbortKey(key)) {
     DCHECK(CrashReportUtil::Abort()) << "Not aborted by CrashReportUtil::Abort";
@@ -296,6 +305,9 @@ bool Client::SendKeyWithContext(const commands::KeyEvent &key,
   if (&context != &commands::Context::default_instance()) {
     input.mutable_context()->CopyFrom(context);
   }
+  if (!request_suggestion) {
+    input.set_request_suggestion(false);
+  }
   return EnsureCallCommand(&input, output);
 }
 
@@ -397,6 +409,7 @@ bool Client::EnsureCallCommand(commands::Input *input,
     }
   }
 
+  ExpandAllCandidateWords(output);
   PushHistory(*input, *output);
   return true;
 }
@@ -430,6 +443,8 @@ void Client::set_client_capability(const commands::Capability &capability) {
 
 bool Client::CreateSession() {
   id_ = 0;
+  // The new session does not know the lists sent by the previous one.
+  all_candidate_words_.Clear();
   commands::Input input;
   input.set_type(commands::Input::CREATE_SESSION);
 
@@ -729,6 +744,33 @@ void Client::InitInput(commands::Input *input) const {
   if (preferences_.get() != NULL) {
     input->mutable_config()->CopyFrom(*preferences_);
   }
+  if (client_capability_.incremental_all_candidate_words() &&
+      all_candidate_words_.has_sequence_number()) {
+    input->set_all_candidate_words_sequence_number(
+        all_candidate_words_.sequence_number());
+  } else {
+    input->clear_all_candidate_words_sequence_number();
+  }
+}
+
+void Client::ExpandAllCandidateWords(commands::Output *output) {
+  if (!client_capability_.incremental_all_candidate_words() ||
+      !output->has_all_candidate_words()) {
+    return;
+  }
+  commands::CandidateList candidate_words;
+  if (!CandidateListDelta::Decode(all_candidate_words_,
+                                  output->all_candidate_words(),
+                                  &candidate_words)) {
+    // The server makes an update only against the list we hold, so this
+    // should not happen.  The next response will be a complete list.
+    LOG(ERROR) << "Cannot reconstruct all_candidate_words";
+    output->clear_all_candidate_words();
+    all_candidate_words_.Clear();
+    return;
+  }
+  output->mutable_all_candidate_words()->Swap(&candidate_words);
+  all_candidate_words_.CopyFrom(output->all_candidate_words());
 }
 
 bool Client::CheckVersionOrRestartServerInternal(
@@ -37,6 +37,7 @@
       'target_name': 'client',
       'type': 'static_library',
       'sources': [
+        'async_client.cc',
         'client.cc',
         'server_launcher.cc',
       ],
@@ -44,6 +45,7 @@
         '../base/base.gyp:base',
         '../config/config.gyp:config_protocol',
         '../ipc/ipc.gyp:ipc',
+        '../session/session_base.gyp:candidate_list_delta',
         '../session/session_base.gyp:session_protocol',
       ],
     },
@@ -120,6 +120,10 @@ class Client : public ClientInterface {
   bool SendCommandWithContext(const commands::SessionCommand &command,
                               const commands::Context &context,
                               commands::Output *output);
+  bool SendKeyWithOption(const commands::KeyEvent &key,
+                         const commands::Context &context,
+                         bool request_suggestion,
+                         commands::Output *output);
 
   bool GetConfig(config::Config *config);
   bool SetConfig(const config::Config &config);
@@ -191,9 +195,14 @@ class Client : public ClientInterface {
   // Displays a message box to notify the user of fatal error.
   void OnFatal(ServerLauncherInterface::ServerErrorType type);
 
-  // Initialize input filling id and preferences.
+  // Initialize input filling id, preferences and the sequence number of
+  // all_candidate_words.
   void InitInput(commands::Input *input) const;
 
+  // Reconstructs the complete all_candidate_words of |output| when the
+  // server sent an incremental update.
+  void ExpandAllCandidateWords(commands::Output *output);
+
   bool CreateSession();
   bool DeleteSession();
   bool CallCommand(commands::Input::CommandType type);
@@ -257,6 +266,9 @@ class Client : public ClientInterface {
   // Remember the composition mode of input session for playback.
   commands::CompositionMode last_mode_;
   commands::Capability client_capability_;
+  // The last all_candidate_words received from the server, which is the base
+  // of incremental updates.
+  commands::CandidateList all_candidate_words_;
 };
 
 }  // namespace client
@@ -160,6 +160,17 @@ class ClientInterface {
                                       const commands::Context &context,
                                       commands::Output *output) = 0;
 
+  // Same as SendKeyWithContext(), but lets the caller tell the server
+  // whether suggestions are needed for the resulting preedit.  A caller
+  // which already has the next key to send can pass false to skip the
+  // interim suggestion.  The default implementation ignores the option.
+  virtual bool SendKeyWithOption(const commands::KeyEvent &key,
+                                 const commands::Context &context,
+                                 bool request_suggestion,
+                                 commands::Output *output) {
+    return SendKeyWithContext(key, context, output);
+  }
+
   // The methods below don't call
   // StartServer even if server is not available. This treatment
   // avoids unexceptional and continuous server restart trials.
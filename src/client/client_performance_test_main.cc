@@ -31,14 +31,17 @@
 #include <cmath>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <vector>
 #include <string>
 #include "base/base.h"
 #include "base/file_stream.h"
 #include "base/logging.h"
+#include "base/mutex.h"
 #include "base/singleton.h"
 #include "base/stopwatch.h"
 #include "base/util.h"
+#include "client/async_client.h"
 #include "client/client.h"
 #include "config/config_handler.h"
 #include "session/commands.pb.h"
@@ -46,6 +49,8 @@
 
 DEFINE_string(server_path, "", "specify server path");
 DEFINE_string(log_path, "", "specify log output file path");
+DEFINE_int32(burst_key_interval_msec, 0,
+             "interval between the keys typed in the burst typing test");
 
 namespace mozc {
 namespace {
@@ -95,10 +100,14 @@ class TestScenarioInterface {
  public:
   virtual void Run(Result *result) = 0;
 
-  TestScenarioInterface() {
+  // |capability| is sent to the server when the session is created.
+  explicit TestScenarioInterface(
+      const commands::Capability &capability =
+          commands::Capability::default_instance()) {
     if (!FLAGS_server_path.empty()) {
       client_.set_server_program(FLAGS_server_path);
     }
+    client_.set_client_capability(capability);
     CHECK(client_.IsValidRunLevel()) << "IsValidRunLevel failed";
     CHECK(client_.EnsureSession()) << "EnsureSession failed";
     CHECK(client_.NoOperation()) << "Server is not responding";
@@ -235,6 +244,112 @@ class PreeditWithSuggestion : public PreeditCommon {
   }
 };
 
+// Types each sentence without waiting for the responses, and measures the
+// time from the keystroke to its preedit delivered by AsyncClient.  The
+// suggestions are deferred by the server, and the time until they are
+// delivered is logged.
+class BurstTyping : public TestScenarioInterface,
+                    public client::AsyncClient::Callback {
+ public:
+  BurstTyping() : TestScenarioInterface(GetCapability()) {}
+
+  virtual void Run(Result *result) {
+    result->test_name = "burst_typing_with_deferred_suggestion";
+    ResetConfig();
+    IMEOn();
+    EnableSuggestion();
+    RunTest(result);
+    IMEOff();
+    ResetConfig();
+  }
+
+  // The first response to a key carries the preedit.  When the suggestions
+  // are deferred, the second one carries them.
+  virtual void OnResponse(uint64 request_id, bool succeeded,
+                          const commands::Output &output) {
+    const uint64 now = GetTimeInUsec();
+    scoped_lock l(&mutex_);
+    map<uint64, uint64>::iterator it = sent_times_.find(request_id);
+    if (it != sent_times_.end()) {
+      latencies_.push_back(static_cast<uint32>(now - it->second));
+      if (output.has_callback()) {
+        deferred_sent_times_[request_id] = it->second;
+      }
+      sent_times_.erase(it);
+      return;
+    }
+    it = deferred_sent_times_.find(request_id);
+    if (it != deferred_sent_times_.end()) {
+      suggestion_latencies_.push_back(static_cast<uint32>(now - it->second));
+      deferred_sent_times_.erase(it);
+    }
+  }
+
+ private:
+  static commands::Capability GetCapability() {
+    commands::Capability capability;
+    capability.set_deferred_suggestion(true);
+    return capability;
+  }
+
+  static uint64 GetTimeInUsec() {
+    return Util::GetTicks() * 1000000 / Util::GetFrequency();
+  }
+
+  void RunTest(Result *result) {
+    const vector<vector<commands::KeyEvent> > &keys =
+        Singleton<TestSentenceGenerator>::get()->GetTestKeys();
+    const commands::Context &context = commands::Context::default_instance();
+    uint64 coalesced_keys = 0;
+    uint64 total_keys = 0;
+    {
+      // |client_| is used only by |async_client| until it is destroyed.
+      client::AsyncClient async_client(&client_, this);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        for (int j = 0; j < keys[i].size(); ++j) {
+          {
+            // Holds the lock so that the response cannot arrive before the
+            // time is recorded.
+            scoped_lock l(&mutex_);
+            const uint64 id = async_client.SendKeyAsync(keys[i][j], context);
+            sent_times_[id] = GetTimeInUsec();
+          }
+          ++total_keys;
+          if (FLAGS_burst_key_interval_msec > 0) {
+            Util::Sleep(FLAGS_burst_key_interval_msec);
+          }
+        }
+        commands::SessionCommand command;
+        command.set_type(commands::SessionCommand::REVERT);
+        async_client.SendCommandAsync(command, context);
+        async_client.Flush();
+      }
+      coalesced_keys = async_client.coalesced_keys_count();
+    }
+    LOG(INFO) << "Sent " << coalesced_keys << " of " << total_keys
+              << " keys without suggestions";
+
+    scoped_lock l(&mutex_);
+    if (!suggestion_latencies_.empty()) {
+      LOG(INFO) << "Deferred suggestions: "
+                << GetBasicStats(suggestion_latencies_);
+    }
+    result->operations_times.swap(latencies_);
+    sent_times_.clear();
+    deferred_sent_times_.clear();
+    suggestion_latencies_.clear();
+  }
+
+  Mutex mutex_;
+  map<uint64, uint64> sent_times_;
+  // Keys whose suggestions are deferred and not delivered yet.
+  map<uint64, uint64> deferred_sent_times_;
+  // Latencies of the preedits.
+  vector<uint32> latencies_;
+  // Latencies of the deferred suggestions from the keystrokes.
+  vector<uint32> suggestion_latencies_;
+};
+
 enum PredictionRequestType {
   ONE_CHAR,
   TWO_CHARS
@@ -370,6 +485,7 @@ int main(int argc, char **argv) {
 
   tests.push_back(new mozc::PreeditWithoutSuggestion);
   tests.push_back(new mozc::PreeditWithSuggestion);
+  tests.push_back(new mozc::BurstTyping);
   tests.push_back(new mozc::Conversion);
   tests.push_back(new mozc::PredictionWithOneChar);
   tests.push_back(new mozc::PredictionWithTwoChars);
@@ -299,6 +299,98 @@ TEST_F(ClientTest, SendKeyWithContext) {
   EXPECT_EQ(kSuppressSuggestion, input.context().suppress_suggestion());
 }
 
+TEST_F(ClientTest, SendKeyWithOption) {
+  const int mock_id = 123;
+  EXPECT_TRUE(SetupConnection(mock_id));
+
+  commands::KeyEvent key_event;
+  key_event.set_key_code('a');
+
+  commands::Output mock_output;
+  mock_output.set_id(mock_id);
+  mock_output.set_consumed(true);
+  SetMockOutput(mock_output);
+
+  commands::Output output;
+  EXPECT_TRUE(client_->SendKeyWithOption(
+      key_event, commands::Context::default_instance(), false, &output));
+  commands::Input input;
+  GetGeneratedInput(&input);
+  EXPECT_EQ(commands::Input::SEND_KEY, input.type());
+  EXPECT_FALSE(input.has_context());
+  ASSERT_TRUE(input.has_request_suggestion());
+  EXPECT_FALSE(input.request_suggestion());
+
+  // The field is left unset when suggestions are requested.
+  EXPECT_TRUE(client_->SendKeyWithOption(
+      key_event, commands::Context::default_instance(), true, &output));
+  GetGeneratedInput(&input);
+  EXPECT_FALSE(input.has_request_suggestion());
+}
+
+TEST_F(ClientTest, IncrementalAllCandidateWords) {
+  commands::Capability capability;
+  capability.set_incremental_all_candidate_words(true);
+  client_->set_client_capability(capability);
+  const int mock_id = 123;
+  EXPECT_TRUE(SetupConnection(mock_id));
+
+  commands::KeyEvent key_event;
+  key_event.set_special_key(commands::KeyEvent::SPACE);
+
+  commands::Output mock_output;
+  mock_output.set_id(mock_id);
+  mock_output.set_consumed(true);
+  commands::CandidateList *list = mock_output.mutable_all_candidate_words();
+  list->set_sequence_number(1);
+  list->set_focused_index(0);
+  for (int i = 0; i < 3; ++i) {
+    commands::CandidateWord *word = list->add_candidates();
+    word->set_index(i);
+    word->set_value(i == 0 ? "a" : (i == 1 ? "b" : "c"));
+  }
+  SetMockOutput(mock_output);
+
+  commands::Output output;
+  EXPECT_TRUE(client_->SendKey(key_event, &output));
+  EXPECT_EQ(3, output.all_candidate_words().candidates_size());
+  commands::Input input;
+  GetGeneratedInput(&input);
+  EXPECT_FALSE(input.has_all_candidate_words_sequence_number());
+
+  // The focus moves and "c" is replaced with "d".
+  list->Clear();
+  list->set_sequence_number(2);
+  list->set_base_sequence_number(1);
+  list->set_copied_prefix_size(2);
+  list->set_focused_index(1);
+  commands::CandidateWord *word = list->add_candidates();
+  word->set_index(2);
+  word->set_value("d");
+  SetMockOutput(mock_output);
+
+  EXPECT_TRUE(client_->SendKey(key_event, &output));
+  GetGeneratedInput(&input);
+  EXPECT_EQ(1, input.all_candidate_words_sequence_number());
+  const commands::CandidateList &expanded = output.all_candidate_words();
+  EXPECT_FALSE(expanded.has_base_sequence_number());
+  EXPECT_EQ(2, expanded.sequence_number());
+  EXPECT_EQ(1, expanded.focused_index());
+  ASSERT_EQ(3, expanded.candidates_size());
+  EXPECT_EQ("a", expanded.candidates(0).value());
+  EXPECT_EQ("b", expanded.candidates(1).value());
+  EXPECT_EQ("d", expanded.candidates(2).value());
+
+  // An update against an unknown list is dropped.
+  list->set_sequence_number(4);
+  list->set_base_sequence_number(3);
+  SetMockOutput(mock_output);
+  EXPECT_TRUE(client_->SendKey(key_event, &output));
+  GetGeneratedInput(&input);
+  EXPECT_EQ(2, input.all_candidate_words_sequence_number());
+  EXPECT_FALSE(output.has_all_candidate_words());
+}
+
 TEST_F(ClientTest, TestSendKey) {
   const int mock_id = 512;
   EXPECT_TRUE(SetupConnection(mock_id));
@@ -71,10 +71,12 @@
       'target_name': 'client_test',
       'type': 'executable',
       'sources': [
+        'async_client_test.cc',
         'client_test.cc',
       ],
       'dependencies': [
         'client.gyp:client',
+        'client.gyp:client_mock',
         '../testing/testing.gyp:gtest_main',
       ],
       'variables': {
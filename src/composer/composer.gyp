@@ -40,6 +40,7 @@
       'sources': [
         'composer.cc',
         'internal/char_chunk.cc',
+        'internal/compiled_table.cc',
         'internal/composition.cc',
         'internal/composition_input.cc',
         'internal/converter.cc',
@@ -70,6 +71,7 @@
       'sources': [
         'composer_test.cc',
         'internal/char_chunk_test.cc',
+        'internal/compiled_table_test.cc',
         'internal/composition_input_test.cc',
         'internal/composition_test.cc',
         'internal/converter_test.cc',
@@ -98,6 +100,16 @@
         'composer_test',
       ],
     },
+    {
+      'target_name': 'composer_benchmark_main',
+      'type': 'executable',
+      'sources': [
+        'composer_benchmark_main.cc',
+      ],
+      'dependencies': [
+        'composer',
+      ],
+    },
     {
       'target_name': 'gen_typing_model',
       'type': 'none',
@@ -0,0 +1,141 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Benchmark of typing romaji keystrokes through Composer::InsertCharacter.
+// Compares the lookups of a plain Table with those of a compiled Table.
+//
+// Usage:
+//   composer_benchmark_main --input=data/test/stress_test/sentences.txt
+//
+// Each line of the input is a hiragana sentence. It is split into phrases at
+// punctuations, converted to romaji and typed one key at a time. The
+// composition is reset after each phrase as if it were committed. Lines
+// starting with '#' are skipped.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/file_stream.h"
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/stopwatch.h"
+#include "base/util.h"
+#include "composer/composer.h"
+#include "composer/table.h"
+#include "session/commands.pb.h"
+
+DEFINE_string(input, "", "input file of hiragana sentences");
+DEFINE_string(table, "system://romanji-hiragana.tsv",
+              "preedit conversion table file.");
+DEFINE_int32(iterations, 10, "number of iterations");
+
+namespace mozc {
+namespace {
+
+using commands::Request;
+
+// Each sequence is stored as a list of keys, one UTF-8 character per key.
+void LoadKeySequences(const string &filename,
+                      vector<vector<string> > *sequences) {
+  InputFileStream ifs(filename.c_str());
+  CHECK(ifs.good()) << "cannot open: " << filename;
+  string line;
+  string comma_replaced, replaced;
+  vector<string> phrases;
+  while (getline(ifs, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    // Replaces "、" and "。" with a line break to split the sentence.
+    comma_replaced.clear();
+    Util::StringReplace(line, "\xE3\x80\x81", "\n", true, &comma_replaced);
+    replaced.clear();
+    Util::StringReplace(comma_replaced, "\xE3\x80\x82", "\n", true,
+                        &replaced);
+    phrases.clear();
+    Util::SplitStringUsing(replaced, "\n", &phrases);
+    for (size_t i = 0; i < phrases.size(); ++i) {
+      string romanji;
+      Util::HiraganaToRomanji(phrases[i], &romanji);
+      sequences->push_back(vector<string>());
+      Util::SplitStringToUtf8Chars(romanji, &sequences->back());
+    }
+  }
+}
+
+// Returns the elapsed time in microseconds.
+double TypeAll(const composer::Table &table,
+               const vector<vector<string> > &sequences) {
+  composer::Composer composer(&table, &Request::default_instance());
+  string preedit;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int n = 0; n < FLAGS_iterations; ++n) {
+    for (size_t i = 0; i < sequences.size(); ++i) {
+      const vector<string> &keys = sequences[i];
+      for (size_t j = 0; j < keys.size(); ++j) {
+        composer.InsertCharacter(keys[j]);
+      }
+      composer.GetStringForPreedit(&preedit);
+      composer.Reset();
+    }
+  }
+  stopwatch.Stop();
+  return stopwatch.GetElapsedMicroseconds();
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  vector<vector<string> > sequences;
+  mozc::LoadKeySequences(FLAGS_input, &sequences);
+  size_t total_keys = 0;
+  for (size_t i = 0; i < sequences.size(); ++i) {
+    total_keys += sequences[i].size();
+  }
+  cout << "phrases: " << sequences.size()
+       << ", keys: " << total_keys << endl;
+  CHECK_GT(total_keys, 0);
+
+  mozc::composer::Table table;
+  CHECK(table.LoadFromFile(FLAGS_table.c_str()));
+  const double plain_usec = mozc::TypeAll(table, sequences);
+  table.Compile();
+  const double compiled_usec = mozc::TypeAll(table, sequences);
+
+  const double keys = static_cast<double>(total_keys) * FLAGS_iterations;
+  cout << "plain " << plain_usec * 1000 / keys << " ns/key, "
+       << "compiled " << compiled_usec * 1000 / keys << " ns/key, "
+       << "speedup " << plain_usec / compiled_usec << "x" << endl;
+  return 0;
+}
@@ -0,0 +1,242 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/internal/compiled_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/util.h"
+#include "composer/table.h"
+
+namespace mozc {
+namespace composer {
+
+namespace {
+
+typedef pair<string, const Entry *> KeyAndEntry;
+
+// Byte length of the first character in |input|, which is never longer than
+// |input| itself. This is consistent with the key splitting in Trie.
+size_t GetHeadLength(StringPiece input) {
+  return min(Util::OneCharLen(input.data()), input.size());
+}
+
+// A node of the trie under construction. The keys in
+// [keys_begin, keys_end) share the first |depth| bytes.
+struct PendingNode {
+  size_t index;
+  size_t keys_begin;
+  size_t keys_end;
+  size_t depth;
+};
+
+}  // namespace
+
+CompiledTable::CompiledTable(const vector<const Entry *> &entries,
+                             bool case_sensitive)
+    : case_sensitive_(case_sensitive) {
+  vector<KeyAndEntry> keys;
+  keys.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    keys.push_back(make_pair(entries[i]->input(), entries[i]));
+  }
+  sort(keys.begin(), keys.end());
+
+  Node root = { 0, 0, -1, 0, 0 };
+  nodes_.push_back(root);
+  deque<PendingNode> queue;
+  const PendingNode pending_root = { 0, 0, keys.size(), 0 };
+  queue.push_back(pending_root);
+
+  // Nodes are created in level order so that the children of each node are
+  // contiguous in nodes_.
+  while (!queue.empty()) {
+    const PendingNode pending = queue.front();
+    queue.pop_front();
+
+    size_t i = pending.keys_begin;
+    if (i < pending.keys_end && keys[i].first.size() == pending.depth) {
+      nodes_[pending.index].entry_index = static_cast<int32>(entries_.size());
+      entries_.push_back(keys[i].second);
+      ++i;
+    }
+
+    nodes_[pending.index].children_begin = static_cast<uint32>(nodes_.size());
+    while (i < pending.keys_end) {
+      const StringPiece rest =
+          StringPiece(keys[i].first).substr(pending.depth);
+      const StringPiece label = rest.substr(0, GetHeadLength(rest));
+      size_t j = i + 1;
+      while (j < pending.keys_end &&
+             StringPiece(keys[j].first).substr(pending.depth,
+                                               label.size()) == label) {
+        ++j;
+      }
+      Node child = { static_cast<uint32>(labels_.size()),
+                     static_cast<uint32>(label.size()), -1, 0, 0 };
+      labels_.append(label.data(), label.size());
+      const PendingNode pending_child = {
+        nodes_.size(), i, j, pending.depth + label.size()
+      };
+      nodes_.push_back(child);
+      queue.push_back(pending_child);
+      i = j;
+    }
+    nodes_[pending.index].children_end = static_cast<uint32>(nodes_.size());
+  }
+  VLOG(1) << "Compiled " << entries_.size() << " entries into "
+          << nodes_.size() << " nodes";
+}
+
+CompiledTable::~CompiledTable() {}
+
+StringPiece CompiledTable::GetHead(StringPiece input, char *buf) const {
+  const StringPiece head = input.substr(0, GetHeadLength(input));
+  if (case_sensitive_) {
+    return head;
+  }
+  // Same normalization as Util::LowerString.
+  if (head.size() == 1 && 'A' <= head[0] && head[0] <= 'Z') {
+    buf[0] = head[0] + ('a' - 'A');
+    return StringPiece(buf, 1);
+  }
+  // "Ａ" (U+FF21, "\xEF\xBC\xA1") - "Ｚ" (U+FF3A, "\xEF\xBC\xBA") to
+  // "ａ" (U+FF41, "\xEF\xBD\x81") - "ｚ" (U+FF5A, "\xEF\xBD\x9A").
+  if (head.size() == 3 && head[0] == '\xEF' && head[1] == '\xBC' &&
+      static_cast<uint8>(head[2]) >= 0xA1 &&
+      static_cast<uint8>(head[2]) <= 0xBA) {
+    buf[0] = '\xEF';
+    buf[1] = '\xBD';
+    buf[2] = static_cast<char>(static_cast<uint8>(head[2]) - 0x20);
+    return StringPiece(buf, 3);
+  }
+  return head;
+}
+
+const CompiledTable::Node *CompiledTable::FindChild(
+    const Node &node, StringPiece label) const {
+  uint32 begin = node.children_begin;
+  uint32 end = node.children_end;
+  while (begin < end) {
+    const uint32 middle = begin + (end - begin) / 2;
+    const Node &child = nodes_[middle];
+    const int result =
+        StringPiece(labels_.data() + child.label_offset,
+                    child.label_length).compare(label);
+    if (result == 0) {
+      return &child;
+    }
+    if (result < 0) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+  return NULL;
+}
+
+const CompiledTable::Node *CompiledTable::Traverse(
+    StringPiece input, size_t *matched_length) const {
+  const Node *node = &nodes_[0];
+  *matched_length = 0;
+  char buf[4];
+  while (*matched_length < input.size()) {
+    const StringPiece head = GetHead(input.substr(*matched_length), buf);
+    const Node *child = FindChild(*node, head);
+    if (child == NULL) {
+      break;
+    }
+    node = child;
+    *matched_length += head.size();
+  }
+  return node;
+}
+
+const Entry *CompiledTable::LookUp(StringPiece input) const {
+  size_t matched_length = 0;
+  const Node *node = Traverse(input, &matched_length);
+  if (matched_length != input.size() || node->entry_index < 0) {
+    return NULL;
+  }
+  return entries_[node->entry_index];
+}
+
+const Entry *CompiledTable::LookUpPrefix(StringPiece input,
+                                         size_t *key_length,
+                                         bool *fixed) const {
+  // Trie::LookUpPrefix returns the entry of the deepest matched node, if
+  // any, without falling back to the shallower ones.
+  const Node *node = Traverse(input, key_length);
+  if (node->entry_index < 0) {
+    *fixed = true;
+    return NULL;
+  }
+  *fixed = (node->children_begin == node->children_end);
+  return entries_[node->entry_index];
+}
+
+void CompiledTable::LookUpPredictiveAll(
+    StringPiece input, vector<const Entry *> *results) const {
+  DCHECK(results);
+  size_t matched_length = 0;
+  const Node *node = Traverse(input, &matched_length);
+  if (matched_length != input.size()) {
+    return;
+  }
+  CollectEntries(*node, results);
+}
+
+bool CompiledTable::HasSubRules(StringPiece input) const {
+  if (input.empty()) {
+    return false;
+  }
+  size_t matched_length = 0;
+  Traverse(input, &matched_length);
+  return matched_length == input.size();
+}
+
+void CompiledTable::CollectEntries(const Node &node,
+                                   vector<const Entry *> *results) const {
+  if (node.entry_index >= 0) {
+    results->push_back(entries_[node.entry_index]);
+  }
+  for (uint32 i = node.children_begin; i < node.children_end; ++i) {
+    CollectEntries(nodes_[i], results);
+  }
+}
+
+}  // namespace composer
+}  // namespace mozc
@@ -0,0 +1,113 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Compiled, immutable representation of the rules in composer::Table.
+//
+// The rules are stored in a flat array of trie nodes in level order, where
+// the children of each node are contiguous and sorted by their labels (one
+// UTF-8 character each). Lookups walk the array with binary searches over
+// the children instead of chasing map<string, Trie*> nodes, and never copy
+// the input for case normalization. The results are the same as the ones of
+// Trie<const Entry *>, which is still used while the rules are being edited.
+
+#ifndef MOZC_COMPOSER_INTERNAL_COMPILED_TABLE_H_
+#define MOZC_COMPOSER_INTERNAL_COMPILED_TABLE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/port.h"
+#include "base/string_piece.h"
+
+namespace mozc {
+namespace composer {
+
+class Entry;
+
+class CompiledTable {
+ public:
+  // Builds the table from |entries|, keyed by Entry::input(). The entries
+  // are not owned and must outlive this object. If |case_sensitive| is
+  // false, upper case alphabets (both half and full width) in the lookup
+  // keys are treated as lower case ones.
+  CompiledTable(const vector<const Entry *> &entries, bool case_sensitive);
+  ~CompiledTable();
+
+  // Same semantics as the methods of Trie<const Entry *>.
+  const Entry *LookUp(StringPiece input) const;
+  const Entry *LookUpPrefix(StringPiece input,
+                            size_t *key_length,
+                            bool *fixed) const;
+  void LookUpPredictiveAll(StringPiece input,
+                           vector<const Entry *> *results) const;
+  bool HasSubRules(StringPiece input) const;
+
+  size_t node_size() const { return nodes_.size(); }
+
+ private:
+  struct Node {
+    // The label of the edge from the parent, stored in labels_.
+    uint32 label_offset;
+    uint32 label_length;
+    // Index in entries_, or -1 if no entry ends at this node.
+    int32 entry_index;
+    // Range of the children in nodes_.
+    uint32 children_begin;
+    uint32 children_end;
+  };
+
+  // Returns the child of |node| whose label is |label|, or NULL.
+  const Node *FindChild(const Node &node, StringPiece label) const;
+
+  // Walks the nodes from the root as long as |input| matches, and returns
+  // the deepest node. |matched_length| is the byte length of the matched
+  // prefix of |input|.
+  const Node *Traverse(StringPiece input, size_t *matched_length) const;
+
+  // Returns the first character of |input|, normalized to lower case if
+  // the table is case insensitive. |buf| is used as the storage of the
+  // normalized character.
+  StringPiece GetHead(StringPiece input, char *buf) const;
+
+  void CollectEntries(const Node &node,
+                      vector<const Entry *> *results) const;
+
+  vector<Node> nodes_;
+  string labels_;
+  vector<const Entry *> entries_;
+  const bool case_sensitive_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledTable);
+};
+
+}  // namespace composer
+}  // namespace mozc
+
+#endif  // MOZC_COMPOSER_INTERNAL_COMPILED_TABLE_H_
@@ -0,0 +1,190 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/internal/compiled_table.h"
+
+#include <string>
+#include <vector>
+
+#include "base/port.h"
+#include "base/util.h"
+#include "composer/table.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace composer {
+namespace {
+
+// Collects the keys to be tested: all the prefixes of all the rules, with
+// the upper cased variants and a character not in the rules appended.
+void GetTestKeys(const Table &table, vector<string> *keys) {
+  vector<const Entry *> entries;
+  table.LookUpPredictiveAll("", &entries);
+  keys->push_back("");
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const string &input = entries[i]->input();
+    for (size_t j = 1; j <= Util::CharsLen(input); ++j) {
+      string prefix;
+      Util::SubString(input, 0, j, &prefix);
+      keys->push_back(prefix);
+      keys->push_back(prefix + "q");
+      keys->push_back(prefix + "\xE3\x81\x82");  // "あ"
+      string upper = prefix;
+      Util::UpperString(&upper);
+      keys->push_back(upper);
+    }
+  }
+  keys->push_back("\xEF\xBC\xAB\xEF\xBC\xA1");  // "ＫＡ"
+}
+
+void ExpectSameResults(const Table &table, const CompiledTable &compiled) {
+  vector<string> keys;
+  GetTestKeys(table, &keys);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const string &key = keys[i];
+    EXPECT_EQ(table.LookUp(key), compiled.LookUp(key)) << key;
+
+    size_t expected_length = 0, actual_length = 0;
+    bool expected_fixed = false, actual_fixed = false;
+    EXPECT_EQ(table.LookUpPrefix(key, &expected_length, &expected_fixed),
+              compiled.LookUpPrefix(key, &actual_length, &actual_fixed))
+        << key;
+    EXPECT_EQ(expected_length, actual_length) << key;
+    EXPECT_EQ(expected_fixed, actual_fixed) << key;
+
+    vector<const Entry *> expected_entries, actual_entries;
+    table.LookUpPredictiveAll(key, &expected_entries);
+    compiled.LookUpPredictiveAll(key, &actual_entries);
+    EXPECT_EQ(expected_entries, actual_entries) << key;
+
+    EXPECT_EQ(table.HasSubRules(key), compiled.HasSubRules(key)) << key;
+  }
+}
+
+void GetEntries(const Table &table, vector<const Entry *> *entries) {
+  table.LookUpPredictiveAll("", entries);
+}
+
+TEST(CompiledTableTest, SmallTable) {
+  Table table;
+  // "あ"
+  table.AddRule("a",  "\xE3\x81\x82", "");
+  // "か"
+  table.AddRule("ka", "\xE3\x81\x8B", "");
+  // "っ"
+  table.AddRule("kk", "\xE3\x81\xA3", "k");
+  // "ん"
+  table.AddRule("n",  "\xE3\x82\x93", "");
+  // "ん"
+  table.AddRule("nn", "\xE3\x82\x93", "");
+  // "きゃ"
+  table.AddRule("kya", "\xE3\x81\x8D\xE3\x82\x83", "");
+  // "、"
+  table.AddRule("\xE3\x80\x81", "\xE3\x80\x81", "");
+
+  vector<const Entry *> entries;
+  GetEntries(table, &entries);
+  const CompiledTable compiled(entries, table.case_sensitive());
+  ExpectSameResults(table, compiled);
+
+  size_t key_length = 0;
+  bool fixed = false;
+  // "ky" has no entry, and shallower "k" is not used either.
+  EXPECT_TRUE(NULL == compiled.LookUpPrefix("kyo", &key_length, &fixed));
+  EXPECT_EQ(2, key_length);
+  EXPECT_TRUE(fixed);
+
+  const Entry *entry = compiled.LookUpPrefix("nk", &key_length, &fixed);
+  ASSERT_TRUE(entry != NULL);
+  EXPECT_EQ("n", entry->input());
+  EXPECT_EQ(1, key_length);
+  EXPECT_FALSE(fixed);
+
+  // Case insensitive.
+  entry = compiled.LookUp("KA");
+  ASSERT_TRUE(entry != NULL);
+  EXPECT_EQ("ka", entry->input());
+}
+
+TEST(CompiledTableTest, CaseSensitive) {
+  Table table;
+  // "あ"
+  table.AddRule("a",  "\xE3\x81\x82", "");
+  table.AddRule("A",  "A", "");
+  EXPECT_TRUE(table.case_sensitive());
+
+  vector<const Entry *> entries;
+  GetEntries(table, &entries);
+  const CompiledTable compiled(entries, table.case_sensitive());
+  ExpectSameResults(table, compiled);
+  EXPECT_EQ("A", compiled.LookUp("A")->result());
+}
+
+TEST(CompiledTableTest, SystemTables) {
+  const char *kTables[] = {
+    "system://romanji-hiragana.tsv",
+    "system://kana.tsv",
+    "system://12keys-hiragana.tsv",
+    "system://flick-hiragana.tsv",
+    "system://godan-hiragana.tsv",
+  };
+  for (size_t i = 0; i < arraysize(kTables); ++i) {
+    Table table;
+    ASSERT_TRUE(table.LoadFromFile(kTables[i])) << kTables[i];
+    vector<const Entry *> entries;
+    GetEntries(table, &entries);
+    const CompiledTable compiled(entries, table.case_sensitive());
+    ExpectSameResults(table, compiled);
+  }
+}
+
+TEST(CompiledTableTest, TableCompile) {
+  Table table;
+  // "か"
+  table.AddRule("ka", "\xE3\x81\x8B", "");
+  EXPECT_FALSE(table.is_compiled());
+  table.Compile();
+  EXPECT_TRUE(table.is_compiled());
+  EXPECT_EQ("\xE3\x81\x8B", table.LookUp("ka")->result());
+
+  // Modifying the rules discards the compiled table.
+  // "き"
+  table.AddRule("ki", "\xE3\x81\x8D", "");
+  EXPECT_FALSE(table.is_compiled());
+  EXPECT_EQ("\xE3\x81\x8D", table.LookUp("ki")->result());
+  table.Compile();
+  EXPECT_EQ("\xE3\x81\x8D", table.LookUp("ki")->result());
+  table.DeleteRule("ki");
+  EXPECT_FALSE(table.is_compiled());
+}
+
+}  // namespace
+}  // namespace composer
+}  // namespace mozc
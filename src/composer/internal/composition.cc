@@ -29,6 +29,8 @@
 
 #include "composer/internal/composition.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/util.h"
 #include "composer/internal/char_chunk.h"
@@ -52,6 +54,7 @@ void Composition::Erase() {
     delete *it;
   }
   chunks_.clear();
+  InvalidateLocalCache(0);
 }
 
 size_t Composition::InsertAt(size_t pos, const string &input) {
@@ -78,10 +81,12 @@ size_t Composition::InsertInput(size_t pos, const CompositionInput &input) {
   MaybeSplitChunkAt(pos, &right_chunk);
 
   CharChunkList::iterator left_chunk = GetInsertionChunk(&right_chunk);
-  CombinePendingChunks(left_chunk, input);
+  CombinePendingChunks(&left_chunk, input);
+  right_chunk = left_chunk + 1;
 
   CompositionInput mutable_input;
   mutable_input.CopyFrom(input);
+  InvalidateLocalCache(left_chunk - chunks_.begin());
   while (true) {
     (*left_chunk)->AddCompositionInput(&mutable_input);
     if (mutable_input.Empty()) {
@@ -91,6 +96,7 @@ size_t Composition::InsertInput(size_t pos, const CompositionInput &input) {
     mutable_input.set_is_new_input(false);
   }
 
+  UpdateLocalCache();
   return GetPosition(Transliterators::LOCAL, right_chunk);
 }
 
@@ -115,6 +121,7 @@ size_t Composition::DeleteAt(const size_t position) {
     // We have to consider 0-length chunk.
     // If a chunk contains only invisible characters,
     // the result of GetLength is 0.
+    InvalidateLocalCache(chunk_it - chunks_.begin());
     if ((*chunk_it)->GetLength(Transliterators::LOCAL) <= 1) {
       delete *chunk_it;
       chunks_.erase(chunk_it);
@@ -125,6 +132,7 @@ size_t Composition::DeleteAt(const size_t position) {
     (*chunk_it)->SplitChunk(Transliterators::LOCAL, 1, &left_deleted_chunk_ptr);
     scoped_ptr<CharChunk> left_deleted_chunk(left_deleted_chunk_ptr);
   }
+  UpdateLocalCache();
   return new_position;
 }
 
@@ -212,12 +220,14 @@ void Composition::SetTransliterator(
   size_t inner_position_to;
   GetChunkAt(position_to, Transliterators::LOCAL, &end_it, &inner_position_to);
 
+  InvalidateLocalCache(chunk_it - chunks_.begin());
   // chunk_it and end_it can be the same iterator from the beginning.
   while (chunk_it != end_it) {
     (*chunk_it)->SetTransliterator(transliterator);
     ++chunk_it;
   }
   (*end_it)->SetTransliterator(transliterator);
+  UpdateLocalCache();
 }
 
 Transliterators::Transliterator
@@ -231,7 +241,7 @@ Composition::GetTransliterator(size_t position) {
 }
 
 size_t Composition::GetLength() const {
-  return GetPosition(Transliterators::LOCAL, chunks_.end());
+  return GetLocalLengthBefore(chunks_.size());
 }
 
 void Composition::GetStringWithModes(
@@ -247,8 +257,14 @@ void Composition::GetStringWithModes(
   }
 
   CharChunkList::const_iterator it;
-  for (it = chunks_.begin(); *it != chunks_.back(); ++it) {
-    (*it)->AppendResult(transliterator, composition);
+  if (transliterator == Transliterators::LOCAL) {
+    const size_t last = chunks_.size() - 1;
+    AppendLocalStringBefore(last, composition);
+    it = chunks_.begin() + last;
+  } else {
+    for (it = chunks_.begin(); *it != chunks_.back(); ++it) {
+      (*it)->AppendResult(transliterator, composition);
+    }
   }
 
   switch (trim_mode) {
@@ -302,11 +318,7 @@ void Composition::GetString(string *composition) const {
     return;
   }
 
-  for (CharChunkList::const_iterator it = chunks_.begin();
-       it != chunks_.end();
-       ++it) {
-    (*it)->AppendResult(Transliterators::LOCAL, composition);
-  }
+  AppendLocalStringBefore(chunks_.size(), composition);
 }
 
 void Composition::GetStringWithTransliterator(
@@ -341,6 +353,23 @@ void Composition::GetChunkAt(const size_t position,
     return;
   }
 
+  if (transliterator == Transliterators::LOCAL &&
+      local_lengths_.size() == chunks_.size()) {
+    // The first chunk whose end is at or after |position|.
+    const vector<size_t>::const_iterator end_it =
+        lower_bound(local_lengths_.begin(), local_lengths_.end(), position);
+    if (end_it == local_lengths_.end()) {
+      *chunk_it = chunks_.end() - 1;
+      *inner_position = (**chunk_it)->GetLength(transliterator);
+      return;
+    }
+    const size_t index = end_it - local_lengths_.begin();
+    *chunk_it = chunks_.begin() + index;
+    *inner_position =
+        position - (index == 0 ? 0 : local_lengths_[index - 1]);
+    return;
+  }
+
   size_t rest_pos = position;
   CharChunkList::iterator it;
   for (it = chunks_.begin(); it != chunks_.end(); ++it) {
@@ -360,6 +389,9 @@ void Composition::GetChunkAt(const size_t position,
 size_t Composition::GetPosition(
     Transliterators::Transliterator transliterator,
     const CharChunkList::const_iterator &cur_it) const {
+  if (transliterator == Transliterators::LOCAL) {
+    return GetLocalLengthBefore(cur_it - chunks_.begin());
+  }
   size_t position = 0;
   CharChunkList::const_iterator it;
   for (it = chunks_.begin(); it != cur_it; ++it) {
@@ -386,36 +418,40 @@ CharChunk *Composition::MaybeSplitChunkAt(const size_t pos,
     return chunk;
   }
 
+  InvalidateLocalCache(*it - chunks_.begin());
   CharChunk *left_chunk = NULL;
   chunk->SplitChunk(Transliterators::LOCAL, inner_position, &left_chunk);
-  chunks_.insert(*it, left_chunk);
+  *it = chunks_.insert(*it, left_chunk) + 1;
   return left_chunk;
 }
 
 void Composition::CombinePendingChunks(
-    CharChunkList::iterator it, const CompositionInput &input) {
-  // Combine |**it| and |**(--it)| into |**it| as long as possible.
+    CharChunkList::iterator *it, const CompositionInput &input) {
+  // Combine |***it| and |**(*it - 1)| into |***it| as long as possible.
   const string &next_input =
     input.has_conversion() ? input.conversion() : input.raw();
 
-  while (it != chunks_.begin()) {
-    CharChunkList::iterator left_it = it;
-    --left_it;
+  while (*it != chunks_.begin()) {
+    CharChunkList::iterator left_it = *it - 1;
     if (!(*left_it)->IsConvertible(
-            input_t12r_, table_, (*it)->pending() + next_input)) {
+            input_t12r_, table_, (**it)->pending() + next_input)) {
       return;
     }
 
-    (*it)->Combine(**left_it);
+    InvalidateLocalCache(left_it - chunks_.begin());
+    (**it)->Combine(**left_it);
     delete *left_it;
-    chunks_.erase(left_it);
+    *it = chunks_.erase(left_it);
   }
 }
 
 // Insert a chunk to the prev of it.
 CharChunkList::iterator Composition::InsertChunk(CharChunkList::iterator *it) {
+  InvalidateLocalCache(*it - chunks_.begin());
   CharChunk *new_chunk = new CharChunk(input_t12r_, table_);
-  return chunks_.insert(*it, new_chunk);
+  const CharChunkList::iterator new_it = chunks_.insert(*it, new_chunk);
+  *it = new_it + 1;
+  return new_it;
 }
 
 const CharChunkList &Composition::GetCharChunkList() const {
@@ -445,10 +481,12 @@ Composition *Composition::CloneImpl() const {
   object->input_t12r_ = input_t12r_;
   object->table_ = table_;
 
+  object->chunks_.reserve(chunks_.size());
   for (CharChunkList::const_iterator it = chunks_.begin();
        it != chunks_.end(); ++it) {
     object->chunks_.push_back((*it)->Clone());
   }
+  object->UpdateLocalCache();
 
   return object;
 }
@@ -476,5 +514,41 @@ void Composition::SetTable(const Table *table) {
   table_ = table;
 }
 
+size_t Composition::GetLocalLengthBefore(size_t index) const {
+  const size_t num_cached = min(index, local_lengths_.size());
+  size_t length = num_cached == 0 ? 0 : local_lengths_[num_cached - 1];
+  for (size_t i = num_cached; i < index; ++i) {
+    length += chunks_[i]->GetLength(Transliterators::LOCAL);
+  }
+  return length;
+}
+
+void Composition::AppendLocalStringBefore(size_t index, string *output) const {
+  const size_t num_cached = min(index, local_string_ends_.size());
+  output->append(local_string_, 0,
+                 num_cached == 0 ? 0 : local_string_ends_[num_cached - 1]);
+  for (size_t i = num_cached; i < index; ++i) {
+    chunks_[i]->AppendResult(Transliterators::LOCAL, output);
+  }
+}
+
+void Composition::UpdateLocalCache() {
+  for (size_t i = local_lengths_.size(); i < chunks_.size(); ++i) {
+    const size_t length = chunks_[i]->GetLength(Transliterators::LOCAL);
+    local_lengths_.push_back(i == 0 ? length : local_lengths_[i - 1] + length);
+    chunks_[i]->AppendResult(Transliterators::LOCAL, &local_string_);
+    local_string_ends_.push_back(local_string_.size());
+  }
+}
+
+void Composition::InvalidateLocalCache(size_t index) {
+  if (index >= local_lengths_.size()) {
+    return;
+  }
+  local_lengths_.resize(index);
+  local_string_ends_.resize(index);
+  local_string_.resize(index == 0 ? 0 : local_string_ends_[index - 1]);
+}
+
 }  // namespace composer
 }  // namespace mozc
@@ -32,9 +32,9 @@
 
 #include "composer/composition_interface.h"
 
-#include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/port.h"
 
@@ -42,7 +42,10 @@ namespace mozc {
 namespace composer {
 
 class CharChunk;
-typedef list<CharChunk*> CharChunkList;
+// Chunks are kept in a contiguous array.  Inserting or erasing a chunk
+// invalidates the iterators after it; the methods below taking an iterator
+// pointer update it accordingly.
+typedef vector<CharChunk*> CharChunkList;
 
 class CompositionInput;
 class Table;
@@ -110,6 +113,9 @@ class Composition : public CompositionInterface {
   virtual void SetTable(const Table *table);
 
   // Following methods are declared as public for unit test.
+  // The lengths and the string of the chunks are cached.  These methods drop
+  // the cache from the chunk they touch but don't rebuild it, so chunks
+  // returned by them may be modified before the composition is queried.
   void GetChunkAt(size_t position,
                   Transliterators::Transliterator transliterator,
                   CharChunkList::iterator *chunk_it,
@@ -118,6 +124,8 @@ class Composition : public CompositionInterface {
                      const CharChunkList::const_iterator &it) const;
 
   CharChunkList::iterator GetInsertionChunk(CharChunkList::iterator *it);
+  // Insert a new chunk before |*left_it| and return it.  |*left_it| is
+  // updated to point the same chunk as before.
   CharChunkList::iterator InsertChunk(CharChunkList::iterator *left_it);
 
   CharChunk *MaybeSplitChunkAt(size_t position, CharChunkList::iterator *it);
@@ -128,7 +136,8 @@ class Composition : public CompositionInterface {
   //      into [pending='q']+[pending='ky'] because [pending='ky']+[input='o']
   //      can turn to be a fixed chunk.
   // e.g. [pending='k']+[pending='y']+[input='q'] are not combined.
-  void CombinePendingChunks(CharChunkList::iterator it,
+  // |*it| is updated to point the combined chunk.
+  void CombinePendingChunks(CharChunkList::iterator *it,
                             const CompositionInput &input);
   const CharChunkList &GetCharChunkList() const;
   const Table *table() const {
@@ -146,10 +155,34 @@ class Composition : public CompositionInterface {
                           TrimMode trim_mode,
                           string *output) const;
 
+  // Returns the total length of the chunks before |index| with
+  // Transliterators::LOCAL.
+  size_t GetLocalLengthBefore(size_t index) const;
+  // Appends the string of the chunks before |index| with
+  // Transliterators::LOCAL to |output|.
+  void AppendLocalStringBefore(size_t index, string *output) const;
+  // Extends the LOCAL cache below to cover all the chunks.  Called at the end
+  // of each public mutator, so that the const methods only read the cache and
+  // can be called from several threads.
+  void UpdateLocalCache();
+  // Drops the LOCAL cache of the chunk at |index| and the following ones.
+  // Must be called before a chunk is modified, inserted or erased.
+  void InvalidateLocalCache(size_t index);
+
   const Table *table_;
   CharChunkList chunks_;
   Transliterators::Transliterator input_t12r_;
 
+  // Cache of the leading chunks transliterated with Transliterators::LOCAL,
+  // so that a key stroke does not walk the whole composition.  It covers all
+  // the chunks between mutations, and only a prefix of them in the middle of
+  // one.  local_lengths_[i] is the total length of chunks_[0..i] in
+  // characters and local_string_ends_[i] is the end of chunks_[i] in
+  // local_string_.
+  vector<size_t> local_lengths_;
+  vector<size_t> local_string_ends_;
+  string local_string_;
+
   DISALLOW_COPY_AND_ASSIGN(Composition);
 };
 
@@ -27,23 +27,82 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+// Interactive driver of Composition.  Each input line is a key to insert,
+// a relative cursor move (e.g. "-1") or "!" to delete.
+//
+// With --benchmark, measures the cost of a key stroke instead: for each
+// preedit length in --benchmark_lengths, a preedit of that length is typed
+// and then a key is repeatedly inserted at the end, rendered with GetString
+// and deleted again.
+//
+// Usage:
+//   composition_main --benchmark --benchmark_lengths=10,100,1000
+
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
+
 #include "base/base.h"
+#include "base/number_util.h"
+#include "base/stopwatch.h"
+#include "base/util.h"
 #include "composer/internal/composition.h"
 #include "composer/table.h"
 
 DEFINE_string(table, "system://romanji-hiragana.tsv",
               "preedit conversion table file.");
+DEFINE_bool(benchmark, false, "measure the key stroke throughput");
+DEFINE_string(benchmark_lengths, "10,100,1000",
+              "comma separated preedit lengths for --benchmark");
+DEFINE_int32(benchmark_keys, 10000,
+             "number of key strokes measured for each preedit length");
 
+namespace mozc {
+namespace composer {
+namespace {
 
-int main(int argc, char **argv) {
-  InitGoogle(argv[0], &argc, &argv, false);
+const char kRomanji[] = "watashinonamaehanakanodesu";
 
-  mozc::composer::Table table;
-  table.LoadFromFile(FLAGS_table.c_str());
+// Types romaji keys until the preedit reaches |length| characters and
+// returns the cursor position.
+size_t FillComposition(size_t length, Composition *composition) {
+  size_t pos = 0;
+  for (size_t i = 0; composition->GetLength() < length; ++i) {
+    const string key(1, kRomanji[i % (arraysize(kRomanji) - 1)]);
+    pos = composition->InsertAt(pos, key);
+  }
+  return pos;
+}
 
-  mozc::composer::Composition composition(&table);
+// Returns the elapsed time of a key stroke in nanoseconds.
+double MeasureKeyStroke(const Table &table, size_t length) {
+  Composition composition(&table);
+  size_t pos = FillComposition(length, &composition);
+  string preedit;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < FLAGS_benchmark_keys; ++i) {
+    pos = composition.InsertAt(pos, "a");
+    composition.GetString(&preedit);
+    pos = composition.DeleteAt(pos - 1);
+  }
+  stopwatch.Stop();
+  return stopwatch.GetElapsedMicroseconds() * 1000.0 / FLAGS_benchmark_keys;
+}
+
+void RunBenchmark(const Table &table) {
+  vector<string> lengths;
+  Util::SplitStringUsing(FLAGS_benchmark_lengths, ",", &lengths);
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    const size_t length = NumberUtil::SimpleAtoi(lengths[i]);
+    const double nsec = MeasureKeyStroke(table, length);
+    cout << "length " << length << ": " << nsec << " ns/key, "
+         << 1.0e9 / nsec << " keys/sec" << endl;
+  }
+}
+
+void RunInteractive(const Table &table) {
+  Composition composition(&table);
 
   string command;
   string result;
@@ -66,3 +125,21 @@ int main(int argc, char **argv) {
     cout << result << " : " << pos << endl;
   }
 }
+
+}  // namespace
+}  // namespace composer
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  mozc::composer::Table table;
+  table.LoadFromFile(FLAGS_table.c_str());
+
+  if (FLAGS_benchmark) {
+    mozc::composer::RunBenchmark(table);
+  } else {
+    mozc::composer::RunInteractive(table);
+  }
+  return 0;
+}
@@ -1492,7 +1492,7 @@ TEST_F(CompositionTest, CombinePendingChunks) {
 
     CompositionInput input;
     SetInput("n", "", false, &input);
-    comp.CombinePendingChunks(chunk_it, input);
+    comp.CombinePendingChunks(&chunk_it, input);
     EXPECT_EQ("", (*chunk_it)->pending());
     EXPECT_EQ("", (*chunk_it)->conversion());
     EXPECT_EQ("", (*chunk_it)->raw());
@@ -1513,7 +1513,7 @@ TEST_F(CompositionTest, CombinePendingChunks) {
     CompositionInput input;
     SetInput("n", "", false, &input);
 
-    comp.CombinePendingChunks(chunk_it, input);
+    comp.CombinePendingChunks(&chunk_it, input);
     EXPECT_EQ("", (*chunk_it)->pending());
     EXPECT_EQ("", (*chunk_it)->conversion());
     EXPECT_EQ("", (*chunk_it)->raw());
@@ -1535,7 +1535,7 @@ TEST_F(CompositionTest, CombinePendingChunks) {
     CompositionInput input;
     SetInput("a", "", false, &input);
 
-    comp.CombinePendingChunks(chunk_it, input);
+    comp.CombinePendingChunks(&chunk_it, input);
     EXPECT_EQ("ny", (*chunk_it)->pending());
     EXPECT_EQ("", (*chunk_it)->conversion());
     EXPECT_EQ("ny", (*chunk_it)->raw());
@@ -1560,7 +1560,7 @@ TEST_F(CompositionTest, CombinePendingChunks) {
     CompositionInput input;
     SetInput("a", "", false, &input);
 
-    comp.CombinePendingChunks(chunk_it, input);
+    comp.CombinePendingChunks(&chunk_it, input);
     EXPECT_EQ("ny", (*chunk_it)->pending());
     EXPECT_EQ("", (*chunk_it)->conversion());
     EXPECT_EQ("ny", (*chunk_it)->raw());
@@ -1586,7 +1586,7 @@ TEST_F(CompositionTest, CombinePendingChunks) {
     CompositionInput input;
     SetInput("x", "a", false, &input);
 
-    comp.CombinePendingChunks(chunk_it, input);
+    comp.CombinePendingChunks(&chunk_it, input);
     EXPECT_EQ("ny", (*chunk_it)->pending());
     EXPECT_EQ("", (*chunk_it)->conversion());
     EXPECT_EQ("ny", (*chunk_it)->raw());
@@ -2049,5 +2049,73 @@ TEST_F(CompositionTest, Clone) {
   }
 }
 
+TEST_F(CompositionTest, CachedLengthAndStringFollowEdits) {
+  // "か", "き", "っ"
+  table_->AddRule("ka", "\xe3\x81\x8b", "");
+  table_->AddRule("ki", "\xe3\x81\x8d", "");
+  table_->AddRule("tt", "\xe3\x81\xa3", "t");
+  composition_->SetInputMode(Transliterators::HIRAGANA);
+
+  // The expected values are computed from the chunks directly.
+  size_t pos = InsertCharacters("kakittaki", 0, composition_.get());
+  pos = InsertCharacters("ka", 2, composition_.get());
+  for (int i = 0; i < 6; ++i) {
+    const CharChunkList &chunks = composition_->chunks();
+    string expected;
+    size_t expected_length = 0;
+    size_t expected_raw_position = 0;
+    size_t rest = pos;
+    for (size_t j = 0; j < chunks.size(); ++j) {
+      chunks[j]->AppendResult(Transliterators::LOCAL, &expected);
+      const size_t length = chunks[j]->GetLength(Transliterators::LOCAL);
+      expected_length += length;
+      if (rest >= length) {
+        rest -= length;
+        expected_raw_position +=
+            chunks[j]->GetLength(Transliterators::RAW_STRING);
+      }
+    }
+    string cached;
+    composition_->GetString(&cached);
+    EXPECT_EQ(expected, cached);
+    EXPECT_EQ(expected_length, composition_->GetLength());
+    if (rest == 0) {
+      // |pos| is at a chunk boundary.
+      EXPECT_EQ(expected_raw_position,
+                composition_->ConvertPosition(pos, Transliterators::LOCAL,
+                                              Transliterators::RAW_STRING));
+    }
+
+    // A clone gives the same results.
+    scoped_ptr<Composition> clone(composition_->CloneImpl());
+    string cloned;
+    clone->GetString(&cloned);
+    EXPECT_EQ(expected, cloned);
+    composition_->GetStringWithTrimMode(FIX, &cached);
+    clone->GetStringWithTrimMode(FIX, &cloned);
+    EXPECT_EQ(cloned, cached);
+
+    switch (i) {
+      case 0:
+        pos = composition_->DeleteAt(1);
+        break;
+      case 1:
+        composition_->SetTransliterator(0, 2, Transliterators::HALF_ASCII);
+        break;
+      case 2:
+        pos = InsertCharacters("t", composition_->GetLength(),
+                               composition_.get());
+        break;
+      case 3:
+        pos = composition_->InsertAt(0, "k");
+        break;
+      case 4:
+        composition_->Erase();
+        pos = 0;
+        break;
+    }
+  }
+}
+
 }  // namespace composer
 }  // namespace mozc
@@ -34,6 +34,7 @@
 #include <cstring>
 #include <string>
 #include <vector>
+#include "base/logging.h"
 #include "base/port.h"
 #include "base/string_piece.h"
 #include "composer/internal/composition.h"
@@ -53,24 +54,20 @@ namespace composer {
 
 namespace {
 
-// Looks up model cost for current key given previous keys.
-int LookupModelCost(const string &prev, const string &current,
+// Looks up model cost for current key given the last two previous keys.
+int LookupModelCost(const char (&tail)[2], char current,
                     const TypingModel &typing_model) {
-  if (current.size() != 1) {
-    return TypingModel::kInfinity;
-  }
-  char trigram[4] = { '^', '^', current[0], '\0' };
-  if (prev.size() == 1) {
-    trigram[1] = prev[0];
-  } else if (prev.size() >= 2) {
-    trigram[0] = prev[prev.size() - 2];
-    trigram[1] = prev[prev.size() - 1];
-  }
-
-  const int cost = typing_model.GetCost(trigram);
+  const char trigram[3] = { tail[0], tail[1], current };
+  const int cost = typing_model.GetCost(StringPiece(trigram, 3));
   return cost == TypingModel::kNoData ? TypingModel::kInfinity : cost;
 }
 
+// Once the node tree has grown this many times since the last compaction,
+// the unreachable nodes are dropped.  This keeps the amortized cost of a key
+// proportional to the number of corrections.
+const size_t kCompactionRatio = 2;
+const size_t kMinCompactedNodesSize = 64;
+
 inline int Cost(double prob) {
   return static_cast<int>(-500.0 * log(prob));
 }
@@ -79,7 +76,8 @@ inline int Cost(double prob) {
 
 
 struct TypingCorrector::KeyAndPenaltyLess {
-  bool operator()(const KeyAndPenalty &l, const KeyAndPenalty &r) const {
+  template <typename T>
+  bool operator()(const pair<T, int> &l, const pair<T, int> &r) const {
     return l.second < r.second;
   }
 };
@@ -89,7 +87,8 @@ TypingCorrector::TypingCorrector(const Table *table,
                                  size_t max_correction_query_results)
     : table_(table),
       max_correction_query_candidates_(max_correction_query_candidates),
-      max_correction_query_results_(max_correction_query_results) {
+      max_correction_query_results_(max_correction_query_results),
+      compacted_nodes_size_(kMinCompactedNodesSize) {
   Reset();
 }
 
@@ -102,40 +101,131 @@ void TypingCorrector::InsertCharacter(
   if (!IsAvailable() || probable_key_events.size() == 0) {
     // If this corrector is not available or no ProbableKeyEvent is available,
     // just append |key| to each corrections.
-    for (size_t i = 0; i < top_n_.size(); ++i) {
-      key.AppendToString(&top_n_[i].first);
+    if (!key.empty()) {
+      const size_t offset = keys_.size();
+      key.AppendToString(&keys_);
+      for (size_t i = 0; i < top_n_.size(); ++i) {
+        top_n_[i].first = AddNode(top_n_[i].first, offset, key.size());
+      }
     }
+    CompactNodes();
     return;
   }
 
   // Approximation of dynamic programming to find N least cost key sequences.
   // At each insertion, generate all the possible paths from previous N least
   // key sequences, and keep only new N least key sequences.
-  vector<KeyAndPenalty> tmp;
-  tmp.reserve(top_n_.size() * probable_key_events.size());
+  // The candidates are (previous correction, event) pairs; only the
+  // survivors get a node.
+  const size_t offset = keys_.size();
+  const size_t num_events = probable_key_events.size();
+  vector<int> event_costs(num_events);
+  for (size_t j = 0; j < num_events; ++j) {
+    const ProbableKeyEvent& event = probable_key_events.Get(j);
+    keys_.push_back(static_cast<char>(event.key_code()));
+    event_costs[j] = Cost(event.probability());
+  }
+  vector<pair<size_t, int> > tmp;
+  tmp.reserve(top_n_.size() * num_events);
   for (size_t i = 0; i < top_n_.size(); ++i) {
-    for (size_t j = 0; j < probable_key_events.size(); ++j) {
-      const ProbableKeyEvent& event = probable_key_events.Get(j);
-      const string key_as_string(1, event.key_code());
-      const int new_cost = top_n_[i].second + Cost(event.probability())
-          + LookupModelCost(top_n_[i].first, key_as_string,
+    const KeyNode &node = nodes_[top_n_[i].first];
+    for (size_t j = 0; j < num_events; ++j) {
+      const int new_cost = top_n_[i].second + event_costs[j]
+          + LookupModelCost(node.tail, keys_[offset + j],
                             *table_->typing_model());
       if (new_cost < TypingModel::kInfinity) {
-        tmp.push_back(make_pair(top_n_[i].first + key_as_string, new_cost));
+        tmp.push_back(make_pair(i * num_events + j, new_cost));
       }
     }
   }
   const size_t cutoff_size = min(max_correction_query_candidates_, tmp.size());
   partial_sort(tmp.begin(), tmp.begin() + cutoff_size, tmp.end(),
                KeyAndPenaltyLess());
-  tmp.resize(cutoff_size);
-  top_n_.swap(tmp);
+  vector<KeyAndPenalty> next(cutoff_size);
+  for (size_t k = 0; k < cutoff_size; ++k) {
+    const size_t i = tmp[k].first / num_events;
+    const size_t j = tmp[k].first % num_events;
+    next[k] = make_pair(AddNode(top_n_[i].first, offset + j, 1),
+                        tmp[k].second);
+  }
+  top_n_.swap(next);
+  CompactNodes();
+}
+
+uint32 TypingCorrector::AddNode(uint32 parent, size_t offset, size_t size) {
+  DCHECK_GT(size, 0);
+  KeyNode node;
+  node.parent = parent;
+  node.key_offset = static_cast<uint32>(offset);
+  node.key_size = static_cast<uint16>(size);
+  if (size == 1) {
+    node.tail[0] = nodes_[parent].tail[1];
+  } else {
+    node.tail[0] = keys_[offset + size - 2];
+  }
+  node.tail[1] = keys_[offset + size - 1];
+  nodes_.push_back(node);
+  return static_cast<uint32>(nodes_.size() - 1);
+}
+
+void TypingCorrector::GetKeys(uint32 node, string *keys) const {
+  keys->clear();
+  size_t length = 0;
+  for (uint32 n = node; n != 0; n = nodes_[n].parent) {
+    length += nodes_[n].key_size;
+  }
+  keys->resize(length);
+  for (uint32 n = node; n != 0; n = nodes_[n].parent) {
+    length -= nodes_[n].key_size;
+    keys->replace(length, nodes_[n].key_size,
+                  keys_, nodes_[n].key_offset, nodes_[n].key_size);
+  }
+}
+
+void TypingCorrector::CompactNodes() {
+  if (nodes_.size() < kCompactionRatio * compacted_nodes_size_) {
+    return;
+  }
+  // A parent always precedes its children, so the surviving nodes can be
+  // renumbered in a single forward pass.
+  const uint32 kUnreachable = static_cast<uint32>(-1);
+  vector<uint32> new_index(nodes_.size(), kUnreachable);
+  new_index[0] = 0;
+  for (size_t i = 0; i < top_n_.size(); ++i) {
+    for (uint32 n = top_n_[i].first; new_index[n] == kUnreachable;
+         n = nodes_[n].parent) {
+      new_index[n] = 0;
+    }
+  }
+  size_t size = 1;
+  for (size_t n = 1; n < nodes_.size(); ++n) {
+    if (new_index[n] == kUnreachable) {
+      continue;
+    }
+    new_index[n] = static_cast<uint32>(size);
+    nodes_[size] = nodes_[n];
+    nodes_[size].parent = new_index[nodes_[n].parent];
+    ++size;
+  }
+  nodes_.resize(size);
+  for (size_t i = 0; i < top_n_.size(); ++i) {
+    top_n_[i].first = new_index[top_n_[i].first];
+  }
+  compacted_nodes_size_ = max(size, kMinCompactedNodesSize);
 }
 
 void TypingCorrector::Reset() {
   raw_key_.clear();
+  keys_.clear();
+  nodes_.resize(1);
+  nodes_[0].parent = 0;
+  nodes_[0].key_offset = 0;
+  nodes_[0].key_size = 0;
+  nodes_[0].tail[0] = '^';
+  nodes_[0].tail[1] = '^';
+  compacted_nodes_size_ = kMinCompactedNodesSize;
   top_n_.clear();
-  top_n_.push_back(KeyAndPenalty("", 0));
+  top_n_.push_back(KeyAndPenalty(0, 0));
   available_ = true;
 }
 
@@ -154,6 +244,9 @@ void TypingCorrector::CopyFrom(const TypingCorrector &src) {
   table_ = src.table_;
   max_correction_query_candidates_ = src.max_correction_query_candidates_;
   max_correction_query_results_ = src.max_correction_query_results_;
+  keys_ = src.keys_;
+  nodes_ = src.nodes_;
+  compacted_nodes_size_ = src.compacted_nodes_size_;
   top_n_ = src.top_n_;
 }
 
@@ -223,11 +316,13 @@ void TypingCorrector::GetQueriesForPrediction(
   // So here we pregenerate top_n_.size() of initialized instances.
   queries->resize(top_n_.size());
   size_t result_count = 0;
+  string keys;
   for (size_t i = 0;
        i < top_n_.size() && result_count < max_correction_query_results_;
        ++i) {
     const KeyAndPenalty &correction = top_n_[i];
-    if (correction.first == raw_key_) {
+    GetKeys(correction.first, &keys);
+    if (keys == raw_key_) {
       // If typing correction input is identical to raw input,
       // filter it because its queries are surely identical to
       // raw queries.
@@ -237,7 +332,7 @@ void TypingCorrector::GetQueriesForPrediction(
     // Fill TypeCorrectedQuery's base and expanded field
     // by using cached objects.
     input.Clear();
-    input.set_raw(correction.first);
+    input.set_raw(keys);
     input.set_is_new_input(true);
     c.Erase();
     c.InsertInput(0, input);
@@ -92,18 +92,44 @@ class TypingCorrector {
  private:
   friend class TypingCorrectorTest;
 
-  // Represents one type-correction: key sequence and its penalty (cost).
-  typedef pair<string, int> KeyAndPenalty;
+  // A node of the tree of corrected key sequences.  Corrections sharing a
+  // prefix share its nodes, so extending a correction by one key is O(1)
+  // regardless of its length.  The key sequence of a node is spelled by
+  // following |parent| up to the root, nodes_[0].
+  struct KeyNode {
+    uint32 parent;
+    // The key of this node is keys_.substr(key_offset, key_size).
+    uint32 key_offset;
+    uint16 key_size;
+    // The last two bytes of the key sequence, padded with '^', as used by
+    // the trigram typing model.
+    char tail[2];
+  };
+
+  // One type-correction: the last node of its key sequence and its penalty
+  // (cost).
+  typedef pair<uint32, int> KeyAndPenalty;
 
   // Less-than comparator for KeyAndPenalty. Since this functor accesses
   // KeyAndPenalty, we need to define it in private member.
   struct KeyAndPenaltyLess;
 
+  // Appends a child of |parent| holding keys_.substr(offset, size).
+  uint32 AddNode(uint32 parent, size_t offset, size_t size);
+  // Returns the key sequence ending at |node|.
+  void GetKeys(uint32 node, string *keys) const;
+  // Drops the nodes no longer reachable from |top_n_|.
+  void CompactNodes();
+
   bool available_;
   const Table *table_;
   size_t max_correction_query_candidates_;
   size_t max_correction_query_results_;
   string raw_key_;
+  string keys_;
+  vector<KeyNode> nodes_;
+  // Size of |nodes_| after the last compaction.
+  size_t compacted_nodes_size_;
   vector<KeyAndPenalty> top_n_;
 
   DISALLOW_COPY_AND_ASSIGN(TypingCorrector);
@@ -351,6 +351,18 @@ class TypingCorrectorTest : public ::testing::Test {
     }
   }
 
+  void GetCorrections(const TypingCorrector &corrector,
+                      vector<string> *corrections) {
+    corrections->resize(corrector.top_n_.size());
+    for (size_t i = 0; i < corrector.top_n_.size(); ++i) {
+      corrector.GetKeys(corrector.top_n_[i].first, &(*corrections)[i]);
+    }
+  }
+
+  size_t GetNodesSize(const TypingCorrector &corrector) {
+    return corrector.nodes_.size();
+  }
+
   Config config_backup_;
   Table qwerty_table_;
   TypingModel qwerty_typing_model_;
@@ -483,5 +495,32 @@ TEST_F(TypingCorrectorTest, CopyFrom) {
   ExpectTypingCorrectorEqual(corrector, corrector2);
 }
 
+TEST_F(TypingCorrectorTest, LongInputSharesPrefixes) {
+  const size_t kCorrectedQueryCandidates = 30;
+  TypingCorrector corrector(&qwerty_table_, kCorrectedQueryCandidates, 8);
+  string keys;
+  for (int i = 0; i < 30; ++i) {
+    keys.append("ohayou");
+  }
+  InsertOneByOne(keys.c_str(), &corrector);
+
+  vector<string> corrections;
+  GetCorrections(corrector, &corrections);
+  ASSERT_FALSE(corrections.empty());
+  EXPECT_GE(kCorrectedQueryCandidates, corrections.size());
+  for (size_t i = 0; i < corrections.size(); ++i) {
+    EXPECT_EQ(keys.size(), corrections[i].size());
+  }
+  // The corrections share their prefixes and unreachable nodes are dropped,
+  // so the tree is smaller than the corrections spelled out.
+  EXPECT_GT(corrections.size() * keys.size(), GetNodesSize(corrector));
+
+  TypingCorrector copied(NULL, 1000, 1000);
+  copied.CopyFrom(corrector);
+  vector<string> copied_corrections;
+  GetCorrections(copied, &copied_corrections);
+  EXPECT_EQ(corrections, copied_corrections);
+}
+
 }  // namespace composer
 }  // namespace mozc
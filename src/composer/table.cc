@@ -40,6 +40,7 @@
 #include "base/logging.h"
 #include "base/trie.h"
 #include "base/util.h"
+#include "composer/internal/compiled_table.h"
 #include "composer/internal/typing_model.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
@@ -345,6 +346,7 @@ const Entry *Table::AddRuleWithAttributes(const string &escaped_input,
   if (entries_->LookUp(input, &old_entry)) {
     DeleteEntry(old_entry);
   }
+  compiled_table_.reset();
 
   Entry *entry = new Entry(input, output, pending, attributes);
   entries_->AddEntry(input, entry);
@@ -379,6 +381,7 @@ void Table::DeleteRule(const string &input) {
     DeleteEntry(old_entry);
   }
   entries_->DeleteEntry(input);
+  compiled_table_.reset();
 }
 
 bool Table::LoadFromString(const string &str) {
@@ -454,6 +457,9 @@ bool Table::LoadFromStream(istream *is) {
 }
 
 const Entry *Table::LookUp(const string &input) const {
+  if (compiled_table_.get() != NULL) {
+    return compiled_table_->LookUp(input);
+  }
   const Entry *entry = NULL;
   if (case_sensitive_) {
     entries_->LookUp(input, &entry);
@@ -468,6 +474,9 @@ const Entry *Table::LookUp(const string &input) const {
 const Entry *Table::LookUpPrefix(const string &input,
                                  size_t *key_length,
                                  bool *fixed) const {
+  if (compiled_table_.get() != NULL) {
+    return compiled_table_->LookUpPrefix(input, key_length, fixed);
+  }
   const Entry *entry = NULL;
   if (case_sensitive_) {
     entries_->LookUpPrefix(input, &entry, key_length, fixed);
@@ -481,6 +490,10 @@ const Entry *Table::LookUpPrefix(const string &input,
 
 void Table::LookUpPredictiveAll(const string &input,
                                 vector<const Entry *> *results) const {
+  if (compiled_table_.get() != NULL) {
+    compiled_table_->LookUpPredictiveAll(input, results);
+    return;
+  }
   if (case_sensitive_) {
     entries_->LookUpPredictiveAll(input, results);
   } else {
@@ -507,6 +520,9 @@ bool Table::HasNewChunkEntry(const string &input) const {
 }
 
 bool Table::HasSubRules(const string &input) const {
+  if (compiled_table_.get() != NULL) {
+    return compiled_table_->HasSubRules(input);
+  }
   if (case_sensitive_) {
     return entries_->HasSubTrie(input);
   } else {
@@ -535,6 +551,16 @@ bool Table::case_sensitive() const {
 
 void Table::set_case_sensitive(const bool case_sensitive) {
   case_sensitive_ = case_sensitive;
+  compiled_table_.reset();
+}
+
+void Table::Compile() {
+  const vector<const Entry *> entries(entry_set_.begin(), entry_set_.end());
+  compiled_table_.reset(new CompiledTable(entries, case_sensitive_));
+}
+
+bool Table::is_compiled() const {
+  return compiled_table_.get() != NULL;
 }
 
 namespace {
@@ -661,6 +687,8 @@ const Table *TableManager::GetTable(const mozc::commands::Request &request,
   if (!table->InitializeWithRequestAndConfig(request, config)) {
     return NULL;
   }
+  // The cached table is never modified, so it can be compiled once here.
+  table->Compile();
 
   Table* table_to_cache = table.release();
   table_map_[hash] = table_to_cache;
@@ -54,6 +54,7 @@ class Config;
 }  // namespace config
 namespace composer {
 
+class CompiledTable;
 class TypingModel;
 
 // This is a bitmap representing Entry's additional attributes.
@@ -133,6 +134,13 @@ class Table {
   bool case_sensitive() const;
   void set_case_sensitive(bool case_sensitive);
 
+  // Builds the compiled, immutable representation of the current rules,
+  // which is used by the lookup methods above instead of the trie.
+  // Modifying the rules discards it, so this should be called once all the
+  // rules are loaded.
+  void Compile();
+  bool is_compiled() const;
+
   const TypingModel* typing_model() const;
 
   // Parse special key strings escaped with the pair of "{" and "}"
@@ -156,6 +164,7 @@ class Table {
   scoped_ptr<EntryTrie> entries_;
   typedef set<const Entry*> EntrySet;
   EntrySet entry_set_;
+  scoped_ptr<CompiledTable> compiled_table_;
 
   // If false, input alphabet characters are normalized to lower
   // characters.  The default value is false.
@@ -173,6 +182,8 @@ class TableManager {
   ~TableManager();
   // Return Table for the request and the config
   // TableManager has ownership of the return value;
+  // The returned table is compiled (see Table::Compile) and shared by all
+  // the composers using the same request and config.
   const Table *GetTable(const commands::Request &request,
                         const config::Config &config);
 
@@ -1089,6 +1089,7 @@ TEST_F(TableTest, TableManager) {
           config.set_symbol_method(symbol_method[symbol]);
           const Table *table = table_manager.GetTable(request, config);
           EXPECT_TRUE(table != NULL);
+          EXPECT_TRUE(table->is_compiled());
           EXPECT_TRUE(table_manager.GetTable(request, config) == table);
           EXPECT_TRUE(table_set.find(table) == table_set.end());
           table_set.insert(table);
@@ -39,6 +39,7 @@
 #include "base/port.h"
 #include "base/scoped_ptr.h"
 #include "base/singleton.h"
+#include "base/startup_trace.h"
 #include "base/system_util.h"
 #include "base/util.h"
 #include "base/version.h"
@@ -214,6 +215,7 @@ void ConfigHandlerImpl::SetImposedConfig(const Config &config) {
 
 // Reload from file
 bool ConfigHandlerImpl::Reload() {
+  ScopedStartupTrace trace("ConfigHandler::Reload");
   VLOG(1) << "Reloading config file: " << filename_;
   scoped_ptr<istream> is(ConfigFileStream::OpenReadBinary(filename_));
   Config input_proto;
@@ -35,7 +35,6 @@
 #include <algorithm>
 #include <climits>
 #include <map>
-#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -81,8 +80,84 @@ const int   kStructureCostOffset     = 3453;
 const int   kMinStructureCostOffset  = 1151;
 const int32 kStopEnmerationCacheSize = 15;
 
+// The initial number of the slots of the seen set. Twice or more as large
+// as kMaxCandidatesSize so that the load factor stays below 1/2 in the
+// forward conversion. The set grows only in the reverse conversion, which
+// has no upper bound.
+const size_t kInitialSeenSetSize = 512;
+
+uint64 GetFingerprint(const string &value) {
+  const uint64 fp = Util::Fingerprint(value.data(), value.size());
+  // 0 is reserved for empty slots.
+  return (fp == 0) ? 1 : fp;
+}
+
 }  // anonymous namespace
 
+// The candidate values are identified by their 64-bit fingerprints instead
+// of the strings themselves, which avoids allocating a tree node and copying
+// the value for every candidate.
+class CandidateFilter::FingerprintSet {
+ public:
+  FingerprintSet() : slots_(kInitialSeenSetSize, 0), size_(0) {}
+
+  size_t size() const { return size_; }
+
+  void Clear() {
+    if (slots_.size() != kInitialSeenSetSize) {
+      vector<uint64>(kInitialSeenSetSize, 0).swap(slots_);
+    } else {
+      fill(slots_.begin(), slots_.end(), 0);
+    }
+    size_ = 0;
+  }
+
+  bool Contains(uint64 fp) const {
+    return slots_[FindSlot(slots_, fp)] == fp;
+  }
+
+  // Returns false if |fp| is already in the set.
+  bool Insert(uint64 fp) {
+    const size_t slot = FindSlot(slots_, fp);
+    if (slots_[slot] == fp) {
+      return false;
+    }
+    slots_[slot] = fp;
+    ++size_;
+    if (size_ * 2 > slots_.size()) {
+      Grow();
+    }
+    return true;
+  }
+
+ private:
+  // Returns the slot holding |fp|, or the empty slot where |fp| should go.
+  // The size of |slots| is a power of 2.
+  static size_t FindSlot(const vector<uint64> &slots, uint64 fp) {
+    const size_t mask = slots.size() - 1;
+    size_t slot = static_cast<size_t>(fp) & mask;
+    while (slots[slot] != 0 && slots[slot] != fp) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void Grow() {
+    vector<uint64> new_slots(slots_.size() * 2, 0);
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      if (slots_[i] != 0) {
+        new_slots[FindSlot(new_slots, slots_[i])] = slots_[i];
+      }
+    }
+    slots_.swap(new_slots);
+  }
+
+  vector<uint64> slots_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FingerprintSet);
+};
+
 CandidateFilter::CandidateFilter(
     const SuppressionDictionary *suppression_dictionary,
     const POSMatcher *pos_matcher,
@@ -90,6 +165,7 @@ CandidateFilter::CandidateFilter(
     : suppression_dictionary_(suppression_dictionary),
       pos_matcher_(pos_matcher),
       suggestion_filter_(suggestion_filter),
+      seen_(new FingerprintSet),
       top_candidate_(NULL) {
   CHECK(suppression_dictionary_);
   CHECK(pos_matcher_);
@@ -99,13 +175,14 @@ CandidateFilter::CandidateFilter(
 CandidateFilter::~CandidateFilter() {}
 
 void CandidateFilter::Reset() {
-  seen_.clear();
+  seen_->Clear();
   top_candidate_ = NULL;
 }
 
 CandidateFilter::ResultType CandidateFilter::FilterCandidateInternal(
     const string &original_key,
     const Segment::Candidate *candidate,
+    uint64 value_fp,
     const vector<const Node *> &nodes,
     Segments::RequestType request_type) {
   DCHECK(candidate);
@@ -156,7 +233,7 @@ CandidateFilter::ResultType CandidateFilter::FilterCandidateInternal(
     return CandidateFilter::GOOD_CANDIDATE;
   }
 
-  const size_t candidate_size = seen_.size();
+  const size_t candidate_size = seen_->size();
   if (top_candidate_ == NULL || candidate_size == 0) {
     top_candidate_ = candidate;
   }
@@ -174,7 +251,7 @@ CandidateFilter::ResultType CandidateFilter::FilterCandidateInternal(
   }
 
   // The candidate is already seen.
-  if (seen_.find(candidate->value) != seen_.end()) {
+  if (seen_->Contains(value_fp)) {
     return CandidateFilter::BAD_CANDIDATE;
   }
 
@@ -362,19 +439,20 @@ CandidateFilter::ResultType CandidateFilter::FilterCandidate(
     const Segment::Candidate *candidate,
     const vector<const Node *> &nodes,
     Segments::RequestType request_type) {
+  const uint64 value_fp = GetFingerprint(candidate->value);
   if (request_type == Segments::REVERSE_CONVERSION) {
     // In reverse conversion, only remove duplicates because the filtering
     // criteria of FilterCandidateInternal() are completely designed for
     // (forward) conversion.
-    const bool inserted = seen_.insert(candidate->value).second;
+    const bool inserted = seen_->Insert(value_fp);
     return inserted ? GOOD_CANDIDATE : BAD_CANDIDATE;
   } else {
-    const ResultType result = FilterCandidateInternal(original_key, candidate,
-                                                      nodes, request_type);
+    const ResultType result = FilterCandidateInternal(
+        original_key, candidate, value_fp, nodes, request_type);
     if (result != GOOD_CANDIDATE) {
       return result;
     }
-    seen_.insert(candidate->value);
+    seen_->Insert(value_fp);
     return result;
   }
 }
@@ -30,10 +30,10 @@
 #ifndef MOZC_CONVERTER_CANDIDATE_FILTER_H_
 #define MOZC_CONVERTER_CANDIDATE_FILTER_H_
 
-#include <set>
 #include <string>
 #include <vector>
 #include "base/port.h"
+#include "base/scoped_ptr.h"
 #include "converter/segments.h"
 
 namespace mozc {
@@ -68,16 +68,21 @@ class CandidateFilter {
   void Reset();
 
  private:
+  // |value_fp| is the fingerprint of |candidate->value|.
   ResultType FilterCandidateInternal(const string &original_key,
                                      const Segment::Candidate *candidate,
+                                     uint64 value_fp,
                                      const vector<const Node *> &nodes,
                                      Segments::RequestType request_type);
 
+  // Open addressing hash set of the fingerprints of the candidate values.
+  class FingerprintSet;
+
   const SuppressionDictionary *suppression_dictionary_;
   const POSMatcher *pos_matcher_;
   const SuggestionFilter *suggestion_filter_;
 
-  set<string> seen_;
+  scoped_ptr<FingerprintSet> seen_;
   const Segment::Candidate *top_candidate_;
 
   DISALLOW_COPY_AND_ASSIGN(CandidateFilter);
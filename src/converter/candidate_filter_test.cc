@@ -896,5 +896,38 @@ TEST_F(CandidateFilterTest, ReverseConversion) {
   }
 }
 
+TEST_F(CandidateFilterTest, ReverseConversionManyCandidates) {
+  scoped_ptr<CandidateFilter> filter(CreateCandidateFilter());
+  vector<const Node *> nodes;
+  GetDefaultNodes(&nodes);
+
+  // Reverse conversion has no upper bound of the number of candidates, so
+  // the set of seen values has to grow beyond its initial size.
+  const int kSize = 2000;
+  vector<Segment::Candidate *> candidates;
+  for (int i = 0; i < kSize; ++i) {
+    Segment::Candidate *c = NewCandidate();
+    c->value = Util::StringPrintf("value%d", i);
+    candidates.push_back(c);
+  }
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(CandidateFilter::GOOD_CANDIDATE,
+              filter->FilterCandidate("", candidates[i], nodes,
+                                      Segments::REVERSE_CONVERSION));
+  }
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(CandidateFilter::BAD_CANDIDATE,
+              filter->FilterCandidate("", candidates[i], nodes,
+                                      Segments::REVERSE_CONVERSION));
+  }
+
+  filter->Reset();
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(CandidateFilter::GOOD_CANDIDATE,
+              filter->FilterCandidate("", candidates[i], nodes,
+                                      Segments::REVERSE_CONVERSION));
+  }
+}
+
 }  // namespace converter
 }  // namespace mozc
@@ -30,6 +30,7 @@
 #include "config/config_handler.h"
 #include "converter/conversion_request.h"
 #include "base/logging.h"
+#include "base/util.h"
 #include "session/commands.pb.h"
 
 namespace mozc {
@@ -40,7 +41,8 @@ ConversionRequest::ConversionRequest()
       use_actual_converter_for_realtime_conversion_(false),
       composer_key_selection_(CONVERSION_KEY),
       skip_slow_rewriters_(false),
-      create_partial_candidates_(false) {}
+      create_partial_candidates_(false),
+      deadline_ticks_(0) {}
 
 ConversionRequest::ConversionRequest(const composer::Composer *c,
                                      const commands::Request *request)
@@ -49,7 +51,8 @@ ConversionRequest::ConversionRequest(const composer::Composer *c,
       use_actual_converter_for_realtime_conversion_(false),
       composer_key_selection_(CONVERSION_KEY),
       skip_slow_rewriters_(false),
-      create_partial_candidates_(false) {}
+      create_partial_candidates_(false),
+      deadline_ticks_(0) {}
 
 ConversionRequest::~ConversionRequest() {}
 
@@ -111,6 +114,26 @@ bool ConversionRequest::IsKanaModifierInsensitiveConversion() const {
          GET_CONFIG(use_kana_modifier_insensitive_conversion);
 }
 
+void ConversionRequest::set_latency_budget_msec(uint32 msec) {
+  if (msec == 0) {
+    deadline_ticks_ = 0;
+    return;
+  }
+  deadline_ticks_ = Util::GetTicks() +
+      Util::GetFrequency() * static_cast<uint64>(msec) / 1000;
+}
+
+bool ConversionRequest::has_deadline() const {
+  return deadline_ticks_ != 0;
+}
+
+bool ConversionRequest::IsDeadlineExceeded() const {
+  if (deadline_ticks_ == 0) {
+    return false;
+  }
+  return Util::GetTicks() >= deadline_ticks_;
+}
+
 void ConversionRequest::CopyFrom(const ConversionRequest &request) {
   composer_ = request.composer_;
   request_ = request.request_;
@@ -119,6 +142,7 @@ void ConversionRequest::CopyFrom(const ConversionRequest &request) {
   composer_key_selection_ = request.composer_key_selection_;
   skip_slow_rewriters_ = request.skip_slow_rewriters_;
   create_partial_candidates_ = request.create_partial_candidates_;
+  deadline_ticks_ = request.deadline_ticks_;
 }
 
 }  // namespace mozc
@@ -94,6 +94,16 @@ class ConversionRequest {
 
   bool IsKanaModifierInsensitiveConversion() const;
 
+  // Sets the latency budget of this request, counted from now. The stages
+  // of conversion and suggestion check the budget cooperatively and return
+  // the results found so far once it is used up. Zero clears the budget.
+  void set_latency_budget_msec(uint32 msec);
+  bool has_deadline() const;
+
+  // Returns true if the latency budget has been used up. Always false if no
+  // budget is set.
+  bool IsDeadlineExceeded() const;
+
  private:
   // Required fields
   // Input composer to generate a key for conversion, suggestion, etc.
@@ -121,6 +131,10 @@ class ConversionRequest {
   // For example, "私の" is created from composition "わたしのなまえ".
   bool create_partial_candidates_;
 
+  // The deadline in Util::GetTicks(), which is not affected by changes of
+  // the wall clock. Zero means that the request has no deadline.
+  uint64 deadline_ticks_;
+
   // TODO(noriyukit): Moves all the members of Segments that are irrelevant to
   // this structure, e.g., Segments::user_history_enabled_ and
   // Segments::request_type_. Also, a key for conversion is eligible to live in
@@ -98,6 +98,7 @@
         '../dictionary/dictionary_base.gyp:pos_matcher',
         '../prediction/prediction_base.gyp:suggestion_filter',
         '../transliteration/transliteration.gyp:transliteration',
+        'conversion_request',
       ],
     },
     {
@@ -137,6 +138,7 @@
         '../dictionary/dictionary_base.gyp:suppression_dictionary',
         '../rewriter/rewriter_base.gyp:gen_rewriter_files#host',
         '../session/session_base.gyp:session_protocol',
+        '../usage_stats/usage_stats_base.gyp:usage_stats',
         'immutable_converter_interface',
         'segments',
       ],
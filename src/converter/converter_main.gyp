@@ -52,5 +52,25 @@
         'converter_base.gyp:segments',
       ],
     },
+    {
+      'target_name': 'nbest_generator_benchmark_main',
+      'type': 'executable',
+      'sources': [
+        'nbest_generator_benchmark_main.cc',
+      ],
+      'dependencies': [
+        '../data_manager/oss/oss_data_manager.gyp:oss_data_manager',
+        '../data_manager/testing/mock_data_manager.gyp:mock_data_manager',
+        '../dictionary/dictionary.gyp:dictionary_impl',
+        '../dictionary/dictionary.gyp:suffix_dictionary',
+        '../dictionary/system/system_dictionary.gyp:system_dictionary',
+        '../dictionary/system/system_dictionary.gyp:value_dictionary',
+        '../prediction/prediction_base.gyp:suggestion_filter',
+        'converter_base.gyp:connector_base',
+        'converter_base.gyp:immutable_converter',
+        'converter_base.gyp:segmenter_base',
+        'converter_base.gyp:segments',
+      ],
+    },
   ],
 }
@@ -57,6 +57,7 @@
 #include "dictionary/suppression_dictionary.h"
 #include "prediction/suggestion_filter.h"
 #include "session/commands.pb.h"
+#include "usage_stats/usage_stats.h"
 
 DECLARE_bool(disable_lattice_cache);
 DEFINE_bool(disable_predictive_realtime_conversion,
@@ -1659,13 +1660,14 @@ void ImmutableConverterImpl::Resegment(
 
 // Single segment conversion results should be set to |segments|.
 void ImmutableConverterImpl::InsertFirstSegmentToCandidates(
+    const ConversionRequest &request,
     Segments *segments,
     const Lattice &lattice,
     const vector<uint16> &group,
     size_t max_candidates_size) const {
   const size_t only_first_segment_candidate_pos =
       segments->conversion_segment(0).candidates_size();
-  InsertCandidates(segments, lattice, group,
+  InsertCandidates(request, segments, lattice, group,
                    max_candidates_size,
                    ONLY_FIRST_SEGMENT);
   // Note that inserted candidates might consume the entire key.
@@ -1788,6 +1790,7 @@ Segment *ImmutableConverterImpl::GetInsertTargetSegment(
 }
 
 void ImmutableConverterImpl::InsertCandidates(
+    const ConversionRequest &request,
     Segments *segments,
     const Lattice &lattice,
     const vector<uint16> &group,
@@ -1809,6 +1812,8 @@ void ImmutableConverterImpl::InsertCandidates(
   NBestGenerator nbest_generator(
       suppression_dictionary_, segmenter_, connector_, pos_matcher_,
       &lattice, suggestion_filter_);
+  nbest_generator.set_request(&request);
+  bool deadline_exceeded = false;
 
   string original_key;
   for (size_t i = 0; i < segments->conversion_segments_size(); ++i) {
@@ -1841,6 +1846,7 @@ void ImmutableConverterImpl::InsertCandidates(
 
     ExpandCandidates(original_key, &nbest_generator, segment,
                      segments->request_type(), expand_size);
+    deadline_exceeded |= nbest_generator.deadline_exceeded();
 
     if (type == MULTI_SEGMENTS || type == SINGLE_SEGMENT) {
       InsertDummyCandidates(segment, expand_size);
@@ -1856,6 +1862,11 @@ void ImmutableConverterImpl::InsertCandidates(
     begin_pos = string::npos;
     prev = node;
   }
+
+  if (deadline_exceeded) {
+    usage_stats::UsageStats::IncrementCount(
+        "SuggestionDeadlineExceededInConverter");
+  }
 }
 
 bool ImmutableConverterImpl::MakeSegments(const ConversionRequest &request,
@@ -1884,7 +1895,7 @@ bool ImmutableConverterImpl::MakeSegments(const ConversionRequest &request,
       const size_t single_segment_candidates_size =
           ((max_candidates_size > kOnlyFirstSegmentCandidateSize) ?
            max_candidates_size - kOnlyFirstSegmentCandidateSize : 1);
-      InsertCandidates(segments, lattice, group,
+      InsertCandidates(request, segments, lattice, group,
                        single_segment_candidates_size, SINGLE_SEGMENT);
 
       // Even if single_segment_candidates_size + kOnlyFirstSegmentCandidateSize
@@ -1901,10 +1912,11 @@ bool ImmutableConverterImpl::MakeSegments(const ConversionRequest &request,
           min(max_candidates_size,
               single_segment_candidates_size + kOnlyFirstSegmentCandidateSize);
       InsertFirstSegmentToCandidates(
-          segments, lattice, group, only_first_segment_candidates_size);
+          request, segments, lattice, group,
+          only_first_segment_candidates_size);
     } else {
-      InsertCandidates(
-          segments, lattice, group, max_candidates_size, SINGLE_SEGMENT);
+      InsertCandidates(request, segments, lattice, group,
+                       max_candidates_size, SINGLE_SEGMENT);
     }
   } else {
     DCHECK(!request.create_partial_candidates());
@@ -1922,8 +1934,8 @@ bool ImmutableConverterImpl::MakeSegments(const ConversionRequest &request,
     // TODO(toshiyuki): We want more beautiful structure.
     const size_t old_conversion_segments_size =
         segments->conversion_segments_size();
-    InsertCandidates(
-        segments, lattice, group, max_candidates_size, MULTI_SEGMENTS);
+    InsertCandidates(request, segments, lattice, group,
+                     max_candidates_size, MULTI_SEGMENTS);
     if (old_conversion_segments_size > 0) {
       segments->erase_segments(segments->history_segments_size(),
                                old_conversion_segments_size);
@@ -137,12 +137,16 @@ class ImmutableConverterImpl : public ImmutableConverterInterface {
 
   // Inserts first segment from conversion result to candidates.
   // Costs will be modified using the existing candidates.
-  void InsertFirstSegmentToCandidates(Segments *segments,
+  void InsertFirstSegmentToCandidates(const ConversionRequest &request,
+                                      Segments *segments,
                                       const Lattice &lattice,
                                       const vector<uint16> &group,
                                       size_t max_candidates_size) const;
 
-  void InsertCandidates(Segments *segments,
+  // Stops the enumeration of each segment at its best candidate once the
+  // latency budget of |request| is used up.
+  void InsertCandidates(const ConversionRequest &request,
+                        Segments *segments,
                         const Lattice &lattice,
                         const vector<uint16> &group,
                         size_t max_candidates_size,
@@ -37,6 +37,7 @@
 #include "base/util.h"
 #include "converter/candidate_filter.h"
 #include "converter/connector_interface.h"
+#include "converter/conversion_request.h"
 #include "converter/lattice.h"
 #include "converter/node.h"
 #include "converter/segmenter_interface.h"
@@ -112,11 +113,14 @@ NBestGenerator::NBestGenerator(const SuppressionDictionary *suppression_dic,
     : suppression_dictionary_(suppression_dic),
       segmenter_(segmenter), connector_(connector), pos_matcher_(pos_matcher),
       lattice_(lattice),
+      request_(NULL),
       begin_node_(NULL), end_node_(NULL),
       freelist_(kFreeListSize),
       filter_(new CandidateFilter(
           suppression_dic, pos_matcher, suggestion_filter)),
       viterbi_result_checked_(false),
+      has_good_candidate_(false),
+      deadline_exceeded_(false),
       check_mode_(STRICT),
       boundary_checker_(NULL) {
   DCHECK(suppression_dictionary_);
@@ -139,6 +143,8 @@ void NBestGenerator::Reset(const Node *begin_node, const Node *end_node,
   freelist_.Free();
   filter_->Reset();
   viterbi_result_checked_ = false;
+  has_good_candidate_ = false;
+  deadline_exceeded_ = false;
   check_mode_ = mode;
 
   begin_node_ = begin_node;
@@ -291,6 +297,7 @@ bool NBestGenerator::Next(const string &original_key,
     // Viterbi-best path.
     switch (InsertTopResult(original_key, candidate, request_type)) {
       case CandidateFilter::GOOD_CANDIDATE:
+        has_good_candidate_ = true;
         return true;
       case CandidateFilter::STOP_ENUMERATION:
         return false;
@@ -302,6 +309,15 @@ bool NBestGenerator::Next(const string &original_key,
     }
   }
 
+  // The latency budget is honored only after a candidate has been returned,
+  // so that the segment has at least one candidate. When the Viterbi best
+  // result is filtered out, the enumeration continues until one passes.
+  if (has_good_candidate_ &&
+      request_ != NULL && request_->IsDeadlineExceeded()) {
+    deadline_exceeded_ = true;
+    return false;
+  }
+
   const int KMaxTrial = 500;
   int num_trials = 0;
 
@@ -335,6 +351,7 @@ bool NBestGenerator::Next(const string &original_key,
 
       switch (filter_result) {
         case CandidateFilter::GOOD_CANDIDATE:
+          has_good_candidate_ = true;
           return true;
         case CandidateFilter::STOP_ENUMERATION:
           return false;
@@ -42,6 +42,7 @@
 namespace mozc {
 
 class ConnectorInterface;
+class ConversionRequest;
 class Lattice;
 class POSMatcher;
 class SegmenterInterface;
@@ -99,6 +100,20 @@ class NBestGenerator {
             Segment::Candidate *candidate,
             Segments::RequestType request_type);
 
+  // Makes Next() check the latency budget of |request|. Once the budget is
+  // used up, Next() stops the enumeration as soon as at least one candidate
+  // has been returned, which is usually the Viterbi best result. |request|
+  // is not owned and can be NULL.
+  void set_request(const ConversionRequest *request) {
+    request_ = request;
+  }
+
+  // Returns true if the enumeration since the last Reset() was stopped
+  // because the latency budget was used up.
+  bool deadline_exceeded() const {
+    return deadline_exceeded_;
+  }
+
  private:
   enum BoundaryCheckResult {
     VALID = 0,
@@ -175,6 +190,7 @@ class NBestGenerator {
   const ConnectorInterface *connector_;
   const POSMatcher *pos_matcher_;
   const Lattice *lattice_;
+  const ConversionRequest *request_;
 
   const Node *begin_node_;
   const Node *end_node_;
@@ -184,6 +200,9 @@ class NBestGenerator {
   vector<const Node *> nodes_;
   scoped_ptr<converter::CandidateFilter> filter_;
   bool viterbi_result_checked_;
+  // True if Next() has returned a candidate since the last Reset().
+  bool has_good_candidate_;
+  bool deadline_exceeded_;
   BoundaryCheckMode check_mode_;
 
   BoundaryChecker boundary_checker_;
@@ -0,0 +1,219 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Benchmark of the n-best candidate generation of the immutable converter.
+// Every segment is expanded to --max_candidates_size candidates, so the
+// time is dominated by NBestGenerator and CandidateFilter.
+//
+// Usage:
+//   nbest_generator_benchmark_main
+//     --input=data/test/stress_test/sentences.txt --max_candidates_size=200
+//
+// Each line of the input is a hiragana sentence. Lines starting with '#' are
+// skipped.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/file_stream.h"
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/scoped_ptr.h"
+#include "base/stopwatch.h"
+#include "converter/connector_base.h"
+#include "converter/connector_interface.h"
+#include "converter/immutable_converter.h"
+#include "converter/segmenter_base.h"
+#include "converter/segmenter_interface.h"
+#include "converter/segments.h"
+#include "data_manager/data_manager_interface.h"
+#include "data_manager/oss/oss_data_manager.h"
+#include "data_manager/testing/mock_data_manager.h"
+#include "dictionary/dictionary_impl.h"
+#include "dictionary/dictionary_interface.h"
+#include "dictionary/pos_group.h"
+#include "dictionary/suffix_dictionary.h"
+#include "dictionary/suppression_dictionary.h"
+#include "dictionary/system/system_dictionary.h"
+#include "dictionary/system/value_dictionary.h"
+#include "dictionary/user_dictionary_stub.h"
+#include "prediction/suggestion_filter.h"
+
+DEFINE_string(input, "", "input file of hiragana sentences");
+DEFINE_string(data_manager, "oss", "data manager: (oss, test)");
+DEFINE_int32(max_candidates_size, 200,
+             "number of candidates to expand for each segment");
+DEFINE_int32(max_sentences, 100, "maximum number of sentences to use");
+DEFINE_int32(iterations, 3, "number of times to convert each sentence");
+
+namespace mozc {
+namespace {
+
+using mozc::dictionary::DictionaryImpl;
+using mozc::dictionary::SystemDictionary;
+using mozc::dictionary::ValueDictionary;
+
+// Owns the immutable converter and the data it depends on.
+class ImmutableConverterHolder {
+ public:
+  explicit ImmutableConverterHolder(const DataManagerInterface &data_manager) {
+    const POSMatcher *pos_matcher = data_manager.GetPOSMatcher();
+    CHECK(pos_matcher);
+
+    suppression_dictionary_.reset(new SuppressionDictionary);
+
+    const char *dictionary_data = NULL;
+    int dictionary_size = 0;
+    data_manager.GetSystemDictionaryData(&dictionary_data, &dictionary_size);
+    dictionary_.reset(new DictionaryImpl(
+        SystemDictionary::CreateSystemDictionaryFromImage(
+            dictionary_data, dictionary_size),
+        ValueDictionary::CreateValueDictionaryFromImage(
+            *pos_matcher, dictionary_data, dictionary_size),
+        &user_dictionary_stub_,
+        suppression_dictionary_.get(),
+        pos_matcher));
+
+    const SuffixToken *tokens = NULL;
+    size_t tokens_size = 0;
+    data_manager.GetSuffixDictionaryData(&tokens, &tokens_size);
+    suffix_dictionary_.reset(new SuffixDictionary(tokens, tokens_size));
+
+    connector_.reset(ConnectorBase::CreateFromDataManager(data_manager));
+    segmenter_.reset(SegmenterBase::CreateFromDataManager(data_manager));
+    pos_group_.reset(new PosGroup(data_manager.GetPosGroupData()));
+
+    const char *filter_data = NULL;
+    size_t filter_size = 0;
+    data_manager.GetSuggestionFilterData(&filter_data, &filter_size);
+    suggestion_filter_.reset(new SuggestionFilter(filter_data, filter_size));
+
+    immutable_converter_.reset(new ImmutableConverterImpl(
+        dictionary_.get(),
+        suffix_dictionary_.get(),
+        suppression_dictionary_.get(),
+        connector_.get(),
+        segmenter_.get(),
+        pos_matcher,
+        pos_group_.get(),
+        suggestion_filter_.get()));
+  }
+
+  ImmutableConverterImpl *GetConverter() {
+    return immutable_converter_.get();
+  }
+
+ private:
+  UserDictionaryStub user_dictionary_stub_;
+  scoped_ptr<SuppressionDictionary> suppression_dictionary_;
+  scoped_ptr<DictionaryInterface> dictionary_;
+  scoped_ptr<DictionaryInterface> suffix_dictionary_;
+  scoped_ptr<const ConnectorInterface> connector_;
+  scoped_ptr<const SegmenterInterface> segmenter_;
+  scoped_ptr<const PosGroup> pos_group_;
+  scoped_ptr<const SuggestionFilter> suggestion_filter_;
+  scoped_ptr<ImmutableConverterImpl> immutable_converter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImmutableConverterHolder);
+};
+
+void LoadSentences(const string &filename, vector<string> *sentences) {
+  InputFileStream ifs(filename.c_str());
+  CHECK(ifs.good()) << "cannot open: " << filename;
+  string line;
+  while (getline(ifs, line) &&
+         sentences->size() < static_cast<size_t>(FLAGS_max_sentences)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    sentences->push_back(line);
+  }
+}
+
+void Run(ImmutableConverterInterface *converter,
+         Segments::RequestType request_type,
+         const vector<string> &sentences) {
+  uint64 total_usec = 0;
+  size_t num_segments = 0;
+  size_t num_candidates = 0;
+  Segments segments;
+  for (int iteration = 0; iteration < FLAGS_iterations; ++iteration) {
+    for (size_t i = 0; i < sentences.size(); ++i) {
+      segments.Clear();
+      segments.set_request_type(request_type);
+      segments.set_max_conversion_candidates_size(FLAGS_max_candidates_size);
+      segments.set_max_prediction_candidates_size(FLAGS_max_candidates_size);
+      segments.add_segment()->set_key(sentences[i]);
+      Stopwatch stopwatch = Stopwatch::StartNew();
+      CHECK(converter->Convert(&segments));
+      stopwatch.Stop();
+      total_usec += stopwatch.GetElapsedMicroseconds();
+      num_segments += segments.conversion_segments_size();
+      for (size_t j = 0; j < segments.conversion_segments_size(); ++j) {
+        num_candidates += segments.conversion_segment(j).candidates_size();
+      }
+    }
+  }
+  CHECK_GT(num_segments, 0);
+  cout << (request_type == Segments::CONVERSION ? "conversion" : "suggestion")
+       << ": segments " << num_segments
+       << ", candidates/segment "
+       << static_cast<double>(num_candidates) / num_segments
+       << ", " << static_cast<double>(total_usec) / num_segments
+       << " usec/segment" << endl;
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  vector<string> sentences;
+  mozc::LoadSentences(FLAGS_input, &sentences);
+  CHECK(!sentences.empty());
+
+  scoped_ptr<const mozc::DataManagerInterface> data_manager;
+  if (FLAGS_data_manager == "oss") {
+    data_manager.reset(new mozc::oss::OssDataManager);
+  } else if (FLAGS_data_manager == "test") {
+    data_manager.reset(new mozc::testing::MockDataManager);
+  }
+  CHECK(data_manager.get()) << "Invalid data manager: " << FLAGS_data_manager;
+
+  mozc::ImmutableConverterHolder holder(*data_manager);
+  // Warms up the dictionaries before measuring.
+  mozc::Run(holder.GetConverter(), mozc::Segments::CONVERSION, sentences);
+
+  mozc::Run(holder.GetConverter(), mozc::Segments::CONVERSION, sentences);
+  mozc::Run(holder.GetConverter(), mozc::Segments::SUGGESTION, sentences);
+  return 0;
+}
@@ -148,7 +148,8 @@ string Segment::Candidate::DebugString() const {
 
 Segment::Segment()
     : segment_type_(FREE),
-      pool_(new ObjectPool<Candidate>(16)) {}
+      pool_(new ObjectPool<Candidate>(16)),
+      recycling_enabled_(false) {}
 
 Segment::~Segment() {}
 
@@ -212,10 +213,26 @@ size_t Segment::candidates_size() const {
 }
 
 void Segment::clear_candidates() {
-  pool_->Free();
+  if (recycling_enabled_) {
+    pool_->Reset();
+  } else {
+    pool_->Free();
+  }
   candidates_.clear();
 }
 
+void Segment::set_recycling_enabled(bool enabled) {
+  recycling_enabled_ = enabled;
+}
+
+bool Segment::recycling_enabled() const {
+  return recycling_enabled_;
+}
+
+void Segment::set_allocation_counter(size_t *counter) {
+  pool_->set_allocation_counter(counter);
+}
+
 Segment::Candidate *Segment::push_back_candidate() {
   Candidate *candidate = pool_->Alloc();
   candidate->Init();
@@ -411,9 +428,13 @@ Segments::Segments()
     max_conversion_candidates_size_(kMaxConversionCandidatesSize),
     resized_(false),
     user_history_enabled_(true),
+    recycling_enabled_(false),
+    allocation_count_(0),
     request_type_(Segments::CONVERSION),
     pool_(new ObjectPool<Segment>(32)),
-    cached_lattice_(new Lattice()) {}
+    cached_lattice_(new Lattice()) {
+  pool_->set_allocation_counter(&allocation_count_);
+}
 
 Segments::~Segments() {}
 
@@ -433,6 +454,29 @@ bool Segments::user_history_enabled() const {
   return user_history_enabled_;
 }
 
+void Segments::set_recycling_enabled(bool enabled) {
+  recycling_enabled_ = enabled;
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    segments_[i]->set_recycling_enabled(enabled);
+  }
+}
+
+bool Segments::recycling_enabled() const {
+  return recycling_enabled_;
+}
+
+size_t Segments::allocation_count() const {
+  return allocation_count_;
+}
+
+Segment *Segments::AllocSegment() {
+  Segment *segment = pool_->Alloc();
+  segment->set_recycling_enabled(recycling_enabled_);
+  segment->set_allocation_counter(&allocation_count_);
+  segment->Clear();
+  return segment;
+}
+
 const Segment &Segments::segment(size_t i) const {
   return *segments_[i];
 }
@@ -462,22 +506,19 @@ Segment *Segments::add_segment() {
 }
 
 Segment *Segments::insert_segment(size_t i) {
-  Segment *segment = pool_->Alloc();
-  segment->Clear();
+  Segment *segment = AllocSegment();
   segments_.insert(segments_.begin() + i, segment);
   return segment;
 }
 
 Segment *Segments::push_back_segment() {
-  Segment *segment = pool_->Alloc();
-  segment->Clear();
+  Segment *segment = AllocSegment();
   segments_.push_back(segment);
   return segment;
 }
 
 Segment *Segments::push_front_segment() {
-  Segment *segment = pool_->Alloc();
-  segment->Clear();
+  Segment *segment = AllocSegment();
   segments_.push_front(segment);
   return segment;
 }
@@ -565,7 +606,11 @@ void Segments::CopyFrom(const Segments &src) {
 }
 
 void Segments::clear_segments() {
-  pool_->Free();
+  if (recycling_enabled_) {
+    pool_->Reset();
+  } else {
+    pool_->Free();
+  }
   resized_ = false;
   segments_.clear();
 }
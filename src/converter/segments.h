@@ -258,6 +258,16 @@ class Segment {
   // do not erase meta candidates
   void clear_candidates();
 
+  // When recycling is enabled, clear_candidates() keeps all the allocated
+  // candidates, including the capacity of their strings, for reuse.
+  // Otherwise it releases the candidates beyond the first chunk.
+  void set_recycling_enabled(bool enabled);
+  bool recycling_enabled() const;
+
+  // Increments |*counter| every time candidates are allocated from the heap.
+  // |counter| can be NULL and is not owned.
+  void set_allocation_counter(size_t *counter);
+
   // meta candidates
   // TODO(toshiyuki): Integrate meta candidates to candidate and delete these
   size_t meta_candidates_size() const;
@@ -292,6 +302,7 @@ class Segment {
   deque<Candidate *> candidates_;
   vector<Candidate>  meta_candidates_;
   scoped_ptr<ObjectPool<Candidate> > pool_;
+  bool recycling_enabled_;
   DISALLOW_COPY_AND_ASSIGN(Segment);
 };
 
@@ -402,6 +413,18 @@ class Segments {
   bool resized() const;
   void set_resized(bool resized);
 
+  // Enables recycling of segments and candidates (see
+  // Segment::set_recycling_enabled()).  Once a conversion has warmed the
+  // pools up, following conversions of similar size allocate nothing.
+  void set_recycling_enabled(bool enabled);
+  bool recycling_enabled() const;
+
+  // Returns the number of heap allocations done by the segment and candidate
+  // pools since construction.  Comparing the values before and after
+  // StartConversion()/StartSuggestion() shows whether the request reused the
+  // recycled objects.
+  size_t allocation_count() const;
+
   // clear segments
   void Clear();
 
@@ -425,11 +448,16 @@ class Segments {
   virtual ~Segments();
 
  private:
+  // Allocates a cleared segment from |pool_|.
+  Segment *AllocSegment();
+
   size_t max_history_segments_size_;
   size_t max_prediction_candidates_size_;
   size_t max_conversion_candidates_size_;
   bool resized_;
   bool user_history_enabled_;
+  bool recycling_enabled_;
+  size_t allocation_count_;
 
   RequestType request_type_;
   scoped_ptr<ObjectPool<Segment> > pool_;
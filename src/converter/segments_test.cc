@@ -512,6 +512,66 @@ TEST_F(CandidateTest, functional_value) {
   EXPECT_EQ("", candidate.functional_value());
 }
 
+namespace {
+void FillSegments(size_t segments_size, size_t candidates_size,
+                  Segments *segments) {
+  segments->Clear();
+  for (size_t i = 0; i < segments_size; ++i) {
+    Segment *segment = segments->add_segment();
+    segment->set_key("key");
+    for (size_t j = 0; j < candidates_size; ++j) {
+      Segment::Candidate *candidate = segment->add_candidate();
+      candidate->key = "long enough key not to fit in a small buffer";
+      candidate->value = "long enough value not to fit in a small buffer";
+    }
+  }
+}
+}  // namespace
+
+TEST_F(SegmentsTest, RecyclingTest) {
+  // Enough segments and candidates to span several chunks of the pools.
+  const size_t kSegmentsSize = 40;
+  const size_t kCandidatesSize = 50;
+
+  {
+    Segments segments;
+    EXPECT_FALSE(segments.recycling_enabled());
+    FillSegments(kSegmentsSize, kCandidatesSize, &segments);
+    const size_t count = segments.allocation_count();
+    EXPECT_LT(0, count);
+    // Without recycling, chunks other than the first ones are released.
+    FillSegments(kSegmentsSize, kCandidatesSize, &segments);
+    EXPECT_LT(count, segments.allocation_count());
+  }
+
+  {
+    Segments segments;
+    segments.set_recycling_enabled(true);
+    FillSegments(kSegmentsSize, kCandidatesSize, &segments);
+    const size_t count = segments.allocation_count();
+    EXPECT_LT(0, count);
+    const Segment::Candidate *candidate =
+        &segments.segment(kSegmentsSize - 1).candidate(kCandidatesSize - 1);
+    const size_t capacity = candidate->value.capacity();
+
+    for (int i = 0; i < 3; ++i) {
+      FillSegments(kSegmentsSize, kCandidatesSize, &segments);
+      EXPECT_EQ(count, segments.allocation_count());
+    }
+    // The same objects are reused with their string capacity.
+    EXPECT_EQ(candidate,
+              &segments.segment(kSegmentsSize - 1).candidate(
+                  kCandidatesSize - 1));
+    segments.Clear();
+    EXPECT_LE(capacity, candidate->value.capacity());
+
+    // Smaller requests do not allocate either.
+    FillSegments(1, 1, &segments);
+    EXPECT_EQ(count, segments.allocation_count());
+    EXPECT_TRUE(segments.segment(0).recycling_enabled());
+  }
+}
+
 TEST_F(SegmentTest, CopyFrom) {
   Segment src, dest;
 
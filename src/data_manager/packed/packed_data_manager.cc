@@ -36,6 +36,7 @@
 #include "base/protobuf/coded_stream.h"
 #include "base/protobuf/gzip_stream.h"
 #include "base/protobuf/zero_copy_stream_impl.h"
+#include "base/startup_trace.h"
 #include "converter/boundary_struct.h"
 #include "data_manager/data_manager_interface.h"
 #include "data_manager/packed/system_dictionary_data.pb.h"
@@ -604,6 +605,7 @@ PackedDataManager::~PackedDataManager() {
 }
 
 bool PackedDataManager::Init(const string &system_dictionary_data) {
+  ScopedStartupTrace trace("PackedDataManager::Init");
   manager_impl_.reset(new Impl());
   if (manager_impl_->Init(system_dictionary_data)) {
     return true;
@@ -615,6 +617,7 @@ bool PackedDataManager::Init(const string &system_dictionary_data) {
 
 bool PackedDataManager::InitWithZippedData(
     const string &zipped_system_dictionary_data) {
+  ScopedStartupTrace trace("PackedDataManager::InitWithZippedData");
   manager_impl_.reset(new Impl());
   if (manager_impl_->InitWithZippedData(zipped_system_dictionary_data)) {
     return true;
@@ -56,6 +56,7 @@
 
 #include "base/logging.h"
 #include "base/port.h"
+#include "base/startup_trace.h"
 #include "base/string_piece.h"
 #include "base/system_util.h"
 #include "base/util.h"
@@ -575,6 +576,7 @@ void SystemDictionary::Builder::SetCodec(
 }
 
 SystemDictionary *SystemDictionary::Builder::Build() {
+  ScopedStartupTrace trace("SystemDictionary::Builder::Build");
   if (codec_ == NULL) {
     codec_ = SystemDictionaryCodecFactory::GetCodec();
   }
@@ -696,6 +698,7 @@ void SystemDictionary::InitReverseLookupIndex() {
     return;
   }
 
+  ScopedStartupTrace trace("ReverseLookupIndex");
   reverse_lookup_index_.reset(
       new ReverseLookupIndex(codec_, token_array_.get()));
 }
@@ -30,15 +30,22 @@
 #include "dictionary/user_dictionary.h"
 
 #include <algorithm>
-#include <set>
+#include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/executor.h"
+#include "base/file_stream.h"
+#include "base/file_util.h"
+#include "base/hash_tables.h"
 #include "base/logging.h"
+#include "base/mmap.h"
 #include "base/mutex.h"
 #include "base/singleton.h"
+#include "base/startup_trace.h"
 #include "base/stl_util.h"
-#include "base/thread.h"
 #include "base/util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
@@ -95,6 +102,108 @@ class UserDictionaryFileManager {
   DISALLOW_COPY_AND_ASSIGN(UserDictionaryFileManager);
 };
 
+// The index file keeps the tokens expanded from the user dictionary file, so
+// that the next startup doesn't need to parse the storage, expand the
+// entries, and sort the tokens again.  It is stored next to the storage as
+// "<storage file name>.index" in the following layout, in the native byte
+// order:
+//   uint32 magic, uint32 version,
+//   uint64 fingerprint of the storage file,
+//   uint64 fingerprint of the POS data (see GetUserPOSFingerprint),
+//   uint64 fingerprint of the payload,
+//   payload:
+//     uint32 number of tokens,
+//     tokens sorted by key and id: uint16 id, int16 cost, and key, value and
+//       comment as strings,
+//     uint32 number of suppression entries,
+//     suppression entries: key and value as strings,
+// where a string is a uint32 length followed by its bytes.
+const uint32 kIndexFileMagic = 0x58444955;  // "UIDX"
+// Increment this when the layout or the expansion of the entries changes.
+const uint32 kIndexFileVersion = 1;
+const char kIndexFileSuffix[] = ".index";
+const size_t kIndexFileHeaderSize =
+    sizeof(uint32) + sizeof(uint32) + sizeof(uint64) * 3;
+
+template <typename T>
+void AppendFixed(T value, string *output) {
+  output->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void AppendString(const string &str, string *output) {
+  AppendFixed<uint32>(static_cast<uint32>(str.size()), output);
+  output->append(str);
+}
+
+class IndexReader {
+ public:
+  IndexReader(const char *begin, const char *end)
+      : current_(begin), end_(end) {}
+
+  template <typename T>
+  bool ReadFixed(T *value) {
+    if (end_ - current_ < static_cast<ptrdiff_t>(sizeof(*value))) {
+      return false;
+    }
+    memcpy(value, current_, sizeof(*value));
+    current_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadString(string *str) {
+    uint32 size = 0;
+    if (!ReadFixed(&size) || end_ - current_ < static_cast<ptrdiff_t>(size)) {
+      return false;
+    }
+    str->assign(current_, size);
+    current_ += size;
+    return true;
+  }
+
+  const char *current() const { return current_; }
+  const char *end() const { return end_; }
+
+ private:
+  const char *current_;
+  const char *end_;
+};
+
+// Returns the fingerprint of the whole content of |filename|.
+bool GetFileFingerprint(const string &filename, uint64 *fingerprint) {
+  Mmap mmap;
+  if (!FileUtil::FileExists(filename) || !mmap.Open(filename.c_str(), "r")) {
+    return false;
+  }
+  *fingerprint = Util::Fingerprint(mmap.begin(), mmap.size());
+  return true;
+}
+
+// Returns a fingerprint of how |user_pos| expands entries, so that the index
+// file is rebuilt when the POS data is updated.
+uint64 GetUserPOSFingerprint(const UserPOSInterface &user_pos) {
+  // "あ"
+  const string kProbe = "\xE3\x81\x82";
+  FingerprintBuilder builder(kIndexFileVersion);
+  vector<string> pos_list;
+  user_pos.GetPOSList(&pos_list);
+  vector<UserPOS::Token> tokens;
+  for (size_t i = 0; i < pos_list.size(); ++i) {
+    builder.Append(pos_list[i]);
+    tokens.clear();
+    user_pos.GetTokens(kProbe, kProbe, pos_list[i], &tokens);
+    for (size_t j = 0; j < tokens.size(); ++j) {
+      builder.Append(tokens[j].key);
+      builder.Append(tokens[j].value);
+      builder.Append(StringPiece(reinterpret_cast<const char *>(&tokens[j].id),
+                                 sizeof(tokens[j].id)));
+      builder.Append(StringPiece(
+          reinterpret_cast<const char *>(&tokens[j].cost),
+          sizeof(tokens[j].cost)));
+    }
+  }
+  return builder.Get();
+}
+
 void FillTokenFromUserPOSToken(const UserPOS::Token &user_pos_token,
                                Token *token) {
   token->key = user_pos_token.key;
@@ -120,11 +229,12 @@ class TokensIndex : public vector<UserPOS::Token *> {
   void Clear() {
     STLDeleteElements(this);
     clear();
+    suppression_entries_.clear();
   }
 
   void Load(const user_dictionary::UserDictionaryStorage &storage) {
     Clear();
-    set<uint64> seen;
+    hash_set<uint64> seen;
     vector<UserPOS::Token> tokens;
 
     if (!suppression_dictionary_->IsLocked()) {
@@ -175,6 +285,7 @@ MOZC_CLANG_POP_WARNING();
         // "抑制単語"
         if (entry.pos() == user_dictionary::UserDictionary::SUPPRESSION_WORD) {
           suppression_dictionary_->AddEntry(reading, entry.value());
+          suppression_entries_.push_back(make_pair(reading, entry.value()));
         } else {
           tokens.clear();
           user_pos_->GetTokens(
@@ -191,6 +302,131 @@ MOZC_CLANG_POP_WARNING();
     // Sort first by key and then by POS ID.
     sort(this->begin(), this->end(), OrderByKeyThenById());
 
+    OnLoaded();
+  }
+
+  // Loads the tokens from the index file written by SaveToFile().  Returns
+  // false without touching the suppression dictionary if the file is broken
+  // or was built from another storage file or POS data.
+  bool LoadFromFile(const string &filename, uint64 source_fingerprint) {
+    Clear();
+    Mmap mmap;
+    if (!FileUtil::FileExists(filename) ||
+        !mmap.Open(filename.c_str(), "r")) {
+      return false;
+    }
+
+    IndexReader reader(mmap.begin(), mmap.end());
+    uint32 magic = 0, version = 0;
+    uint64 file_source_fingerprint = 0, pos_fingerprint = 0, checksum = 0;
+    if (!reader.ReadFixed(&magic) || magic != kIndexFileMagic ||
+        !reader.ReadFixed(&version) || version != kIndexFileVersion ||
+        !reader.ReadFixed(&file_source_fingerprint) ||
+        file_source_fingerprint != source_fingerprint ||
+        !reader.ReadFixed(&pos_fingerprint) ||
+        pos_fingerprint != GetUserPOSFingerprint(*user_pos_) ||
+        !reader.ReadFixed(&checksum) ||
+        checksum != Util::Fingerprint(reader.current(),
+                                      reader.end() - reader.current())) {
+      VLOG(1) << "Index file is outdated: " << filename;
+      return false;
+    }
+
+    uint32 num_tokens = 0;
+    if (!reader.ReadFixed(&num_tokens)) {
+      return false;
+    }
+    reserve(num_tokens);
+    for (uint32 i = 0; i < num_tokens; ++i) {
+      scoped_ptr<UserPOS::Token> token(new UserPOS::Token);
+      if (!reader.ReadFixed(&token->id) ||
+          !reader.ReadFixed(&token->cost) ||
+          !reader.ReadString(&token->key) ||
+          !reader.ReadString(&token->value) ||
+          !reader.ReadString(&token->comment)) {
+        Clear();
+        return false;
+      }
+      push_back(token.release());
+    }
+
+    uint32 num_suppression_entries = 0;
+    if (!reader.ReadFixed(&num_suppression_entries)) {
+      Clear();
+      return false;
+    }
+    suppression_entries_.resize(num_suppression_entries);
+    for (uint32 i = 0; i < num_suppression_entries; ++i) {
+      if (!reader.ReadString(&suppression_entries_[i].first) ||
+          !reader.ReadString(&suppression_entries_[i].second)) {
+        Clear();
+        return false;
+      }
+    }
+
+    if (!suppression_dictionary_->IsLocked()) {
+      LOG(ERROR) << "SuppressionDictionary must be locked first";
+    }
+    suppression_dictionary_->Clear();
+    for (size_t i = 0; i < suppression_entries_.size(); ++i) {
+      suppression_dictionary_->AddEntry(suppression_entries_[i].first,
+                                        suppression_entries_[i].second);
+    }
+
+    OnLoaded();
+    return true;
+  }
+
+  bool SaveToFile(const string &filename, uint64 source_fingerprint) const {
+    string payload;
+    AppendFixed<uint32>(static_cast<uint32>(size()), &payload);
+    for (const_iterator it = begin(); it != end(); ++it) {
+      AppendFixed((*it)->id, &payload);
+      AppendFixed((*it)->cost, &payload);
+      AppendString((*it)->key, &payload);
+      AppendString((*it)->value, &payload);
+      AppendString((*it)->comment, &payload);
+    }
+    AppendFixed<uint32>(static_cast<uint32>(suppression_entries_.size()),
+                        &payload);
+    for (size_t i = 0; i < suppression_entries_.size(); ++i) {
+      AppendString(suppression_entries_[i].first, &payload);
+      AppendString(suppression_entries_[i].second, &payload);
+    }
+
+    string header;
+    header.reserve(kIndexFileHeaderSize);
+    AppendFixed(kIndexFileMagic, &header);
+    AppendFixed(kIndexFileVersion, &header);
+    AppendFixed(source_fingerprint, &header);
+    AppendFixed(GetUserPOSFingerprint(*user_pos_), &header);
+    AppendFixed(Util::Fingerprint(payload), &header);
+    DCHECK_EQ(kIndexFileHeaderSize, header.size());
+
+    const string tmp_filename = filename + ".tmp";
+    {
+      OutputFileStream ofs(tmp_filename.c_str(),
+                           ios::out | ios::binary | ios::trunc);
+      if (!ofs) {
+        LOG(ERROR) << "cannot open file: " << tmp_filename;
+        return false;
+      }
+      ofs.write(header.data(), header.size());
+      ofs.write(payload.data(), payload.size());
+      if (!ofs) {
+        LOG(ERROR) << "cannot write file: " << tmp_filename;
+        return false;
+      }
+    }
+    if (!FileUtil::AtomicRename(tmp_filename, filename)) {
+      LOG(ERROR) << "AtomicRename failed: " << filename;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  void OnLoaded() {
     suppression_dictionary_->UnLock();
 
     VLOG(1) << this->size() << " user dic entries loaded";
@@ -199,15 +435,17 @@ MOZC_CLANG_POP_WARNING();
                                         static_cast<int>(this->size()));
   }
 
- private:
   const UserPOSInterface *user_pos_;
   SuppressionDictionary *suppression_dictionary_;
+  // The entries added to |suppression_dictionary_|, kept for SaveToFile().
+  vector<pair<string, string> > suppression_entries_;
 };
 
-class UserDictionaryReloader : public Thread {
+class UserDictionaryReloader : public BackgroundTask {
  public:
   explicit UserDictionaryReloader(UserDictionary *dic)
-      : auto_register_mode_(false), dic_(dic) {
+      : BackgroundTask("UserDictionaryReloader", Executor::HIGH),
+        auto_register_mode_(false), dic_(dic) {
     DCHECK(dic_);
   }
 
@@ -233,20 +471,36 @@ class UserDictionaryReloader : public Thread {
   }
 
   virtual void Run() {
-    scoped_ptr<UserDictionaryStorage> storage(new UserDictionaryStorage(
-        Singleton<UserDictionaryFileManager>::get()->GetFileName()));
+    ScopedStartupTrace trace("UserDictionary::Reload");
+    const string filename =
+        Singleton<UserDictionaryFileManager>::get()->GetFileName();
+    const string index_filename = filename + kIndexFileSuffix;
+
+    // Unless the storage is going to be modified, use the index file if it
+    // was built from the same storage.
+    uint64 fingerprint = 0;
+    const bool has_fingerprint = GetFileFingerprint(filename, &fingerprint);
+    if (!auto_register_mode_ && has_fingerprint &&
+        dic_->LoadFromIndexFile(index_filename, fingerprint)) {
+      return;
+    }
+
+    scoped_ptr<UserDictionaryStorage> storage(
+        new UserDictionaryStorage(filename));
 
     // Load from file
     if (!storage->Load()) {
       return;
     }
 
+    bool modified = auto_register_mode_;
     if (storage->ConvertSyncDictionariesToNormalDictionaries()) {
       LOG(INFO) << "Syncable dictionaries are converted to normal dictionaries";
       if (storage->Lock()) {
         storage->Save();
         storage->UnLock();
       }
+      modified = true;
     }
 
     if (auto_register_mode_ &&
@@ -258,6 +512,15 @@ class UserDictionaryReloader : public Thread {
 
     auto_register_mode_ = false;
     dic_->Load(*(storage.get()));
+
+    // The index is keyed by the fingerprint taken before loading, so make
+    // sure that the file was not replaced meanwhile.
+    uint64 loaded_fingerprint = 0;
+    if (!modified && has_fingerprint &&
+        GetFileFingerprint(filename, &loaded_fingerprint) &&
+        loaded_fingerprint == fingerprint) {
+      dic_->SaveIndexFile(index_filename, fingerprint);
+    }
   }
 
  private:
@@ -598,6 +861,24 @@ bool UserDictionary::Load(
   return true;
 }
 
+bool UserDictionary::LoadFromIndexFile(const string &filename,
+                                       uint64 source_fingerprint) {
+  TokensIndex *tokens = new TokensIndex(user_pos_.get(),
+                                        suppression_dictionary_);
+  if (!tokens->LoadFromFile(filename, source_fingerprint)) {
+    delete tokens;
+    return false;
+  }
+  Swap(tokens);
+  return true;
+}
+
+bool UserDictionary::SaveIndexFile(const string &filename,
+                                   uint64 source_fingerprint) const {
+  scoped_reader_lock l(mutex_.get());
+  return tokens_->SaveToFile(filename, source_fingerprint);
+}
+
 void UserDictionary::SetUserDictionaryName(const string &filename) {
   Singleton<UserDictionaryFileManager>::get()->SetFileName(filename);
 }
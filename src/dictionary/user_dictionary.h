@@ -103,6 +103,13 @@ class UserDictionary : public DictionaryInterface {
   // Swap internal tokens index to |new_tokens|.
   void Swap(TokensIndex *new_tokens);
 
+  // Loads the tokens from the index file saved by SaveIndexFile() for the
+  // storage file whose fingerprint is |source_fingerprint|.  Returns false if
+  // the index file is missing or outdated.
+  bool LoadFromIndexFile(const string &filename, uint64 source_fingerprint);
+  bool SaveIndexFile(const string &filename, uint64 source_fingerprint) const;
+
+  friend class UserDictionaryReloader;
   friend class UserDictionaryTest;
 
   scoped_ptr<UserDictionaryReloader> reloader_;
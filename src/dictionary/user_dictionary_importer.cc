@@ -38,19 +38,27 @@
 
 #include <algorithm>
 #include <map>
-#include <set>
 #include <string>
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/flags.h"
+#include "base/hash_tables.h"
 #include "base/mmap.h"
 #include "base/number_util.h"
 #include "base/port.h"
+#include "base/scoped_ptr.h"
+#include "base/stl_util.h"
 #include "base/system_util.h"
+#include "base/thread_pool.h"
 #include "base/util.h"
 #include "base/win_util.h"
 #include "dictionary/user_dictionary_util.h"
 
+DEFINE_int32(user_dictionary_import_threads,
+             2,
+             "The number of worker threads converting imported entries");
+
 namespace mozc {
 
 using user_dictionary::UserDictionary;
@@ -171,6 +179,149 @@ bool ConvertEntryInternal(
 
   return true;
 }
+
+// The number of raw entries converted by a task at once.
+const size_t kImportBatchSize = 1024;
+
+// Converts a batch of raw entries and computes their fingerprints, so that
+// the normalization and the validation of imported entries run on workers
+// while the caller reads the next batch.
+class ConvertEntriesTask : public ThreadPool::Task {
+ public:
+  enum Status {
+    EMPTY,
+    INVALID,
+    VALID,
+  };
+
+  ConvertEntriesTask() : size_(0), counter_(NULL) {}
+  virtual ~ConvertEntriesTask() {}
+
+  // Reads up to kImportBatchSize entries from |iter|.  Returns false if no
+  // entry is read.
+  bool Read(UserDictionaryImporter::InputIteratorInterface *iter) {
+    if (raw_entries_.empty()) {
+      raw_entries_.resize(kImportBatchSize);
+      entries_.resize(kImportBatchSize);
+      statuses_.resize(kImportBatchSize);
+      fingerprints_.resize(kImportBatchSize);
+    }
+    size_ = 0;
+    while (size_ < kImportBatchSize && iter->Next(&raw_entries_[size_])) {
+      ++size_;
+    }
+    return size_ > 0;
+  }
+
+  void set_counter(BlockingCounter *counter) {
+    counter_ = counter;
+  }
+
+  virtual void Run() {
+    for (size_t i = 0; i < size_; ++i) {
+      const UserDictionaryImporter::RawEntry &raw_entry = raw_entries_[i];
+      if (raw_entry.key.empty() &&
+          raw_entry.value.empty() &&
+          raw_entry.comment.empty()) {
+        statuses_[i] = EMPTY;
+      } else if (!UserDictionaryImporter::ConvertEntry(raw_entry,
+                                                       &entries_[i])) {
+        LOG(WARNING) << "Entry is not valid";
+        statuses_[i] = INVALID;
+      } else {
+        statuses_[i] = VALID;
+        fingerprints_[i] = EntryFingerprint(entries_[i]);
+      }
+    }
+    if (counter_ != NULL) {
+      counter_->DecrementCount();
+    }
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  Status status(size_t i) const {
+    return statuses_[i];
+  }
+
+  uint64 fingerprint(size_t i) const {
+    return fingerprints_[i];
+  }
+
+  UserDictionary::Entry *mutable_entry(size_t i) {
+    return &entries_[i];
+  }
+
+ private:
+  vector<UserDictionaryImporter::RawEntry> raw_entries_;
+  vector<UserDictionary::Entry> entries_;
+  vector<Status> statuses_;
+  vector<uint64> fingerprints_;
+  size_t size_;
+  BlockingCounter *counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConvertEntriesTask);
+};
+
+// A group of tasks scheduled together.  ImportFromIterator() keeps two
+// groups: while the workers convert one, the caller reads the next batches
+// into the other and then merges the converted one.
+class ConvertEntriesTaskGroup {
+ public:
+  explicit ConvertEntriesTaskGroup(size_t num_tasks) : num_scheduled_(0) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      tasks_.push_back(new ConvertEntriesTask);
+    }
+  }
+
+  ~ConvertEntriesTaskGroup() {
+    Wait();
+    STLDeleteElements(&tasks_);
+  }
+
+  // Reads the next batches from |iter|, and returns the number of the tasks
+  // having entries.
+  size_t Read(UserDictionaryImporter::InputIteratorInterface *iter) {
+    num_scheduled_ = 0;
+    while (num_scheduled_ < tasks_.size() &&
+           tasks_[num_scheduled_]->Read(iter)) {
+      ++num_scheduled_;
+    }
+    return num_scheduled_;
+  }
+
+  void Schedule(ThreadPool *pool) {
+    counter_.reset(new BlockingCounter(num_scheduled_));
+    for (size_t i = 0; i < num_scheduled_; ++i) {
+      tasks_[i]->set_counter(counter_.get());
+      pool->Schedule(tasks_[i]);
+    }
+  }
+
+  void Wait() {
+    if (counter_.get() != NULL) {
+      counter_->Wait();
+      counter_.reset();
+    }
+  }
+
+  size_t num_scheduled() const {
+    return num_scheduled_;
+  }
+
+  ConvertEntriesTask *task(size_t i) {
+    return tasks_[i];
+  }
+
+ private:
+  vector<ConvertEntriesTask *> tasks_;
+  size_t num_scheduled_;
+  scoped_ptr<BlockingCounter> counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConvertEntriesTaskGroup);
+};
 }  // namespace
 
 #if defined(OS_WIN) && defined(HAS_MSIME_HEADER)
@@ -388,41 +539,61 @@ UserDictionaryImporter::ImportFromIterator(
   UserDictionaryImporter::ErrorType ret =
       UserDictionaryImporter::IMPORT_NO_ERROR;
 
-  set<uint64> dup_set;
+  hash_set<uint64> dup_set;
   for (size_t i = 0; i < user_dic->entries_size(); ++i) {
     dup_set.insert(EntryFingerprint(user_dic->entries(i)));
   }
 
-  UserDictionary::Entry entry;
-  RawEntry raw_entry;
-  while (iter->Next(&raw_entry)) {
-    if (user_dic->entries_size() >= max_size) {
-      LOG(WARNING) << "Too many words in one dictionary";
-      return UserDictionaryImporter::IMPORT_TOO_MANY_WORDS;
-    }
+  // The entries are read and merged into |user_dic| in the input order by
+  // this thread, and converted by the workers in batches.
+  const size_t num_threads =
+      static_cast<size_t>(max(1, FLAGS_user_dictionary_import_threads));
+  ThreadPool pool(num_threads);
+  ConvertEntriesTaskGroup group1(num_threads);
+  ConvertEntriesTaskGroup group2(num_threads);
+  ConvertEntriesTaskGroup *converting = &group1;
+  ConvertEntriesTaskGroup *reading = &group2;
+  if (converting->Read(iter) > 0) {
+    converting->Schedule(&pool);
+  }
 
-    if (raw_entry.key.empty() &&
-        raw_entry.value.empty() &&
-        raw_entry.comment.empty()) {
-      // Empty entry is just skipped. It could be annoying
-      // if we show an warning dialog when these empty candidates exist.
-      continue;
+  while (converting->num_scheduled() > 0) {
+    if (reading->Read(iter) > 0) {
+      reading->Schedule(&pool);
     }
+    converting->Wait();
+
+    for (size_t i = 0; i < converting->num_scheduled(); ++i) {
+      ConvertEntriesTask *task = converting->task(i);
+      for (size_t j = 0; j < task->size(); ++j) {
+        if (user_dic->entries_size() >= max_size) {
+          LOG(WARNING) << "Too many words in one dictionary";
+          return UserDictionaryImporter::IMPORT_TOO_MANY_WORDS;
+        }
 
-    if (!UserDictionaryImporter::ConvertEntry(raw_entry, &entry)) {
-      LOG(WARNING) << "Entry is not valid";
-      ret = UserDictionaryImporter::IMPORT_INVALID_ENTRIES;
-      continue;
-    }
+        switch (task->status(j)) {
+          case ConvertEntriesTask::EMPTY:
+            // Empty entry is just skipped. It could be annoying
+            // if we show an warning dialog when these empty candidates exist.
+            continue;
+          case ConvertEntriesTask::INVALID:
+            ret = UserDictionaryImporter::IMPORT_INVALID_ENTRIES;
+            continue;
+          case ConvertEntriesTask::VALID:
+            break;
+        }
 
-    //  don't register words if it is aleady in the current dictionary
-    if (!dup_set.insert(EntryFingerprint(entry)).second) {
-      continue;
-    }
+        //  don't register words if it is aleady in the current dictionary
+        if (!dup_set.insert(task->fingerprint(j)).second) {
+          continue;
+        }
 
-    UserDictionary::Entry *new_entry = user_dic->add_entries();
-    DCHECK(new_entry);
-    new_entry->CopyFrom(entry);
+        UserDictionary::Entry *new_entry = user_dic->add_entries();
+        DCHECK(new_entry);
+        new_entry->Swap(task->mutable_entry(j));
+      }
+    }
+    swap(converting, reading);
   }
 
   return ret;
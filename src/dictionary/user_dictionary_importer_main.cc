@@ -30,15 +30,43 @@
 #include <string>
 #include <iostream>
 
+#include "base/file_stream.h"
 #include "base/flags.h"
+#include "base/stopwatch.h"
 #include "dictionary/user_dictionary_importer.h"
 #include "dictionary/user_dictionary_storage.pb.h"
 
+DEFINE_string(input, "",
+              "Text dictionary to import. Imports from MS-IME if empty.");
+DEFINE_bool(benchmark, false,
+            "Print the import speed instead of the imported entries.");
+
 int main(int argc, char **argv) {
   InitGoogle(argv[0], &argc, &argv, false);
 
   mozc::user_dictionary::UserDictionary user_dic;
-  mozc::UserDictionaryImporter::ImportFromMSIME(&user_dic);
+  mozc::Stopwatch stopwatch = mozc::Stopwatch::StartNew();
+  mozc::UserDictionaryImporter::ErrorType result;
+  if (FLAGS_input.empty()) {
+    result = mozc::UserDictionaryImporter::ImportFromMSIME(&user_dic);
+  } else {
+    mozc::InputFileStream ifs(FLAGS_input.c_str());
+    mozc::UserDictionaryImporter::IStreamTextLineIterator iter(&ifs);
+    result = mozc::UserDictionaryImporter::ImportFromTextLineIterator(
+        mozc::UserDictionaryImporter::IME_AUTO_DETECT, &iter, &user_dic);
+  }
+  stopwatch.Stop();
+
+  if (FLAGS_benchmark) {
+    const int64 elapsed_msec = max(stopwatch.GetElapsedMilliseconds(),
+                                   static_cast<int64>(1));
+    cout << "result: " << result << endl
+         << "entries: " << user_dic.entries_size() << endl
+         << "time: " << elapsed_msec << " msec" << endl
+         << "entries/sec: " << user_dic.entries_size() * 1000 / elapsed_msec
+         << endl;
+    return 0;
+  }
 
   for (size_t i = 0; i < user_dic.entries_size(); ++i) {
     cout << user_dic.entries(i).key() << "\t"
@@ -40,6 +40,8 @@
 #include "testing/base/public/googletest.h"
 #include "testing/base/public/gunit.h"
 
+DECLARE_int32(user_dictionary_import_threads);
+
 namespace mozc {
 
 namespace {
@@ -534,6 +536,49 @@ TEST(UserDictionaryImporter, ImportFromIteratorDupTest) {
   EXPECT_EQ(2, user_dic.entries_size());
 }
 
+TEST(UserDictionaryImporter, ImportFromIteratorWithThreadsTest) {
+  const int original_threads = FLAGS_user_dictionary_import_threads;
+  FLAGS_user_dictionary_import_threads = 3;
+
+  // Mixes duplicates across the batches, empty entries and invalid entries,
+  // and checks that the result doesn't depend on how they are split.
+  vector<UserDictionaryImporter::RawEntry> entries;
+  vector<string> expected_keys;
+  for (uint32 j = 0; j < 10000; ++j) {
+    UserDictionaryImporter::RawEntry entry;
+    if (j % 7 == 0) {
+      entries.push_back(entry);
+      continue;
+    }
+    const uint32 id = (j % 3 == 0) ? j / 3 : j;
+    entry.key = "key" + NumberUtil::SimpleItoa(id);
+    entry.value = "value" + NumberUtil::SimpleItoa(id);
+    if (j % 11 != 0) {
+      // entry.set_pos("名詞");
+      entry.pos = "\xE5\x90\x8D\xE8\xA9\x9E";
+      if (find(expected_keys.begin(), expected_keys.end(), entry.key) ==
+          expected_keys.end()) {
+        expected_keys.push_back(entry.key);
+      }
+    }
+    entries.push_back(entry);
+  }
+
+  TestInputIterator iter;
+  iter.set_available(true);
+  iter.set_entries(&entries);
+  UserDictionaryStorage::UserDictionary user_dic;
+  EXPECT_EQ(UserDictionaryImporter::IMPORT_INVALID_ENTRIES,
+            UserDictionaryImporter::ImportFromIterator(&iter, &user_dic));
+
+  ASSERT_EQ(expected_keys.size(), user_dic.entries_size());
+  for (size_t i = 0; i < expected_keys.size(); ++i) {
+    EXPECT_EQ(expected_keys[i], user_dic.entries(i).key());
+  }
+
+  FLAGS_user_dictionary_import_threads = original_threads;
+}
+
 TEST(UserDictionaryImporter, GuessIMETypeTest) {
   EXPECT_EQ(UserDictionaryImporter::NUM_IMES,
             UserDictionaryImporter::GuessIMEType(""));
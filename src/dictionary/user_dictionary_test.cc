@@ -37,6 +37,7 @@
 #include <string>
 #include <vector>
 
+#include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/number_util.h"
@@ -869,6 +870,92 @@ TEST_F(UserDictionaryTest, TestSuppressionDictionary) {
   FileUtil::Unlink(filename);
 }
 
+TEST_F(UserDictionaryTest, IndexFile) {
+  const string filename = FileUtil::JoinPath(FLAGS_test_tmpdir,
+                                             "index_file_test.db");
+  const string index_filename = filename + ".index";
+  FileUtil::Unlink(filename);
+  FileUtil::Unlink(index_filename);
+
+  {
+    UserDictionaryStorage storage(filename);
+    EXPECT_TRUE(storage.Lock());
+    uint64 id = 0;
+    EXPECT_TRUE(storage.CreateDictionary("test", &id));
+    UserDictionaryStorage::UserDictionary *dic =
+        storage.mutable_dictionaries(0);
+    for (size_t j = 0; j < 100; ++j) {
+      UserDictionaryStorage::UserDictionaryEntry *entry = dic->add_entries();
+      entry->set_key("key" + NumberUtil::SimpleItoa(static_cast<uint32>(j)));
+      entry->set_value("value" +
+                       NumberUtil::SimpleItoa(static_cast<uint32>(j)));
+      entry->set_pos(user_dictionary::UserDictionary::NOUN);
+      entry->set_comment("comment");
+    }
+    UserDictionaryStorage::UserDictionaryEntry *entry = dic->add_entries();
+    entry->set_key("suppress_key");
+    entry->set_value("suppress_value");
+    entry->set_pos(user_dictionary::UserDictionary::SUPPRESSION_WORD);
+    EXPECT_TRUE(storage.Save());
+    EXPECT_TRUE(storage.UnLock());
+  }
+
+  // Builds the tokens from the storage and saves the index file.
+  scoped_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  dic->WaitForReloader();
+  dic->SetUserDictionaryName(filename);
+  dic->Reload();
+  dic->WaitForReloader();
+  EXPECT_TRUE(FileUtil::FileExists(index_filename));
+  EXPECT_EQ("comment", LookupComment(*dic, "key10", "value10"));
+
+  // Loads the same tokens and suppression entries from the index file.
+  dic.reset(CreateDictionaryWithMockPos());
+  dic->WaitForReloader();
+  EXPECT_EQ("comment", LookupComment(*dic, "key10", "value10"));
+  EXPECT_EQ("comment", LookupComment(*dic, "key99", "value99"));
+  EXPECT_TRUE(LookupComment(*dic, "key100", "value100").empty());
+  EXPECT_TRUE(suppression_dictionary_->SuppressEntry("suppress_key",
+                                                     "suppress_value"));
+
+  // A broken index file is ignored and rebuilt.
+  {
+    OutputFileStream ofs(index_filename.c_str(),
+                         ios::out | ios::binary | ios::trunc);
+    ofs << "broken";
+  }
+  dic->Reload();
+  dic->WaitForReloader();
+  EXPECT_EQ("comment", LookupComment(*dic, "key10", "value10"));
+  {
+    InputFileStream ifs(index_filename.c_str(), ios::in | ios::binary);
+    ifs.seekg(0, ios::end);
+    EXPECT_LT(6, static_cast<int>(ifs.tellg()));
+  }
+
+  // The index file is not used once the storage is updated.
+  {
+    UserDictionaryStorage storage(filename);
+    EXPECT_TRUE(storage.Load());
+    EXPECT_TRUE(storage.Lock());
+    UserDictionaryStorage::UserDictionaryEntry *entry =
+        storage.mutable_dictionaries(0)->add_entries();
+    entry->set_key("key100");
+    entry->set_value("value100");
+    entry->set_pos(user_dictionary::UserDictionary::NOUN);
+    entry->set_comment("new comment");
+    EXPECT_TRUE(storage.Save());
+    EXPECT_TRUE(storage.UnLock());
+  }
+  dic->Reload();
+  dic->WaitForReloader();
+  EXPECT_EQ("new comment", LookupComment(*dic, "key100", "value100"));
+
+  dic.reset();
+  FileUtil::Unlink(filename);
+  FileUtil::Unlink(index_filename);
+}
+
 TEST_F(UserDictionaryTest, TestSuggestionOnlyWord) {
   scoped_ptr<UserDictionary> user_dic(CreateDictionary());
   user_dic->WaitForReloader();
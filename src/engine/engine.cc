@@ -31,6 +31,8 @@
 
 #include "base/base.h"
 #include "base/logging.h"
+#include "base/startup_trace.h"
+#include "base/system_util.h"
 #include "converter/connector_base.h"
 #include "converter/converter.h"
 #include "converter/converter_interface.h"
@@ -66,6 +68,23 @@ using mozc::dictionary::ValueDictionary;
 
 namespace {
 
+// Appends the component |name| released since the resident set size was
+// |*resident_size|, and updates |*resident_size| to the current size.
+void AddTrimmedComponent(const char *name, uint64 *resident_size,
+                         vector<TrimmedComponent> *components) {
+  // The released memory is usually kept in the heap of the process.
+  SystemUtil::ReleaseFreeMemory();
+
+  TrimmedComponent component;
+  component.name = name;
+  component.resident_size_before = *resident_size;
+  component.resident_size_after = SystemUtil::GetResidentMemorySize();
+  components->push_back(component);
+  VLOG(1) << "Released " << name << ": " << component.resident_size_before
+          << " -> " << component.resident_size_after << " bytes";
+  *resident_size = component.resident_size_after;
+}
+
 class UserDataManagerImpl : public UserDataManagerInterface {
  public:
   explicit UserDataManagerImpl(PredictorInterface *predictor,
@@ -135,6 +154,7 @@ void Engine::Init(
     const DataManagerInterface *data_manager,
     PredictorInterface *(*predictor_factory)(PredictorInterface *,
                                              PredictorInterface *)) {
+  ScopedStartupTrace trace("Engine::Init");
   CHECK(data_manager);
   CHECK(predictor_factory);
 
@@ -231,11 +251,14 @@ void Engine::Init(
     CHECK(predictor_);
   }
 
-  rewriter_ = new RewriterImpl(converter_impl,
-                               data_manager,
-                               pos_group_.get(),
-                               dictionary_.get());
-  CHECK(rewriter_);
+  {
+    ScopedStartupTrace rewriter_trace("RewriterImpl");
+    rewriter_ = new RewriterImpl(converter_impl,
+                                 data_manager,
+                                 pos_group_.get(),
+                                 dictionary_.get());
+    CHECK(rewriter_);
+  }
 
   converter_impl->Init(data_manager->GetPOSMatcher(),
                        suppression_dictionary_.get(),
@@ -254,4 +277,15 @@ bool Engine::Reload() {
   return user_dictionary_->Reload();
 }
 
+void Engine::TrimMemory(vector<TrimmedComponent> *components) {
+  DCHECK(components);
+  uint64 resident_size = SystemUtil::GetResidentMemorySize();
+  if (predictor_->TrimMemory()) {
+    AddTrimmedComponent("UserHistoryPredictor", &resident_size, components);
+  }
+  if (rewriter_->TrimMemory()) {
+    AddTrimmedComponent("Rewriter", &resident_size, components);
+  }
+}
+
 }  // namespace mozc
@@ -75,6 +75,12 @@ class Engine : public EngineInterface {
     return user_data_manager_.get();
   }
 
+  // Releases the user history of the predictor and the indexes which the
+  // rewriters build on the heap.  The system dictionary and the tables of
+  // rewriters are embedded or mapped, so they are paged out by the system
+  // under memory pressure without help.
+  virtual void TrimMemory(vector<TrimmedComponent> *components);
+
  private:
   scoped_ptr<SuppressionDictionary> suppression_dictionary_;
   scoped_ptr<const ConnectorInterface> connector_;
@@ -30,6 +30,9 @@
 #ifndef MOZC_ENGINE_ENGINE_INTERFACE_H_
 #define MOZC_ENGINE_ENGINE_INTERFACE_H_
 
+#include <string>
+#include <vector>
+
 #include "base/base.h"
 
 namespace mozc {
@@ -39,6 +42,14 @@ class PredictorInterface;
 class SuppressionDictionary;
 class UserDataManagerInterface;
 
+// Resident set size of the process measured before and after a component of
+// the engine releases its memory in EngineInterface::TrimMemory().
+struct TrimmedComponent {
+  string name;
+  uint64 resident_size_before;
+  uint64 resident_size_after;
+};
+
 // Builds and manages a set of modules that are necessary for conversion,
 // prediction and rewrite. For example, a typical implementation of this
 // interface would hold the dictionary shared among converters and predictors as
@@ -65,6 +76,11 @@ class EngineInterface {
   // Gets a user data manager.
   virtual UserDataManagerInterface *GetUserDataManager() = 0;
 
+  // Releases the memory of the components which can be reloaded on demand,
+  // e.g., the cache of user history, and appends the released components to
+  // |components|.  The default implementation releases nothing.
+  virtual void TrimMemory(vector<TrimmedComponent> *components) {}
+
  protected:
   EngineInterface() {}
 
@@ -35,6 +35,7 @@
 #endif  // OS_OS_MACOSX
 
 #include <string>
+#include <vector>
 
 #include "base/scoped_handle.h"
 #include "base/scoped_ptr.h"
@@ -43,6 +44,7 @@
 namespace mozc {
 
 class IPCPathManager;
+class SharedMemoryServerChannel;
 class Thread;
 
 enum {
@@ -162,6 +164,13 @@ class IPCClient : public IPCClientInterface {
   // Do not use it unless version mismatch happens
   static bool TerminateServer(const string &name);
 
+#if defined(OS_LINUX) && !defined(OS_ANDROID)
+  // Returns the number of the calls made through the shared memory
+  // channels in this process.  Used to test the channel is not silently
+  // replaced with the socket.
+  static uint64 GetNumSharedMemoryCalls();
+#endif  // OS_LINUX && !OS_ANDROID
+
 #ifdef OS_MACOSX
   void SetMachPortManager(MachPortManagerInterface *manager) {
     mach_port_manager_ = manager;
@@ -180,6 +189,9 @@ class IPCClient : public IPCClientInterface {
   MachPortManagerInterface *mach_port_manager_;
 #else
   int socket_;
+  // Server address of the shared memory channel used instead of socket_.
+  // Empty when the socket is used.
+  string shared_memory_address_;
 #endif
   bool connected_;
   IPCPathManager *ipc_path_manager_;
@@ -290,6 +302,7 @@ class IPCServer {
 #else
   int socket_;
   string server_address_;
+  vector<SharedMemoryServerChannel *> shared_memory_channels_;
 #endif
 
   int timeout_;
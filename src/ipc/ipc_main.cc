@@ -27,12 +27,14 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <cstring>
 #include <vector>
 #include <string>
 #include <iostream>
 
 #include "base/base.h"
 #include "base/logging.h"
+#include "base/stopwatch.h"
 #include "base/thread.h"
 #include "ipc/ipc.h"
 
@@ -43,6 +45,11 @@ DEFINE_bool(client, false, "invoke as client mode");
 DEFINE_string(server_path, "", "server path");
 DEFINE_int32(num_threads, 10, "number of threads");
 DEFINE_int32(num_requests, 100, "number of requests");
+DEFINE_bool(benchmark, false, "measure the latency of the transports");
+DEFINE_int32(payload_size, 1024, "size of the request in benchmark mode");
+#if defined(OS_LINUX) && !defined(OS_ANDROID)
+DECLARE_bool(use_shared_memory_ipc);
+#endif  // OS_LINUX && !OS_ANDROID
 
 namespace mozc {
 
@@ -90,6 +97,29 @@ class EchoServerThread: public Thread {
   EchoServer *con_;
 };
 
+// Returns the average latency of the calls in microseconds.
+double MeasureLatency() {
+  const string input(max(FLAGS_payload_size, 1), 'x');
+  scoped_ptr<char[]> buf(new char[IPC_RESPONSESIZE]);
+  // Warms up the connection, which negotiates the shared memory channel.
+  {
+    IPCClient con(FLAGS_server_address, FLAGS_server_path);
+    size_t length = IPC_RESPONSESIZE;
+    CHECK(con.Call(input.data(), input.size(), buf.get(), &length, 1000));
+  }
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < FLAGS_num_requests; ++i) {
+    IPCClient con(FLAGS_server_address, FLAGS_server_path);
+    CHECK(con.Connected());
+    size_t length = IPC_RESPONSESIZE;
+    CHECK(con.Call(input.data(), input.size(), buf.get(), &length, 1000));
+    CHECK_EQ(input.size(), length);
+  }
+  stopwatch.Stop();
+  return static_cast<double>(stopwatch.GetElapsedMicroseconds()) /
+      max(FLAGS_num_requests, 1);
+}
+
 }  // namespace mozc
 
 int main(int argc, char **argv) {
@@ -120,6 +150,26 @@ int main(int argc, char **argv) {
 
     LOG(INFO) << "Done";
 
+  } else if (FLAGS_benchmark) {
+    mozc::EchoServer con(FLAGS_server_address, 10, 1000);
+    mozc::EchoServerThread server_thread_main(&con);
+    server_thread_main.SetJoinable(true);
+    server_thread_main.Start();
+
+    cout << "socket: " << mozc::MeasureLatency() << " usec/call" << endl;
+#if defined(OS_LINUX) && !defined(OS_ANDROID)
+    FLAGS_use_shared_memory_ipc = true;
+    cout << "shared memory: " << mozc::MeasureLatency() << " usec/call"
+         << endl;
+#endif  // OS_LINUX && !OS_ANDROID
+
+    mozc::IPCClient kill(FLAGS_server_address, FLAGS_server_path);
+    const char kill_cmd[32] = "kill";
+    char output[32];
+    size_t output_size = sizeof(output);
+    kill.Call(kill_cmd, strlen(kill_cmd),
+              output, &output_size, 1000);
+    server_thread_main.Join();
   } else if (FLAGS_server) {
     mozc::EchoServer con(FLAGS_server_address,
                          10, -1);
@@ -139,7 +189,8 @@ int main(int argc, char **argv) {
       cout << "Response: " << string(response, response_size) << endl;
     }
   } else {
-    LOG(INFO) << "either --server or --client or --test must be set true";
+    LOG(INFO) << "either --server or --client or --test or --benchmark "
+              << "must be set true";
   }
 
   return 0;
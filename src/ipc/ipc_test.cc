@@ -39,6 +39,9 @@
 #include "testing/base/public/gunit.h"
 
 DECLARE_string(test_tmpdir);
+#if defined(OS_LINUX) && !defined(OS_ANDROID)
+DECLARE_bool(use_shared_memory_ipc);
+#endif  // OS_LINUX && !OS_ANDROID
 
 namespace {
 
@@ -118,9 +121,8 @@ class EchoServer: public mozc::IPCServer {
     return true;
   }
 };
-}
 
-TEST(IPCTest, IPCTest) {
+void RunEchoServerTest() {
   mozc::SystemUtil::SetUserProfileDirectory(FLAGS_test_tmpdir);
 #ifdef OS_MACOSX
   mozc::TestMachPortManager manager;
@@ -165,3 +167,21 @@ TEST(IPCTest, IPCTest) {
 
   con.Wait();
 }
+}  // namespace
+
+TEST(IPCTest, IPCTest) {
+  RunEchoServerTest();
+}
+
+#if defined(OS_LINUX) && !defined(OS_ANDROID)
+TEST(IPCTest, SharedMemoryIPCTest) {
+  const uint64 num_calls = mozc::IPCClient::GetNumSharedMemoryCalls();
+  FLAGS_use_shared_memory_ipc = true;
+  RunEchoServerTest();
+  FLAGS_use_shared_memory_ipc = false;
+  // All the echo requests go through the shared memory channel instead of
+  // falling back to the socket.
+  EXPECT_LE(static_cast<uint64>(kNumThreads * kNumRequests),
+            mozc::IPCClient::GetNumSharedMemoryCalls() - num_calls);
+}
+#endif  // OS_LINUX && !OS_ANDROID
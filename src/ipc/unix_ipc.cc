@@ -36,8 +36,12 @@
 #include <fcntl.h>
 #include <libgen.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -47,9 +51,12 @@
 #include <cerrno>
 #include <cstring>
 #include <cstdlib>
+#include <map>
 
 #include "base/file_util.h"
 #include "base/logging.h"
+#include "base/mutex.h"
+#include "base/singleton.h"
 #include "base/thread.h"
 #include "ipc/ipc_path_manager.h"
 
@@ -57,12 +64,56 @@
 #define UNIX_PATH_MAX 108
 #endif  // UNIX_PATH_MAX
 
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif  // MFD_CLOEXEC
+
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif  // MFD_ALLOW_SEALING
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_GET_SEALS 1034
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif  // F_ADD_SEALS
+
+DEFINE_bool(use_shared_memory_ipc, false,
+            "Send the requests through a shared memory channel negotiated "
+            "with the server instead of connecting the socket every time.");
+
 namespace mozc {
 
 namespace {
 
 const int kInvalidSocket = -1;
 
+// Messages to negotiate a shared memory channel.  The request carries a
+// memfd and two eventfds with SCM_RIGHTS.
+const char kSharedMemoryRequest[] = "MOZC_IPC_SHARED_MEMORY_REQUEST";
+const char kSharedMemoryAccepted[] = "MOZC_IPC_SHARED_MEMORY_ACCEPTED";
+const size_t kNumSharedMemoryFds = 3;
+const int kSharedMemoryNegotiationTimeout = 1000;  // msec
+
+// Layout of the shared memory.  The request area and the response area
+// follow the header.  Only one call is in flight at a time, so each
+// direction has a single slot.
+struct SharedMemoryHeader {
+  uint32 request_size;
+  uint32 request_sequence;
+  uint32 response_size;
+  uint32 response_sequence;
+};
+
+const size_t kSharedMemorySize =
+    sizeof(SharedMemoryHeader) + IPC_REQUESTSIZE + IPC_RESPONSESIZE;
+
+// The size of the memfd is sealed before it is sent, so that the client
+// cannot shrink the memory mapped by the server and crash it with SIGBUS.
+const int kSharedMemorySeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
 void mkdir_p(const string &dirname) {
   const string parent_dir = FileUtil::Dirname(dirname);
   struct stat st;
@@ -174,10 +225,51 @@ bool SendMessage(int socket,
   return true;
 }
 
+// Same as recv(), but appends the file descriptors passed with SCM_RIGHTS
+// to |fds|.
+ssize_t RecvWithFds(int socket, char *buf, size_t buf_length,
+                    vector<int> *fds) {
+  iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = buf_length;
+  char control[CMSG_SPACE(sizeof(int) * kNumSharedMemoryFds)];
+  msghdr msg;
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  const ssize_t length = ::recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+  if (length < 0) {
+    return length;
+  }
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    const int *data = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+    const size_t num_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    fds->insert(fds->end(), data, data + num_fds);
+  }
+  return length;
+}
+
+void CloseFds(vector<int> *fds) {
+  for (size_t i = 0; i < fds->size(); ++i) {
+    ::close((*fds)[i]);
+  }
+  fds->clear();
+}
+
+// Receives the message until the peer closes the socket or |buf| is full.
+// When |fds| is not NULL, the file descriptors passed with the message are
+// stored in it.
 bool RecvMessage(int socket,
                  char *buf,
                  size_t *buf_length,
                  int timeout,
+                 vector<int> *fds,
                  IPCErrorType *last_ipc_error) {
   if (*buf_length == 0) {
     LOG(WARNING) << "buf_length is 0";
@@ -193,7 +285,9 @@ bool RecvMessage(int socket,
       *last_ipc_error = IPC_TIMEOUT_ERROR;
       return false;
     }
-    read_length = ::recv(socket, buf, buf_left, 0);
+    read_length = (fds == NULL) ?
+        ::recv(socket, buf, buf_left, 0) :
+        RecvWithFds(socket, buf, buf_left, fds);
     if (read_length < 0) {
       LOG(ERROR) << "an error occurred during recv(): " << strerror(errno);
       *buf_length = 0;
@@ -227,6 +321,459 @@ void SetCloseOnExecFlag(int fd) {
 bool IsAbstractSocket(const string& address) {
   return (!address.empty()) && (address[0] == '\0');
 }
+
+// Connects to the server at |server_address|.  Returns the socket, or
+// kInvalidSocket on failure.
+int ConnectToServer(const string &server_address, pid_t *pid) {
+  sockaddr_un address;
+  ::memset(&address, 0, sizeof(address));
+  const size_t server_address_length =
+      (server_address.size() >= UNIX_PATH_MAX) ?
+      UNIX_PATH_MAX - 1 : server_address.size();
+  if (server_address.size() >= UNIX_PATH_MAX) {
+    LOG(WARNING) << "too long path: " << server_address;
+  }
+  const int socket = ::socket(PF_UNIX, SOCK_STREAM, 0);
+  if (socket < 0) {
+    LOG(WARNING) << "socket failed: " << strerror(errno);
+    return kInvalidSocket;
+  }
+  SetCloseOnExecFlag(socket);
+  address.sun_family = AF_UNIX;
+  ::memcpy(address.sun_path, server_address.data(), server_address_length);
+  address.sun_path[server_address_length] = '\0';
+  const size_t sun_len = sizeof(address.sun_family) + server_address_length;
+  if (::connect(socket,
+                reinterpret_cast<const sockaddr*>(&address),
+                sun_len) != 0 ||
+      !IsPeerValid(socket, pid)) {
+    if ((errno == ENOTSOCK || errno == ECONNREFUSED) &&
+        !IsAbstractSocket(server_address)) {
+      // If abstract namepace is not enabled, recreate server_addresss path.
+      ::unlink(server_address.c_str());
+    }
+    LOG(WARNING) << "connect failed: " << strerror(errno);
+    ::close(socket);
+    return kInvalidSocket;
+  }
+  return socket;
+}
+
+// Sends |buf| together with |fds| by SCM_RIGHTS.
+bool SendWithFds(int socket, const char *buf, size_t buf_length,
+                 const int *fds, size_t num_fds) {
+  DCHECK_LE(num_fds, kNumSharedMemoryFds);
+  iovec iov;
+  iov.iov_base = const_cast<char *>(buf);
+  iov.iov_len = buf_length;
+  union {
+    cmsghdr header;
+    char buf[CMSG_SPACE(sizeof(int) * kNumSharedMemoryFds)];
+  } control;
+  msghdr msg;
+  ::memset(&msg, 0, sizeof(msg));
+  ::memset(&control, 0, sizeof(control));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
+  cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
+  ::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * num_fds);
+  return ::sendmsg(socket, &msg, MSG_NOSIGNAL) ==
+      static_cast<ssize_t>(buf_length);
+}
+
+int CreateMemoryFd() {
+#ifdef __NR_memfd_create
+  return static_cast<int>(
+      ::syscall(__NR_memfd_create, "mozc_ipc",
+                MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#else
+  errno = ENOSYS;
+  return -1;
+#endif  // __NR_memfd_create
+}
+
+// Maps the shared memory of |fd|.  Returns NULL on failure.
+SharedMemoryHeader *MapSharedMemory(int fd) {
+  void *ptr = ::mmap(NULL, kSharedMemorySize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+  if (ptr == MAP_FAILED) {
+    LOG(ERROR) << "mmap() failed: " << strerror(errno);
+    return NULL;
+  }
+  return static_cast<SharedMemoryHeader *>(ptr);
+}
+
+char *GetRequestArea(SharedMemoryHeader *header) {
+  return reinterpret_cast<char *>(header + 1);
+}
+
+char *GetResponseArea(SharedMemoryHeader *header) {
+  return GetRequestArea(header) + IPC_REQUESTSIZE;
+}
+
+bool NotifyEvent(int event_fd) {
+  const uint64 value = 1;
+  return ::write(event_fd, &value, sizeof(value)) == sizeof(value);
+}
+
+bool ConsumeEvent(int event_fd) {
+  uint64 value = 0;
+  return ::read(event_fd, &value, sizeof(value)) == sizeof(value);
+}
+
+// Returns true if the peer has closed |socket|.  POLLHUP is reported only
+// after both directions are shut down, i.e. the peer has closed the socket
+// after the half-close of the negotiation.
+bool IsHungUp(int socket) {
+  pollfd fd;
+  fd.fd = socket;
+  fd.events = 0;
+  fd.revents = 0;
+  return ::poll(&fd, 1, 0) != 0;
+}
+
+// The client side of a shared memory channel.  The socket used for the
+// negotiation is kept open to detect the death of the server.
+class SharedMemoryClientChannel {
+ public:
+  SharedMemoryClientChannel()
+      : socket_(kInvalidSocket), memory_fd_(-1), request_event_(-1),
+        response_event_(-1), header_(NULL), sequence_(0), server_pid_(0) {}
+
+  ~SharedMemoryClientChannel() {
+    if (header_ != NULL) {
+      ::munmap(header_, kSharedMemorySize);
+    }
+    const int fds[] = {
+      socket_, memory_fd_, request_event_, response_event_
+    };
+    for (size_t i = 0; i < arraysize(fds); ++i) {
+      if (fds[i] >= 0) {
+        ::close(fds[i]);
+      }
+    }
+  }
+
+  // Negotiates the channel over |socket| connected to the server of
+  // |server_pid|.  Takes the ownership of |socket|.  Returns false if the
+  // server does not support the channel.
+  bool Init(int socket, pid_t server_pid) {
+    socket_ = socket;
+    server_pid_ = server_pid;
+    memory_fd_ = CreateMemoryFd();
+    if (memory_fd_ < 0) {
+      LOG(WARNING) << "memfd_create() failed: " << strerror(errno);
+      return false;
+    }
+    if (::ftruncate(memory_fd_, kSharedMemorySize) != 0) {
+      LOG(WARNING) << "ftruncate() failed: " << strerror(errno);
+      return false;
+    }
+    if (::fcntl(memory_fd_, F_ADD_SEALS, kSharedMemorySeals) != 0) {
+      LOG(WARNING) << "fcntl(F_ADD_SEALS) failed: " << strerror(errno);
+      return false;
+    }
+    header_ = MapSharedMemory(memory_fd_);
+    request_event_ = ::eventfd(0, EFD_CLOEXEC);
+    response_event_ = ::eventfd(0, EFD_CLOEXEC);
+    if (header_ == NULL || request_event_ < 0 || response_event_ < 0) {
+      return false;
+    }
+
+    const int fds[] = { memory_fd_, request_event_, response_event_ };
+    if (!SendWithFds(socket_, kSharedMemoryRequest,
+                     strlen(kSharedMemoryRequest), fds, arraysize(fds))) {
+      LOG(WARNING) << "sendmsg() failed: " << strerror(errno);
+      return false;
+    }
+    // Lets the server know the end of the request as IPCClient::Call does.
+    ::shutdown(socket_, SHUT_WR);
+
+    char response[sizeof(kSharedMemoryAccepted)];
+    size_t response_size = strlen(kSharedMemoryAccepted);
+    IPCErrorType error = IPC_NO_ERROR;
+    if (!RecvMessage(socket_, response, &response_size,
+                     kSharedMemoryNegotiationTimeout, NULL, &error) ||
+        response_size != strlen(kSharedMemoryAccepted) ||
+        ::memcmp(response, kSharedMemoryAccepted, response_size) != 0) {
+      VLOG(1) << "The server does not accept the shared memory channel";
+      return false;
+    }
+    return true;
+  }
+
+  bool IsAlive() const {
+    return !IsHungUp(socket_);
+  }
+
+  pid_t server_pid() const {
+    return server_pid_;
+  }
+
+  bool Call(const char *request, size_t request_size,
+            char *response, size_t *response_size,
+            int timeout, IPCErrorType *last_ipc_error) {
+    if (request_size > IPC_REQUESTSIZE) {
+      LOG(ERROR) << "Too large request: " << request_size;
+      *last_ipc_error = IPC_WRITE_ERROR;
+      return false;
+    }
+    ::memcpy(GetRequestArea(header_), request, request_size);
+    header_->request_size = static_cast<uint32>(request_size);
+    header_->request_sequence = ++sequence_;
+    if (!NotifyEvent(request_event_)) {
+      LOG(ERROR) << "write() failed: " << strerror(errno);
+      *last_ipc_error = IPC_WRITE_ERROR;
+      return false;
+    }
+
+    while (true) {
+      pollfd fds[2];
+      fds[0].fd = response_event_;
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      fds[1].fd = socket_;
+      fds[1].events = 0;
+      fds[1].revents = 0;
+      const int result = ::poll(fds, arraysize(fds), timeout);
+      if (result < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LOG(ERROR) << "poll() failed: " << strerror(errno);
+        *last_ipc_error = IPC_READ_ERROR;
+        return false;
+      }
+      if (result == 0) {
+        LOG(WARNING) << "Read timeout " << timeout;
+        *last_ipc_error = IPC_TIMEOUT_ERROR;
+        return false;
+      }
+      if ((fds[0].revents & POLLIN) && ConsumeEvent(response_event_) &&
+          header_->response_sequence == sequence_) {
+        break;
+      }
+      if (fds[1].revents != 0) {
+        LOG(ERROR) << "The server has closed the channel";
+        *last_ipc_error = IPC_READ_ERROR;
+        return false;
+      }
+    }
+
+    // Truncates the response as RecvMessage() does.
+    *response_size = min(static_cast<size_t>(header_->response_size),
+                         *response_size);
+    ::memcpy(response, GetResponseArea(header_), *response_size);
+    return true;
+  }
+
+ private:
+  int socket_;
+  int memory_fd_;
+  int request_event_;
+  int response_event_;
+  SharedMemoryHeader *header_;
+  uint32 sequence_;
+  pid_t server_pid_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryClientChannel);
+};
+
+// The shared memory channels of this process, one for each server address.
+// Calls through the channels are serialized, as the server processes them
+// one by one anyway.
+class SharedMemoryChannelPool {
+ public:
+  SharedMemoryChannelPool() : num_calls_(0) {}
+
+  ~SharedMemoryChannelPool() {
+    for (map<string, SharedMemoryClientChannel *>::iterator it =
+             channels_.begin(); it != channels_.end(); ++it) {
+      delete it->second;
+    }
+  }
+
+  // Returns the channel to the server at |address|, negotiating a new one
+  // if necessary.  Returns false if the channel is not available.
+  bool GetChannel(IPCPathManager *manager, const string &address,
+                  pid_t *server_pid) {
+    scoped_lock l(&mutex_);
+    map<string, SharedMemoryClientChannel *>::iterator it =
+        channels_.find(address);
+    if (it != channels_.end()) {
+      if (it->second->IsAlive()) {
+        *server_pid = it->second->server_pid();
+        return true;
+      }
+      delete it->second;
+      channels_.erase(it);
+    }
+
+    // Does not try again with the server which has rejected the channel.
+    const pid_t manager_pid =
+        static_cast<pid_t>(manager->GetServerProcessId());
+    map<string, pid_t>::const_iterator rejected = rejected_.find(address);
+    if (rejected != rejected_.end() && rejected->second == manager_pid) {
+      return false;
+    }
+
+    pid_t pid = 0;
+    const int socket = ConnectToServer(address, &pid);
+    if (socket == kInvalidSocket) {
+      return false;
+    }
+    scoped_ptr<SharedMemoryClientChannel> channel(
+        new SharedMemoryClientChannel);
+    if (!channel->Init(socket, pid)) {
+      rejected_[address] = manager_pid;
+      return false;
+    }
+    *server_pid = pid;
+    channels_[address] = channel.release();
+    return true;
+  }
+
+  bool Call(const string &address,
+            const char *request, size_t request_size,
+            char *response, size_t *response_size,
+            int timeout, IPCErrorType *last_ipc_error) {
+    scoped_lock l(&mutex_);
+    map<string, SharedMemoryClientChannel *>::iterator it =
+        channels_.find(address);
+    if (it == channels_.end()) {
+      *last_ipc_error = IPC_NO_CONNECTION;
+      return false;
+    }
+    if (!it->second->Call(request, request_size, response, response_size,
+                          timeout, last_ipc_error)) {
+      // A late response could be taken for the next one, so the channel is
+      // not used any more.
+      delete it->second;
+      channels_.erase(it);
+      return false;
+    }
+    ++num_calls_;
+    return true;
+  }
+
+  uint64 num_calls() {
+    scoped_lock l(&mutex_);
+    return num_calls_;
+  }
+
+ private:
+  Mutex mutex_;
+  // The number of the calls succeeded through the channels.
+  uint64 num_calls_;
+  map<string, SharedMemoryClientChannel *> channels_;
+  // Server pid of the addresses whose server has rejected the channel.
+  map<string, pid_t> rejected_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryChannelPool);
+};
+
+// Sets |address| to the server address if a shared memory channel to
+// a valid server is available.
+bool GetSharedMemoryChannel(IPCPathManager *manager,
+                            const string &server_path,
+                            string *address) {
+  if (!manager->LoadPathName() || !manager->GetPathName(address)) {
+    return false;
+  }
+  pid_t pid = 0;
+  if (!Singleton<SharedMemoryChannelPool>::get()->GetChannel(
+          manager, *address, &pid)) {
+    return false;
+  }
+  return manager->IsValidServer(static_cast<uint32>(pid), server_path);
+}
+}  // namespace
+
+// The server side of a shared memory channel.
+class SharedMemoryServerChannel {
+ public:
+  // Takes the ownership of |socket| and |fds|, which are the memfd, the
+  // request eventfd, and the response eventfd.
+  SharedMemoryServerChannel(int socket, const vector<int> &fds)
+      : socket_(socket), fds_(fds), header_(NULL) {
+    DCHECK_EQ(kNumSharedMemoryFds, fds_.size());
+  }
+
+  ~SharedMemoryServerChannel() {
+    if (header_ != NULL) {
+      ::munmap(header_, kSharedMemorySize);
+    }
+    CloseFds(&fds_);
+    ::close(socket_);
+  }
+
+  bool Init() {
+    struct stat st;
+    if (::fstat(fds_[0], &st) != 0 ||
+        st.st_size != static_cast<off_t>(kSharedMemorySize)) {
+      LOG(ERROR) << "Invalid shared memory";
+      return false;
+    }
+    const int seals = ::fcntl(fds_[0], F_GET_SEALS);
+    if (seals < 0 ||
+        (seals & kSharedMemorySeals) != kSharedMemorySeals) {
+      LOG(ERROR) << "The size of the shared memory is not sealed";
+      return false;
+    }
+    header_ = MapSharedMemory(fds_[0]);
+    return header_ != NULL;
+  }
+
+  int socket() const {
+    return socket_;
+  }
+
+  int request_event() const {
+    return fds_[1];
+  }
+
+  // Processes the request with |server|.  Returns the result of
+  // IPCServer::Process().  The request and the response are not copied,
+  // since only the client, which has the same uid, can write to the
+  // memory.
+  bool Serve(IPCServer *server) {
+    if (!ConsumeEvent(request_event())) {
+      return true;
+    }
+    const uint32 sequence = header_->request_sequence;
+    const size_t request_size =
+        min(static_cast<size_t>(header_->request_size),
+            static_cast<size_t>(IPC_REQUESTSIZE));
+    size_t response_size = IPC_RESPONSESIZE;
+    const bool result = server->Process(GetRequestArea(header_), request_size,
+                                        GetResponseArea(header_),
+                                        &response_size);
+    header_->response_size = static_cast<uint32>(response_size);
+    header_->response_sequence = sequence;
+    NotifyEvent(fds_[2]);
+    return result;
+  }
+
+ private:
+  int socket_;
+  vector<int> fds_;
+  SharedMemoryHeader *header_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryServerChannel);
+};
+
+namespace {
+void DeleteChannels(vector<SharedMemoryServerChannel *> *channels) {
+  for (size_t i = 0; i < channels->size(); ++i) {
+    delete (*channels)[i];
+  }
+  channels->clear();
+}
 }  // namespace
 
 // Client
@@ -256,40 +803,22 @@ void IPCClient::Init(const string &name, const string &server_path) {
 
   ipc_path_manager_ = manager;
 
+  if (FLAGS_use_shared_memory_ipc &&
+      GetSharedMemoryChannel(manager, server_path, &shared_memory_address_)) {
+    last_ipc_error_ = IPC_NO_ERROR;
+    connected_ = true;
+    return;
+  }
+  shared_memory_address_.clear();
+
   for (size_t trial = 0; trial < 2; ++trial) {
     string server_address;
     if (!manager->LoadPathName() || !manager->GetPathName(&server_address)) {
       continue;
     }
-    sockaddr_un address;
-    ::memset(&address, 0, sizeof(address));
-    const size_t server_address_length =
-        (server_address.size() >= UNIX_PATH_MAX) ?
-        UNIX_PATH_MAX - 1 : server_address.size();
-    if (server_address.size() >= UNIX_PATH_MAX) {
-      LOG(WARNING) << "too long path: " << server_address;
-    }
-    socket_ = socket(PF_UNIX, SOCK_STREAM, 0);
-    if (socket_ < 0) {
-      LOG(WARNING) << "socket failed: " << strerror(errno);
-      continue;
-    }
-    SetCloseOnExecFlag(socket_);
-    address.sun_family = AF_UNIX;
-    ::memcpy(address.sun_path, server_address.data(), server_address_length);
-    address.sun_path[server_address_length] = '\0';
-    const size_t sun_len = sizeof(address.sun_family) + server_address_length;
     pid_t pid = 0;
-    if (::connect(socket_,
-                  reinterpret_cast<const sockaddr*>(&address),
-                  sun_len) != 0 ||
-        !IsPeerValid(socket_, &pid)) {
-      if ((errno == ENOTSOCK || errno == ECONNREFUSED) &&
-          !IsAbstractSocket(server_address)) {
-        // If abstract namepace is not enabled, recreate server_addresss path.
-        ::unlink(server_address.c_str());
-      }
-      LOG(WARNING) << "connect failed: " << strerror(errno);
+    socket_ = ConnectToServer(server_address, &pid);
+    if (socket_ == kInvalidSocket) {
       connected_ = false;
       manager->Clear();
       continue;
@@ -325,6 +854,12 @@ bool IPCClient::Call(const char *request_,
                      size_t *response_size,
                      int32 timeout) {
   last_ipc_error_ = IPC_NO_ERROR;
+  if (!shared_memory_address_.empty()) {
+    return Singleton<SharedMemoryChannelPool>::get()->Call(
+        shared_memory_address_, request_, input_length, response_,
+        response_size, timeout, &last_ipc_error_);
+  }
+
   if (!SendMessage(socket_, request_, input_length, timeout,
                    &last_ipc_error_)) {
     LOG(ERROR) << "SendMessage failed";
@@ -339,7 +874,7 @@ bool IPCClient::Call(const char *request_,
   // data. Will revisit later.
   ::shutdown(socket_, SHUT_WR);
 
-  if (!RecvMessage(socket_, response_, response_size, timeout,
+  if (!RecvMessage(socket_, response_, response_size, timeout, NULL,
                    &last_ipc_error_)) {
     LOG(ERROR) << "RecvMessage failed";
     return false;
@@ -352,6 +887,10 @@ bool IPCClient::Connected() const {
   return connected_;
 }
 
+uint64 IPCClient::GetNumSharedMemoryCalls() {
+  return Singleton<SharedMemoryChannelPool>::get()->num_calls();
+}
+
 // Server
 IPCServer::IPCServer(const string &name,
                      int32 num_connections,
@@ -427,6 +966,7 @@ IPCServer::~IPCServer() {
   if (server_thread_.get() != NULL) {
     server_thread_->Terminate();
   }
+  DeleteChannels(&shared_memory_channels_);
   ::shutdown(socket_, SHUT_RDWR);
   ::close(socket_);
   if (!IsAbstractSocket(server_address_)) {
@@ -447,7 +987,48 @@ void IPCServer::Loop() {
   bool error = false;
   IPCErrorType last_ipc_error = IPC_NO_ERROR;
   pid_t pid = 0;
+  vector<pollfd> poll_fds;
+  vector<int> received_fds;
   while (!error) {
+    // Waits for a new connection or a request on the shared memory
+    // channels.  The socket of a channel reports POLLHUP when the client
+    // closes it.
+    vector<SharedMemoryServerChannel *> &channels = shared_memory_channels_;
+    poll_fds.resize(1 + 2 * channels.size());
+    poll_fds[0].fd = socket_;
+    poll_fds[0].events = POLLIN;
+    for (size_t i = 0; i < channels.size(); ++i) {
+      poll_fds[1 + 2 * i].fd = channels[i]->request_event();
+      poll_fds[1 + 2 * i].events = POLLIN;
+      poll_fds[2 + 2 * i].fd = channels[i]->socket();
+      poll_fds[2 + 2 * i].events = 0;
+    }
+    for (size_t i = 0; i < poll_fds.size(); ++i) {
+      poll_fds[i].revents = 0;
+    }
+    if (::poll(&poll_fds[0], poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(FATAL) << "poll() failed: " << strerror(errno);
+      return;
+    }
+    // Iterates backward so that the erasure keeps the indices valid.
+    for (size_t i = channels.size(); i > 0; --i) {
+      if ((poll_fds[2 * i - 1].revents & POLLIN) &&
+          !channels[i - 1]->Serve(this)) {
+        LOG(WARNING) << "Process() failed";
+        error = true;
+      }
+      if (poll_fds[2 * i].revents != 0) {
+        delete channels[i - 1];
+        channels.erase(channels.begin() + i - 1);
+      }
+    }
+    if (error || !(poll_fds[0].revents & POLLIN)) {
+      continue;
+    }
+
     const int new_sock = ::accept(socket_, NULL, NULL);
     if (new_sock < 0) {
       LOG(FATAL) << "accept() failed: " << strerror(errno);
@@ -458,9 +1039,26 @@ void IPCServer::Loop() {
     }
     size_t request_size = sizeof(request_);
     size_t response_size = sizeof(response_);
-    if (RecvMessage(new_sock,
-                    &request_[0],
-                    &request_size, timeout_, &last_ipc_error)) {
+    const bool received = RecvMessage(new_sock, &request_[0], &request_size,
+                                      timeout_, &received_fds,
+                                      &last_ipc_error);
+    if (received && received_fds.size() == kNumSharedMemoryFds &&
+        request_size == strlen(kSharedMemoryRequest) &&
+        ::memcmp(&request_[0], kSharedMemoryRequest, request_size) == 0) {
+      // The channel takes the ownership of the socket and the fds.
+      scoped_ptr<SharedMemoryServerChannel> channel(
+          new SharedMemoryServerChannel(new_sock, received_fds));
+      received_fds.clear();
+      if (channel->Init() &&
+          SendMessage(new_sock, kSharedMemoryAccepted,
+                      strlen(kSharedMemoryAccepted), timeout_,
+                      &last_ipc_error)) {
+        channels.push_back(channel.release());
+      }
+      continue;
+    }
+    CloseFds(&received_fds);
+    if (received) {
       if (!Process(&request_[0], request_size,
                    &response_[0], &response_size)) {
         LOG(WARNING) << "Process() failed";
@@ -476,6 +1074,7 @@ void IPCServer::Loop() {
     ::close(new_sock);
   }
 
+  DeleteChannels(&shared_memory_channels_);
   ::shutdown(socket_, SHUT_RDWR);
   ::close(socket_);
   if (!IsAbstractSocket(server_address_)) {
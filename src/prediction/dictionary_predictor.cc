@@ -43,6 +43,9 @@
 #include "base/flags.h"
 #include "base/logging.h"
 #include "base/number_util.h"
+#include "base/singleton.h"
+#include "base/stl_util.h"
+#include "base/thread_pool.h"
 #include "base/trie.h"
 #include "base/util.h"
 #include "composer/composer.h"
@@ -61,6 +64,7 @@
 #include "prediction/suggestion_filter.h"
 #include "prediction/zero_query_number_data.h"
 #include "session/commands.pb.h"
+#include "usage_stats/usage_stats.h"
 
 // This flag is set by predictor.cc
 // We can remove this after the ambiguity expansion feature get stable.
@@ -72,6 +76,14 @@ DEFINE_bool(enable_mixed_conversion,
             false,
             "Enable mixed conversion feature");
 
+DEFINE_bool(enable_parallel_prediction,
+            false,
+            "Run the aggregations of dictionary_predictor concurrently");
+
+DEFINE_int32(parallel_prediction_threads,
+             2,
+             "The number of worker threads for the parallel prediction");
+
 DECLARE_bool(enable_typing_correction);
 
 namespace mozc {
@@ -205,21 +217,89 @@ bool DictionaryPredictor::PredictForRequest(const ConversionRequest &request,
 
   vector<Result> results;
   scoped_ptr<NodeAllocatorInterface> allocator(new NodeAllocator);
+  vector<NodeAllocatorInterface *> task_allocators;
 
-  if (!AggregatePrediction(request, segments, allocator.get(), &results)) {
-    return false;
+  bool added = false;
+  if (AggregatePrediction(request, segments, allocator.get(),
+                          &task_allocators, &results)) {
+    SetCost(request, *segments, &results);
+    RemovePrediction(request, *segments, &results);
+    added = AddPredictionToCandidates(request, segments, &results);
   }
-
-  SetCost(request, *segments, &results);
-  RemovePrediction(request, *segments, &results);
-  return AddPredictionToCandidates(request, segments, &results);
+  STLDeleteElements(&task_allocators);
+  return added;
 }
 
+namespace {
+
+// Worker threads shared by all the predictors for the parallel prediction.
+class PredictionThreadPool : public ThreadPool {
+ public:
+  PredictionThreadPool()
+      : ThreadPool(max(1, FLAGS_parallel_prediction_threads)) {}
+};
+
+}  // namespace
+
+class DictionaryPredictor::AggregationTask : public ThreadPool::Task {
+ public:
+  AggregationTask(const DictionaryPredictor *predictor,
+                  AggregateFunction function,
+                  PredictionTypes types,
+                  const ConversionRequest &request,
+                  Segments *segments,
+                  NodeAllocatorInterface *allocator,
+                  BlockingCounter *counter)
+      : predictor_(predictor),
+        function_(function),
+        types_(types),
+        request_(request),
+        segments_(segments),
+        allocator_(allocator),
+        counter_(counter),
+        skipped_(false) {}
+  virtual ~AggregationTask() {}
+
+  virtual void Run() {
+    // The task may wait for a worker longer than the latency budget.
+    if (request_.IsDeadlineExceeded()) {
+      skipped_ = true;
+    } else {
+      (predictor_->*function_)(types_, request_, segments_, allocator_,
+                               &results_);
+    }
+    counter_->DecrementCount();
+  }
+
+  const vector<Result> &results() const {
+    return results_;
+  }
+
+  bool skipped() const {
+    return skipped_;
+  }
+
+ private:
+  const DictionaryPredictor *predictor_;
+  const AggregateFunction function_;
+  const PredictionTypes types_;
+  const ConversionRequest &request_;
+  Segments *segments_;
+  NodeAllocatorInterface *allocator_;
+  BlockingCounter *counter_;
+  vector<Result> results_;
+  bool skipped_;
+
+  DISALLOW_COPY_AND_ASSIGN(AggregationTask);
+};
+
 bool DictionaryPredictor::AggregatePrediction(
     const ConversionRequest &request,
     Segments *segments, NodeAllocatorInterface *allocator,
+    vector<NodeAllocatorInterface *> *task_allocators,
     vector<Result> *results) const {
   DCHECK(segments);
+  DCHECK(task_allocators);
   DCHECK(results);
 
   const PredictionTypes prediction_types =
@@ -236,19 +316,12 @@ bool DictionaryPredictor::AggregatePrediction(
     // Therefore, we use only the realtime conversion result.
     AggregateRealtimeConversion(
         prediction_types, request, segments, allocator, results);
+  } else if (FLAGS_enable_parallel_prediction) {
+    AggregatePredictionInParallel(prediction_types, request, segments,
+                                  allocator, task_allocators, results);
   } else {
-    AggregateRealtimeConversion(prediction_types, request,
-                                segments, allocator, results);
-    AggregateUnigramPrediction(prediction_types, request, segments,
-                               allocator, results);
-    AggregateBigramPrediction(prediction_types, request, segments,
-                              allocator, results);
-    AggregateSuffixPrediction(prediction_types, request, segments,
-                              allocator, results);
-    AggregateEnglishPrediction(prediction_types, request, segments,
-                               allocator, results);
-    AggregateTypeCorrectingPrediction(prediction_types, request, segments,
-                                      allocator, results);
+    AggregatePredictionSequentially(prediction_types, request, segments,
+                                    allocator, results);
   }
 
   if (results->empty()) {
@@ -259,6 +332,105 @@ bool DictionaryPredictor::AggregatePrediction(
   }
 }
 
+void DictionaryPredictor::AggregatePredictionSequentially(
+    PredictionTypes types,
+    const ConversionRequest &request,
+    Segments *segments,
+    NodeAllocatorInterface *allocator,
+    vector<Result> *results) const {
+  static const AggregateFunction kAggregations[] = {
+    &DictionaryPredictor::AggregateRealtimeConversion,
+    &DictionaryPredictor::AggregateUnigramPrediction,
+    &DictionaryPredictor::AggregateBigramPrediction,
+    &DictionaryPredictor::AggregateSuffixPrediction,
+    &DictionaryPredictor::AggregateEnglishPrediction,
+    &DictionaryPredictor::AggregateTypeCorrectingPrediction,
+  };
+  for (size_t i = 0; i < arraysize(kAggregations); ++i) {
+    // The realtime conversion always runs, as it gives the best candidates.
+    if (i > 0 && request.IsDeadlineExceeded()) {
+      usage_stats::UsageStats::IncrementCount(
+          "SuggestionDeadlineExceededInPredictor");
+      return;
+    }
+    (this->*kAggregations[i])(types, request, segments, allocator, results);
+  }
+}
+
+void DictionaryPredictor::AggregatePredictionInParallel(
+    PredictionTypes types,
+    const ConversionRequest &request,
+    Segments *segments,
+    NodeAllocatorInterface *allocator,
+    vector<NodeAllocatorInterface *> *task_allocators,
+    vector<Result> *results) const {
+  // The aggregations run on the workers, in the order of the sequential
+  // aggregation. The realtime conversion is not listed here since it runs
+  // on the calling thread.
+  static const struct {
+    PredictionType type;
+    AggregateFunction function;
+  } kWorkerAggregations[] = {
+    { UNIGRAM, &DictionaryPredictor::AggregateUnigramPrediction },
+    { BIGRAM, &DictionaryPredictor::AggregateBigramPrediction },
+    { SUFFIX, &DictionaryPredictor::AggregateSuffixPrediction },
+    { ENGLISH, &DictionaryPredictor::AggregateEnglishPrediction },
+    { TYPING_CORRECTION,
+      &DictionaryPredictor::AggregateTypeCorrectingPrediction },
+  };
+
+  size_t num_tasks = 0;
+  for (size_t i = 0; i < arraysize(kWorkerAggregations); ++i) {
+    if (types & kWorkerAggregations[i].type) {
+      ++num_tasks;
+    }
+  }
+  if (num_tasks == 0 || !(types & REALTIME)) {
+    // Nothing to run concurrently.
+    AggregatePredictionSequentially(types, request, segments, allocator,
+                                    results);
+    return;
+  }
+
+  // The realtime conversion temporarily adds candidates to |segments|, so
+  // the workers read a copy of them. The other aggregations don't modify
+  // the segments.
+  Segments worker_segments;
+  worker_segments.CopyFrom(*segments);
+
+  // Each task has its own node allocator, since the allocators are not
+  // thread safe and the aggregations set different max_nodes_size to them.
+  BlockingCounter counter(num_tasks);
+  vector<AggregationTask *> tasks;
+  ThreadPool *pool = Singleton<PredictionThreadPool>::get();
+  for (size_t i = 0; i < arraysize(kWorkerAggregations); ++i) {
+    if (!(types & kWorkerAggregations[i].type)) {
+      continue;
+    }
+    NodeAllocatorInterface *task_allocator = new NodeAllocator;
+    task_allocators->push_back(task_allocator);
+    tasks.push_back(new AggregationTask(
+        this, kWorkerAggregations[i].function, types, request,
+        &worker_segments, task_allocator, &counter));
+    pool->Schedule(tasks.back());
+  }
+
+  AggregateRealtimeConversion(types, request, segments, allocator, results);
+  counter.Wait();
+
+  bool deadline_exceeded = false;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    results->insert(results->end(),
+                    tasks[i]->results().begin(), tasks[i]->results().end());
+    deadline_exceeded |= tasks[i]->skipped();
+  }
+  if (deadline_exceeded) {
+    usage_stats::UsageStats::IncrementCount(
+        "SuggestionDeadlineExceededInPredictor");
+  }
+  STLDeleteElements(&tasks);
+}
+
 void DictionaryPredictor::SetCost(const ConversionRequest &request,
                                   const Segments &segments,
                                   vector<Result> *results) const {
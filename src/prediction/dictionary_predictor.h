@@ -212,12 +212,46 @@ class DictionaryPredictor : public PredictorInterface {
     }
   };
 
-  // Returns false if no results were aggregated.
+  typedef void (DictionaryPredictor::*AggregateFunction)(
+      PredictionTypes types,
+      const ConversionRequest &request,
+      Segments *segments,
+      NodeAllocatorInterface *allocator,
+      vector<Result> *results) const;
+
+  // Runs an aggregation on a worker thread.
+  class AggregationTask;
+
+  // Returns false if no results were aggregated. If the parallel prediction
+  // is enabled, node allocators for the aggregations run on worker threads
+  // are appended to |task_allocators|. The caller owns them and must keep
+  // them alive while the results are used.
   bool AggregatePrediction(const ConversionRequest &request,
                            Segments *segments,
                            NodeAllocatorInterface *allocator,
+                           vector<NodeAllocatorInterface *> *task_allocators,
                            vector<Result> *results) const;
 
+  // Runs the aggregations one by one. The aggregations after the realtime
+  // conversion are skipped once the latency budget of |request| is used up.
+  void AggregatePredictionSequentially(PredictionTypes types,
+                                       const ConversionRequest &request,
+                                       Segments *segments,
+                                       NodeAllocatorInterface *allocator,
+                                       vector<Result> *results) const;
+
+  // Runs the aggregations other than the realtime conversion on the shared
+  // worker threads, while the realtime conversion runs on the calling
+  // thread. The results are merged in the same order as the sequential
+  // aggregation, so the final candidates don't depend on the scheduling.
+  void AggregatePredictionInParallel(
+      PredictionTypes types,
+      const ConversionRequest &request,
+      Segments *segments,
+      NodeAllocatorInterface *allocator,
+      vector<NodeAllocatorInterface *> *task_allocators,
+      vector<Result> *results) const;
+
   void SetCost(const ConversionRequest &request,
                const Segments &segments, vector<Result> *results) const;
 
@@ -35,6 +35,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/clock_mock.h"
 #include "base/flags.h"
 #include "base/freelist.h"
 #include "base/logging.h"
@@ -80,6 +81,7 @@ using ::testing::_;
 
 DECLARE_string(test_tmpdir);
 DECLARE_bool(enable_expansion_for_dictionary_predictor);
+DECLARE_bool(enable_parallel_prediction);
 
 namespace mozc {
 namespace {
@@ -3199,4 +3201,103 @@ TEST_F(DictionaryPredictorTest, PropagateResultCosts) {
     EXPECT_EQ(i + 1000, segment.candidate(i).cost);
   }
 }
+
+TEST_F(DictionaryPredictorTest, ParallelPrediction) {
+  config::Config config;
+  config.set_use_dictionary_suggest(true);
+  config.set_use_realtime_conversion(true);
+  config::ConfigHandler::SetConfig(config);
+
+  scoped_ptr<MockDataAndPredictor> data_and_predictor(
+      CreateDictionaryPredictorWithMockData());
+  const DictionaryPredictor *predictor =
+      data_and_predictor->dictionary_predictor();
+
+  // Runs realtime, unigram, bigram and suffix aggregations.
+  // "ぐーぐるあ" after "ぐーぐる/グーグル"
+  const char kKey[] = "\xE3\x81\x90\xE3\x83\xBC\xE3\x81\x90\xE3\x82\x8B"
+      "\xE3\x81\x82";
+  Segments sequential_segments;
+  MakeSegmentsForPrediction(kKey, &sequential_segments);
+  PrependHistorySegments("\xE3\x81\x90\xE3\x83\xBC\xE3\x81\x90\xE3\x82\x8B",
+                         "\xE3\x82\xB0\xE3\x83\xBC\xE3\x82\xB0\xE3\x83\xAB",
+                         &sequential_segments);
+  Segments parallel_segments;
+  parallel_segments.CopyFrom(sequential_segments);
+
+  const bool original_flag = FLAGS_enable_parallel_prediction;
+  FLAGS_enable_parallel_prediction = false;
+  EXPECT_TRUE(predictor->PredictForRequest(default_conversion_request(),
+                                           &sequential_segments));
+  FLAGS_enable_parallel_prediction = true;
+  EXPECT_TRUE(predictor->PredictForRequest(default_conversion_request(),
+                                           &parallel_segments));
+  FLAGS_enable_parallel_prediction = original_flag;
+
+  // The results are merged in the same order as the sequential aggregation.
+  const Segment &expected = sequential_segments.conversion_segment(0);
+  const Segment &actual = parallel_segments.conversion_segment(0);
+  ASSERT_EQ(expected.candidates_size(), actual.candidates_size());
+  EXPECT_GT(actual.candidates_size(), 0);
+  for (size_t i = 0; i < expected.candidates_size(); ++i) {
+    EXPECT_EQ(expected.candidate(i).value, actual.candidate(i).value);
+    EXPECT_EQ(expected.candidate(i).cost, actual.candidate(i).cost);
+  }
+}
+
+TEST_F(DictionaryPredictorTest, PredictionWithLatencyBudget) {
+  config::Config config;
+  config.set_use_dictionary_suggest(true);
+  config.set_use_realtime_conversion(true);
+  config::ConfigHandler::SetConfig(config);
+
+  scoped_ptr<MockDataAndPredictor> data_and_predictor(
+      CreateDictionaryPredictorWithMockData());
+  const DictionaryPredictor *predictor =
+      data_and_predictor->dictionary_predictor();
+
+  ClockMock clock(1000, 0);
+  Util::SetClockHandler(&clock);
+
+  // "ぐーぐるあ" after "ぐーぐる/グーグル"
+  const char kKey[] = "\xE3\x81\x90\xE3\x83\xBC\xE3\x81\x90\xE3\x82\x8B"
+      "\xE3\x81\x82";
+  Segments original_segments;
+  MakeSegmentsForPrediction(kKey, &original_segments);
+  PrependHistorySegments("\xE3\x81\x90\xE3\x83\xBC\xE3\x81\x90\xE3\x82\x8B",
+                         "\xE3\x82\xB0\xE3\x83\xBC\xE3\x82\xB0\xE3\x83\xAB",
+                         &original_segments);
+
+  Segments segments;
+  segments.CopyFrom(original_segments);
+  EXPECT_TRUE(predictor->PredictForRequest(default_conversion_request(),
+                                           &segments));
+  const size_t full_size = segments.conversion_segment(0).candidates_size();
+  EXPECT_GT(full_size, 1);
+
+  // Once the budget is used up, only the best realtime conversion result and
+  // its dummy candidates are returned, in both the sequential and the
+  // parallel aggregations.
+  ConversionRequest request;
+  request.set_latency_budget_msec(10);
+  clock.PutClockForwardByTicks(clock.GetFrequency());
+  EXPECT_TRUE(request.IsDeadlineExceeded());
+
+  const bool original_flag = FLAGS_enable_parallel_prediction;
+  FLAGS_enable_parallel_prediction = false;
+  segments.CopyFrom(original_segments);
+  EXPECT_TRUE(predictor->PredictForRequest(request, &segments));
+  const size_t budget_size = segments.conversion_segment(0).candidates_size();
+  EXPECT_GT(budget_size, 0);
+  EXPECT_LT(budget_size, full_size);
+
+  FLAGS_enable_parallel_prediction = true;
+  segments.CopyFrom(original_segments);
+  EXPECT_TRUE(predictor->PredictForRequest(request, &segments));
+  EXPECT_EQ(budget_size, segments.conversion_segment(0).candidates_size());
+  FLAGS_enable_parallel_prediction = original_flag;
+
+  Util::SetClockHandler(NULL);
+}
+
 }  // namespace mozc
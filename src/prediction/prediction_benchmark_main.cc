@@ -0,0 +1,155 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Benchmark of the suggestion latency of the converter on long inputs.
+// Compares the sequential aggregation of the dictionary predictor with the
+// parallel one enabled by --enable_parallel_prediction.
+//
+// Usage:
+//   prediction_benchmark_main --input=data/test/stress_test/sentences.txt
+//
+// Each line of the input is a hiragana sentence. Suggestions are requested
+// for its prefixes of --min_length characters or longer, as if the sentence
+// were typed one character at a time. Lines starting with '#' are skipped.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/file_stream.h"
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/scoped_ptr.h"
+#include "base/stopwatch.h"
+#include "base/util.h"
+#include "converter/converter_interface.h"
+#include "converter/segments.h"
+#include "engine/engine_factory.h"
+#include "engine/engine_interface.h"
+#include "engine/mock_data_engine_factory.h"
+
+DEFINE_string(input, "", "input file of hiragana sentences");
+DEFINE_string(engine, "default", "engine: (default, test)");
+DEFINE_int32(min_length, 8, "minimum length of the keys in characters");
+DEFINE_int32(max_length, 32, "maximum length of the keys in characters");
+DEFINE_int32(max_sentences, 100, "maximum number of sentences to use");
+DECLARE_bool(enable_parallel_prediction);
+
+namespace mozc {
+namespace {
+
+void LoadKeys(const string &filename, vector<string> *keys) {
+  InputFileStream ifs(filename.c_str());
+  CHECK(ifs.good()) << "cannot open: " << filename;
+  string line;
+  vector<string> chars;
+  int num_sentences = 0;
+  while (getline(ifs, line) && num_sentences < FLAGS_max_sentences) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    ++num_sentences;
+    chars.clear();
+    Util::SplitStringToUtf8Chars(line, &chars);
+    string key;
+    for (size_t i = 0;
+         i < chars.size() && i < static_cast<size_t>(FLAGS_max_length); ++i) {
+      key.append(chars[i]);
+      if (i + 1 >= static_cast<size_t>(FLAGS_min_length)) {
+        keys->push_back(key);
+      }
+    }
+  }
+}
+
+// Returns the latency of each suggestion in microseconds.
+void SuggestAll(ConverterInterface *converter, const vector<string> &keys,
+                vector<double> *latencies) {
+  latencies->clear();
+  Segments segments;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    segments.Clear();
+    Stopwatch stopwatch = Stopwatch::StartNew();
+    converter->StartSuggestion(&segments, keys[i]);
+    stopwatch.Stop();
+    latencies->push_back(stopwatch.GetElapsedMicroseconds());
+  }
+}
+
+void PrintStats(const string &name, vector<double> *latencies) {
+  CHECK(!latencies->empty());
+  sort(latencies->begin(), latencies->end());
+  double total = 0.0;
+  for (size_t i = 0; i < latencies->size(); ++i) {
+    total += (*latencies)[i];
+  }
+  const size_t size = latencies->size();
+  cout << name << ": "
+       << "avg " << total / size << " usec, "
+       << "p50 " << (*latencies)[size / 2] << " usec, "
+       << "p99 " << (*latencies)[size * 99 / 100] << " usec, "
+       << "max " << latencies->back() << " usec" << endl;
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  vector<string> keys;
+  mozc::LoadKeys(FLAGS_input, &keys);
+  cout << "keys: " << keys.size() << endl;
+  CHECK(!keys.empty());
+
+  scoped_ptr<mozc::EngineInterface> engine;
+  if (FLAGS_engine == "default") {
+    engine.reset(mozc::EngineFactory::Create());
+  } else if (FLAGS_engine == "test") {
+    engine.reset(mozc::MockDataEngineFactory::Create());
+  }
+  CHECK(engine.get()) << "Invalid engine: " << FLAGS_engine;
+  mozc::ConverterInterface *converter = engine->GetConverter();
+  CHECK(converter);
+
+  vector<double> latencies;
+  // Warms up the dictionaries and the caches before measuring.
+  mozc::SuggestAll(converter, keys, &latencies);
+
+  FLAGS_enable_parallel_prediction = false;
+  mozc::SuggestAll(converter, keys, &latencies);
+  mozc::PrintStats("sequential", &latencies);
+
+  FLAGS_enable_parallel_prediction = true;
+  mozc::SuggestAll(converter, keys, &latencies);
+  mozc::PrintStats("parallel", &latencies);
+  return 0;
+}
@@ -77,6 +77,20 @@
         }],
       ],
     },
+    {
+      'target_name': 'prediction_benchmark_main',
+      'type': 'executable',
+      'sources': [
+        'prediction_benchmark_main.cc',
+      ],
+      'dependencies': [
+        '../converter/converter_base.gyp:segments',
+        '../engine/engine.gyp:engine',
+        '../engine/engine.gyp:engine_factory',
+        '../engine/engine.gyp:mock_data_engine_factory',
+        'prediction.gyp:prediction',
+      ],
+    },
     # Test cases meta target: this target is referred from gyp/tests.gyp
     {
       'target_name': 'prediction_all_test',
@@ -131,6 +131,10 @@ bool BasePredictor::Reload() {
   return user_history_predictor_->Reload();
 }
 
+bool BasePredictor::TrimMemory() {
+  return user_history_predictor_->TrimMemory();
+}
+
 // static
 PredictorInterface *DefaultPredictor::CreateDefaultPredictor(
     PredictorInterface *dictionary_predictor,
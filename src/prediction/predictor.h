@@ -72,6 +72,9 @@ class BasePredictor : public PredictorInterface {
   // Reloads usre history.
   virtual bool Reload();
 
+  // Releases user history until it is used next time.
+  virtual bool TrimMemory();
+
   // Waits for syncer to complete.
   virtual bool WaitForSyncerForTest();
 
@@ -72,6 +72,10 @@ class PredictorInterface {
   // Reloads user history data from local disk.
   virtual bool Reload() { return true; }
 
+  // Releases the user history data which can be reloaded from local disk.
+  // The data is reloaded on demand.  Returns true if anything was released.
+  virtual bool TrimMemory() { return false; }
+
   // Waits for syncer thread to complete.
   virtual bool WaitForSyncerForTest() { return true; }
 
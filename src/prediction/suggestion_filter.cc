@@ -33,6 +33,22 @@
 #include "storage/existence_filter.h"
 
 namespace mozc {
+namespace {
+
+// Returns true if |text| may contain a character that Util::LowerString
+// rewrites, i.e., 'A'-'Z' or a full-width form (U+FFxx, 0xEF lead byte in
+// UTF-8) that includes 'Ａ'-'Ｚ'.
+bool MayContainUpperCase(const string &text) {
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (('A' <= c && c <= 'Z') || static_cast<uint8>(c) == 0xEF) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
 
 SuggestionFilter::SuggestionFilter(const char *data, size_t size) {
   filter_.reset(mozc::storage::ExistenceFilter::Read(data, size));
@@ -46,6 +62,11 @@ bool SuggestionFilter::IsBadSuggestion(const string &text) const {
   if (filter_.get() == NULL) {
     return false;
   }
+  // Most of the candidates are free of upper case letters. Skips copying
+  // them as this is called for every node of every suggestion candidate.
+  if (!MayContainUpperCase(text)) {
+    return filter_->Exists(Util::Fingerprint(text.data(), text.size()));
+  }
   string lower_text = text;
   Util::LowerString(&lower_text);
   return filter_->Exists(Util::Fingerprint(lower_text.data(),
@@ -35,10 +35,11 @@
 #include <string>
 
 #include "base/config_file_stream.h"
+#include "base/executor.h"
 #include "base/flags.h"
 #include "base/init.h"
 #include "base/logging.h"
-#include "base/thread.h"
+#include "base/startup_trace.h"
 #include "base/trie.h"
 #include "base/util.h"
 #include "composer/composer.h"
@@ -341,7 +342,7 @@ UserHistoryPredictor::EntryPriorityQueue::NewEntry() {
   return pool_.Alloc();
 }
 
-class UserHistoryPredictorSyncer : public Thread {
+class UserHistoryPredictorSyncer : public BackgroundTask {
  public:
   enum RequestType {
     LOAD,
@@ -350,7 +351,9 @@ class UserHistoryPredictorSyncer : public Thread {
 
   UserHistoryPredictorSyncer(UserHistoryPredictor *predictor,
                              RequestType type)
-      : predictor_(predictor), type_(type) {
+      : BackgroundTask("UserHistoryPredictorSyncer",
+                       type == LOAD ? Executor::HIGH : Executor::NORMAL),
+        predictor_(predictor), type_(type) {
     DCHECK(predictor_);
   }
 
@@ -386,6 +389,7 @@ UserHistoryPredictor::UserHistoryPredictor(
       suppression_dictionary_(suppression_dictionary),
       predictor_name_("UserHistoryPredictor"),
       updated_(false),
+      trimmed_(false),
       dic_(new DicCache(UserHistoryPredictor::cache_size())) {
   AsyncLoad();  // non-blocking
   // Load()  blocking version can be used if any
@@ -438,9 +442,50 @@ bool UserHistoryPredictor::Sync() {
 
 bool UserHistoryPredictor::Reload() {
   WaitForSyncer();
+  trimmed_ = false;
   return AsyncLoad();
 }
 
+bool UserHistoryPredictor::TrimMemory() {
+  WaitForSyncer();
+  if (trimmed_) {
+    return false;
+  }
+
+  // Save() keeps |updated_| when the history cannot be written, e.g., in the
+  // incognito mode.  Such history would be lost, so it is not released.
+  if (!Save() || updated_) {
+    return false;
+  }
+
+  VLOG(1) << "Releasing user history";
+  // Recreates DicCache to release the blocks kept by its FreeList.
+  dic_.reset(new DicCache(UserHistoryPredictor::cache_size()));
+  trimmed_ = true;
+  return true;
+}
+
+void UserHistoryPredictor::AsyncLoadIfTrimmed() const {
+  if (!trimmed_) {
+    return;
+  }
+  trimmed_ = false;
+  // Loading the history is a logically const operation for the callers,
+  // as the history was there before TrimMemory().
+  UserHistoryPredictor *self = const_cast<UserHistoryPredictor *>(this);
+  self->WaitForSyncer();
+  self->AsyncLoad();
+}
+
+void UserHistoryPredictor::LoadIfTrimmed() {
+  if (!trimmed_) {
+    return;
+  }
+  trimmed_ = false;
+  WaitForSyncer();
+  Load();
+}
+
 bool UserHistoryPredictor::AsyncLoad() {
   if (!CheckSyncerAndDelete()) {  // now loading/saving
     return true;
@@ -472,6 +517,7 @@ bool UserHistoryPredictor::AsyncSave() {
 }
 
 bool UserHistoryPredictor::Load() {
+  ScopedStartupTrace trace("UserHistoryPredictor::Load");
   const string filename = GetUserHistoryFileName();
 
   UserHistoryStorage history(filename);
@@ -540,6 +586,7 @@ bool UserHistoryPredictor::ClearAllHistory() {
   // renew DicCache as LRUCache tries to reuse the internal value by
   // using FreeList
   dic_.reset(new DicCache(UserHistoryPredictor::cache_size()));
+  trimmed_ = false;
 
   // insert a dummy event entry.
   InsertEvent(Entry::CLEAN_ALL_EVENT);
@@ -554,6 +601,7 @@ bool UserHistoryPredictor::ClearAllHistory() {
 bool UserHistoryPredictor::ClearUnusedHistory() {
   // Wait until syncer finishes
   WaitForSyncer();
+  LoadIfTrimmed();
 
   VLOG(1) << "Clearing unused prediction";
   const DicElement *head = dic_->Head();
@@ -693,6 +741,7 @@ UserHistoryPredictor::RemoveNgramChain(const string &target_key,
 
 bool UserHistoryPredictor::ClearHistoryEntry(const string &key,
                                              const string &value) {
+  LoadIfTrimmed();
   bool deleted = false;
   {
     // Find the history entry that has the exactly same key and value and has
@@ -1137,6 +1186,7 @@ bool UserHistoryPredictor::Predict(Segments *segments) const {
 
 bool UserHistoryPredictor::PredictForRequest(const ConversionRequest &request,
                                              Segments *segments) const {
+  AsyncLoadIfTrimmed();
   if (!CheckSyncerAndDelete()) {
     LOG(WARNING) << "Syncer is running";
     return false;
@@ -1613,6 +1663,7 @@ void UserHistoryPredictor::Finish(Segments *segments) {
     return;
   }
 
+  LoadIfTrimmed();
   if (!CheckSyncerAndDelete()) {
     LOG(WARNING) << "Syncer is running";
     return;
@@ -1813,6 +1864,7 @@ void UserHistoryPredictor::InsertHistory(bool is_suggestion_selected,
 }
 
 void UserHistoryPredictor::Revert(Segments *segments) {
+  LoadIfTrimmed();
   if (!CheckSyncerAndDelete()) {
     LOG(WARNING) << "Syncer is running";
     return;
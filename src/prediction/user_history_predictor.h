@@ -115,6 +115,11 @@ class UserHistoryPredictor : public PredictorInterface {
   // Clears a specific history entry.
   virtual bool ClearHistoryEntry(const string &key, const string &value);
 
+  // Saves the history and releases the LRU.  The history is reloaded
+  // when it is used next time.  Does nothing if the history cannot be
+  // saved, e.g., in the incognito mode.
+  virtual bool TrimMemory();
+
   // Implements PredictorInterface.
   virtual bool WaitForSyncerForTest();
 
@@ -220,6 +225,7 @@ class UserHistoryPredictor : public PredictorInterface {
   FRIEND_TEST(UserHistoryPredictorTest, Regression2843775);
   FRIEND_TEST(UserHistoryPredictorTest, DuplicateString);
   FRIEND_TEST(UserHistoryPredictorTest, SyncTest);
+  FRIEND_TEST(UserHistoryPredictorTest, TrimMemoryTest);
   FRIEND_TEST(UserHistoryPredictorTest, GetMatchTypeTest);
   FRIEND_TEST(UserHistoryPredictorTest, FingerPrintTest);
   FRIEND_TEST(UserHistoryPredictorTest, Uint32ToStringTest);
@@ -371,6 +377,14 @@ class UserHistoryPredictor : public PredictorInterface {
 
   bool CheckSyncerAndDelete() const;
 
+  // Reloads the history released by TrimMemory() in the background.  The
+  // history is not available until the loading finishes, as is the case
+  // at start-up.
+  void AsyncLoadIfTrimmed() const;
+
+  // Blocking version of AsyncLoadIfTrimmed().
+  void LoadIfTrimmed();
+
   // If |entry| is the target of prediction,
   // create a new result and insert it to |results|.
   // Can set |prev_entry| if there is a history segment just before |input_key|.
@@ -490,6 +504,8 @@ class UserHistoryPredictor : public PredictorInterface {
   const string predictor_name_;
 
   bool updated_;
+  // True while the LRU is released by TrimMemory().
+  mutable bool trimmed_;
   scoped_ptr<DicCache> dic_;
   mutable scoped_ptr<UserHistoryPredictorSyncer> syncer_;
 };
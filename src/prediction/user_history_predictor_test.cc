@@ -1942,6 +1942,70 @@ TEST_F(UserHistoryPredictorTest, SyncTest) {
   }
 }
 
+TEST_F(UserHistoryPredictorTest, TrimMemoryTest) {
+  UserHistoryPredictor *predictor =
+      GetUserHistoryPredictorWithClearedHistory();
+
+  // "わたしのなまえはなかのです"
+  const char kKey1[] =
+      "\xE3\x82\x8F\xE3\x81\x9F\xE3\x81\x97\xE3\x81\xAE"
+      "\xE3\x81\xAA\xE3\x81\xBE\xE3\x81\x88\xE3\x81\xAF"
+      "\xE3\x81\xAA\xE3\x81\x8B\xE3\x81\xAE\xE3\x81\xA7"
+      "\xE3\x81\x99";
+  // "私の名前は中野です"
+  const char kValue1[] =
+      "\xE7\xA7\x81\xE3\x81\xAE\xE5\x90\x8D\xE5\x89\x8D"
+      "\xE3\x81\xAF\xE4\xB8\xAD\xE9\x87\x8E\xE3\x81\xA7"
+      "\xE3\x81\x99";
+  // "わたしの"
+  const char kPrefix1[] = "\xE3\x82\x8F\xE3\x81\x9F\xE3\x81\x97\xE3\x81\xAE";
+  // "てんきがいい"
+  const char kKey2[] =
+      "\xE3\x81\xA6\xE3\x82\x93\xE3\x81\x8D\xE3\x81\x8C"
+      "\xE3\x81\x84\xE3\x81\x84";
+  // "天気がいい"
+  const char kValue2[] =
+      "\xE5\xA4\xA9\xE6\xB0\x97\xE3\x81\x8C\xE3\x81\x84\xE3\x81\x84";
+  // "てんき"
+  const char kPrefix2[] = "\xE3\x81\xA6\xE3\x82\x93\xE3\x81\x8D";
+
+  Segments segments;
+  MakeSegmentsForConversion(kKey1, &segments);
+  AddCandidate(kValue1, &segments);
+  predictor->Finish(&segments);
+  EXPECT_TRUE(IsSuggested(predictor, kPrefix1, kValue1));
+
+  // The history is saved and released.
+  EXPECT_TRUE(predictor->TrimMemory());
+  EXPECT_TRUE(predictor->dic_->Head() == NULL);
+  EXPECT_FALSE(predictor->TrimMemory());
+
+  // The first prediction starts reloading, and the history is available
+  // after the loading finishes.
+  IsSuggested(predictor, kPrefix1, kValue1);
+  predictor->WaitForSyncer();
+  EXPECT_TRUE(IsSuggested(predictor, kPrefix1, kValue1));
+
+  // Finish() reloads the history synchronously not to lose the new entry.
+  EXPECT_TRUE(predictor->TrimMemory());
+  segments.Clear();
+  MakeSegmentsForConversion(kKey2, &segments);
+  AddCandidate(kValue2, &segments);
+  predictor->Finish(&segments);
+  EXPECT_TRUE(IsSuggested(predictor, kPrefix1, kValue1));
+  EXPECT_TRUE(IsSuggested(predictor, kPrefix2, kValue2));
+
+  // The history is kept when it cannot be saved.
+  {
+    config::Config config;
+    config::ConfigHandler::GetConfig(&config);
+    config.set_use_history_suggest(false);
+    config::ConfigHandler::SetConfig(config);
+  }
+  EXPECT_FALSE(predictor->TrimMemory());
+  EXPECT_TRUE(predictor->dic_->Head() != NULL);
+}
+
 TEST_F(UserHistoryPredictorTest, GetMatchTypeTest) {
   EXPECT_EQ(UserHistoryPredictor::NO_MATCH,
             UserHistoryPredictor::GetMatchType("test", ""));
@@ -228,15 +228,22 @@ class RendererLauncher : public RendererLauncherInterface,
     }
   }
 
-  void SetPendingCommand(const commands::RendererCommand &command) {
+  bool SetPendingCommand(commands::RendererCommand *command) {
     // ignore NOOP|SHUTDOWN
-    if (command.type() == commands::RendererCommand::UPDATE) {
-      scoped_lock l(&pending_command_mutex_);
-      if (pending_command_.get() == NULL) {
-        pending_command_.reset(new commands::RendererCommand);
-      }
-      pending_command_->CopyFrom(command);
+    if (command->type() != commands::RendererCommand::UPDATE) {
+      return false;
+    }
+    scoped_lock l(&pending_command_mutex_);
+    // The pending command has been flushed, so the caller has to send
+    // |command| by itself.
+    if (renderer_status_ == RendererLauncher::RENDERER_READY) {
+      return false;
+    }
+    if (pending_command_.get() == NULL) {
+      pending_command_.reset(new commands::RendererCommand);
     }
+    pending_command_->Swap(command);
+    return true;
   }
 
   void set_suppress_error_dialog(bool suppress) {
@@ -406,6 +413,23 @@ void RendererClient::set_suppress_error_dialog(bool suppress) {
 }
 
 bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
+  // The renderer draws the candidate window from Output::candidates and
+  // never reads Output::all_candidate_words, which holds every candidate of
+  // the focused segment. The client expands it from the incremental updates
+  // of the server for its own use, and it is dropped here so that the
+  // renderer IPC is bounded by the page size of the candidate window.
+  if (command.output().has_all_candidate_words()) {
+    commands::RendererCommand renderer_command;
+    renderer_command.CopyFrom(command);
+    renderer_command.mutable_output()->clear_all_candidate_words();
+    return ExecCommandInternal(renderer_command, &renderer_command);
+  }
+  return ExecCommandInternal(command, NULL);
+}
+
+bool RendererClient::ExecCommandInternal(
+    const commands::RendererCommand &command,
+    commands::RendererCommand *owned_command) {
   if (renderer_launcher_interface_ == NULL) {
     LOG(ERROR) << "RendererLauncher is NULL";
     return false;
@@ -417,7 +441,9 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
   }
 
   if (!renderer_launcher_interface_->CanConnect()) {
-    renderer_launcher_interface_->SetPendingCommand(command);
+    if (SetPendingCommand(command, owned_command)) {
+      return true;
+    }
     // Check CanConnect() again, as the status might be changed
     // after SetPendingCommand().
     if (!renderer_launcher_interface_->CanConnect()) {
@@ -454,10 +480,12 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
       return true;
     }
     LOG(WARNING) << "cannot connect to renderer. restarting";
-    renderer_launcher_interface_->SetPendingCommand(command);
+    // StartRenderer() is called first so that the launcher does not take
+    // the renderer for ready.
     renderer_launcher_interface_->StartRenderer(name_, renderer_path_,
                                                 disable_renderer_path_check_,
                                                 ipc_client_factory_interface_);
+    SetPendingCommand(command, owned_command);
     return true;
   }
 
@@ -469,7 +497,7 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
       LOG(ERROR) << "ForceTerminateServer failed";
     }
     ++version_mismatch_nums_;
-    renderer_launcher_interface_->SetPendingCommand(command);
+    SetPendingCommand(command, owned_command);
     return true;
   } else if (IPC_PROTOCOL_VERSION < client->GetServerProtocolVersion()) {
     version_mismatch_nums_ = INT_MAX;
@@ -485,7 +513,7 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
     LOG(WARNING) << "Version mismatch: "
                  << client->GetServerProductVersion() << " "
                  << Version::GetMozcVersion();
-    renderer_launcher_interface_->SetPendingCommand(command);
+    SetPendingCommand(command, owned_command);
     commands::RendererCommand shutdown_command;
     shutdown_command.set_type(commands::RendererCommand::SHUTDOWN);
     CallCommand(client.get(), shutdown_command);
@@ -498,6 +526,17 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
   return true;
 }
 
+bool RendererClient::SetPendingCommand(
+    const commands::RendererCommand &command,
+    commands::RendererCommand *owned_command) {
+  if (owned_command != NULL) {
+    return renderer_launcher_interface_->SetPendingCommand(owned_command);
+  }
+  commands::RendererCommand pending_command;
+  pending_command.CopyFrom(command);
+  return renderer_launcher_interface_->SetPendingCommand(&pending_command);
+}
+
 IPCClientInterface *RendererClient::CreateIPCClient() const {
   if (ipc_client_factory_interface_ == NULL) {
     return NULL;
@@ -70,9 +70,10 @@ class RendererLauncherInterface {
   virtual bool CanConnect() const = 0;
 
   // |command| is sent to the server just after
-  // renderer is launched.
-  virtual void SetPendingCommand(
-      const commands::RendererCommand &command) = 0;
+  // renderer is launched.  The content of |command| is taken with Swap()
+  // instead of being copied.  Returns false and leaves |command| as is if
+  // it is not an UPDATE or the renderer is already ready.
+  virtual bool SetPendingCommand(commands::RendererCommand *command) = 0;
 
   // Sets the flag of error dialog suppression.
   virtual void set_suppress_error_dialog(bool suppress) = 0;
@@ -126,6 +127,14 @@ class RendererClient : public RendererInterface {
  private:
   IPCClientInterface *CreateIPCClient() const;
 
+  // |owned_command| is the same object as |command| if this instance owns
+  // it, or NULL.  An owned command is handed to the launcher without being
+  // copied.
+  bool ExecCommandInternal(const commands::RendererCommand &command,
+                           commands::RendererCommand *owned_command);
+  bool SetPendingCommand(const commands::RendererCommand &command,
+                         commands::RendererCommand *owned_command);
+
   bool is_window_visible_;
   bool disable_renderer_path_check_;
   int  version_mismatch_nums_;
@@ -59,6 +59,7 @@ const string UpdateVersion(int diff) {
 }
 
 int g_counter = 0;
+string g_last_request;
 bool g_connected = false;
 uint32 g_server_protocol_version = IPC_PROTOCOL_VERSION;
 string g_server_product_version;
@@ -94,6 +95,7 @@ class TestIPCClient : public IPCClientInterface {
                     size_t *response_size,
                     int32 timeout) {
     g_counter++;
+    g_last_request.assign(request, request_size);
     return true;
   }
 
@@ -103,12 +105,17 @@ class TestIPCClient : public IPCClientInterface {
 
   static void Reset() {
     g_counter = 0;
+    g_last_request.clear();
   }
 
   static int counter() {
     return g_counter;
   }
 
+  static const string &last_request() {
+    return g_last_request;
+  }
+
   static void set_server_protocol_version(uint32 version) {
     g_server_protocol_version = version;
   }
@@ -170,9 +177,13 @@ class TestRendererLauncher : public RendererLauncherInterface {
     return can_connect_;
   }
 
-  virtual void SetPendingCommand(
-      const commands::RendererCommand &command) {
+  virtual bool SetPendingCommand(commands::RendererCommand *command) {
     set_pending_command_called_ = true;
+    if (command->type() != commands::RendererCommand::UPDATE) {
+      return false;
+    }
+    pending_command_.Swap(command);
+    return true;
   }
 
   virtual void set_suppress_error_dialog(bool suppress) {
@@ -184,6 +195,7 @@ class TestRendererLauncher : public RendererLauncherInterface {
     available_ = false;
     can_connect_ = false;
     set_pending_command_called_ = false;
+    pending_command_.Clear();
   }
 
   void set_available(bool available) {
@@ -206,12 +218,17 @@ class TestRendererLauncher : public RendererLauncherInterface {
     return set_pending_command_called_;
   }
 
+  const commands::RendererCommand &pending_command() const {
+    return pending_command_;
+  }
+
  private:
   bool start_renderer_called_;
   bool force_terminate_renderer_called_;
   bool available_;
   bool can_connect_;
   bool set_pending_command_called_;
+  commands::RendererCommand pending_command_;
 };
 }  // namespace
 
@@ -394,6 +411,44 @@ TEST(RendererClient, ConnectionTest) {
   }
 }
 
+TEST(RendererClient, AllCandidateWordsAreNotSentTest) {
+  TestIPCClientFactory factory;
+  TestRendererLauncher launcher;
+
+  RendererClient client;
+
+  client.SetIPCClientFactory(&factory);
+  client.SetRendererLauncherInterface(&launcher);
+
+  launcher.set_available(true);
+  launcher.set_can_connect(true);
+  TestIPCClient::set_connected(true);
+  TestIPCClient::Reset();
+
+  commands::RendererCommand command;
+  command.set_type(commands::RendererCommand::UPDATE);
+  commands::Output *output = command.mutable_output();
+  output->mutable_candidates()->set_size(100);
+  output->mutable_candidates()->set_position(0);
+  commands::CandidateList *all_candidate_words =
+      output->mutable_all_candidate_words();
+  for (int i = 0; i < 100; ++i) {
+    all_candidate_words->add_candidates()->set_id(i);
+  }
+
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_EQ(1, TestIPCClient::counter());
+
+  commands::RendererCommand sent_command;
+  EXPECT_TRUE(sent_command.ParseFromString(TestIPCClient::last_request()));
+  EXPECT_TRUE(sent_command.has_output());
+  EXPECT_FALSE(sent_command.output().has_all_candidate_words());
+  EXPECT_EQ(100, sent_command.output().candidates().size());
+
+  // The caller's command is left untouched.
+  EXPECT_EQ(100, command.output().all_candidate_words().candidates_size());
+}
+
 TEST(RendererClient, ShutdownTest) {
   TestIPCClientFactory factory;
   TestRendererLauncher launcher;
@@ -588,5 +643,42 @@ TEST(RendererClient, SetPendingCommandTest) {
     EXPECT_FALSE(launcher.is_set_pending_command_called());
   }
 }
+
+TEST(RendererClient, PendingCommandIsTakenWithoutCopy) {
+  TestIPCClientFactory factory;
+  TestRendererLauncher launcher;
+
+  RendererClient client;
+
+  client.SetIPCClientFactory(&factory);
+  client.SetRendererLauncherInterface(&launcher);
+
+  commands::RendererCommand command;
+  command.set_type(commands::RendererCommand::UPDATE);
+  command.set_visible(true);
+  commands::Output *output = command.mutable_output();
+  output->mutable_candidates()->set_size(1);
+  output->mutable_all_candidate_words()->set_focused_index(0);
+
+  launcher.Reset();
+  launcher.set_can_connect(false);
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_TRUE(launcher.is_set_pending_command_called());
+  // The launcher takes the command without all_candidate_words.
+  EXPECT_TRUE(launcher.pending_command().visible());
+  EXPECT_TRUE(launcher.pending_command().output().has_candidates());
+  EXPECT_FALSE(launcher.pending_command().output().has_all_candidate_words());
+  // The command of the caller is not modified.
+  EXPECT_TRUE(command.output().has_all_candidate_words());
+
+  // A command without all_candidate_words is copied, as it is owned by the
+  // caller.
+  command.mutable_output()->clear_all_candidate_words();
+  launcher.Reset();
+  launcher.set_can_connect(false);
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_TRUE(launcher.pending_command().output().has_candidates());
+  EXPECT_TRUE(command.output().has_candidates());
+}
 }  // namespace renderer
 }  // namespace mozc
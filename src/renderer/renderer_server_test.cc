@@ -123,7 +123,8 @@ class DummyRendererLauncher : public RendererLauncherInterface {
     return true;
   }
 
-  virtual void SetPendingCommand(const commands::RendererCommand &command) {
+  virtual bool SetPendingCommand(commands::RendererCommand *command) {
+    return false;
   }
 
   virtual void set_suppress_error_dialog(bool suppress) {
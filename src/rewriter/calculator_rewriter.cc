@@ -40,6 +40,7 @@
 #include "converter/converter_interface.h"
 #include "converter/segments.h"
 #include "rewriter/calculator/calculator_interface.h"
+#include "rewriter/rewrite_trigger.h"
 
 namespace mozc {
 
@@ -51,6 +52,11 @@ CalculatorRewriter::CalculatorRewriter(
 
 CalculatorRewriter::~CalculatorRewriter() {}
 
+bool CalculatorRewriter::MayRewrite(const RewriteTrigger &trigger) const {
+  // An expression contains at least one number.
+  return trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY);
+}
+
 // Rewrites candidates when conversion segments of |segments| represents an
 // expression that can be calculated. In such case, if |segments| consists
 // of multiple segments, it merges them by calling ConverterInterface::
@@ -52,6 +52,7 @@
 #include "config/config_handler.h"
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
+#include "rewriter/rewrite_trigger.h"
 #include "session/commands.pb.h"
 
 namespace mozc {
@@ -2418,6 +2419,13 @@ bool DateRewriter::RewriteFourDigits(const composer::Composer &composer,
 DateRewriter::DateRewriter() {}
 DateRewriter::~DateRewriter() {}
 
+bool DateRewriter::MayRewrite(const RewriteTrigger &trigger) const {
+  // Date and time entries have hiragana keys like "きょう", and the other
+  // conversions are triggered by numbers.
+  return trigger.HasKeyCharType(RewriteTrigger::HIRAGANA_KEY |
+                                RewriteTrigger::NUMBER_KEY);
+}
+
 int DateRewriter::capability(const ConversionRequest &request) const {
   if (request.request().mixed_conversion()) {
     return RewriterInterface::ALL;
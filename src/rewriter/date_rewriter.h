@@ -55,6 +55,8 @@ class DateRewriter : public RewriterInterface  {
 
   virtual int capability(const ConversionRequest &request) const;
 
+  virtual bool MayRewrite(const RewriteTrigger &trigger) const;
+
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const;
 
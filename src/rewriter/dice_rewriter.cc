@@ -36,6 +36,7 @@
 #include "base/util.h"
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
+#include "rewriter/rewrite_trigger.h"
 #include "rewriter/rewriter_interface.h"
 
 namespace mozc {
@@ -89,6 +90,12 @@ DiceRewriter::DiceRewriter() {}
 
 DiceRewriter::~DiceRewriter() {}
 
+bool DiceRewriter::MayRewrite(const RewriteTrigger &trigger) const {
+  // "さいころ" is a single segment of hiragana.
+  return trigger.conversion_segments_size() == 1 &&
+      trigger.KeyCharTypesAreOnly(RewriteTrigger::HIRAGANA_KEY);
+}
+
 bool DiceRewriter::Rewrite(const ConversionRequest &request,
                            Segments *segments) const {
   if (segments->conversion_segments_size() != 1) {
@@ -52,18 +52,22 @@ struct CompilerToken {
   int16 cost;
 };
 
-struct TokenCompare {
-  bool operator()(const EmbeddedDictionary::Token &s1,
-                  const EmbeddedDictionary::Token &s2) {
-    return (strcmp(s1.key, s2.key) < 0);
-  }
-};
-
 struct CompareByCost {
   bool operator()(const CompilerToken &t1, const CompilerToken &t2) {
     return (t1.cost < t2.cost);
   }
 };
+
+inline uint32 HashKey(StringPiece key) {
+  return Util::Fingerprint32(key.data(), key.size());
+}
+
+// Returns true if the null-terminated |token_key| equals |key|. The lengths
+// are compared first since |key| may contain null characters.
+inline bool KeyEquals(const char *token_key, StringPiece key) {
+  return strlen(token_key) == key.size() &&
+      memcmp(token_key, key.data(), key.size()) == 0;
+}
 }  // namespace
 
 EmbeddedDictionary::EmbeddedDictionary(const EmbeddedDictionary::Token *token,
@@ -71,23 +75,37 @@ EmbeddedDictionary::EmbeddedDictionary(const EmbeddedDictionary::Token *token,
     : token_(token), size_(size) {
   CHECK(token_);
   CHECK_GT(size_, 0);
+
+  // The token table is shared by all the data managers and the packed data,
+  // so the hash index is built here instead of being compiled into the table.
+  size_t index_size = 1;
+  while (index_size < size_ * 2) {
+    index_size *= 2;
+  }
+  index_.resize(index_size, 0);
+  const size_t mask = index_size - 1;
+  for (size_t i = 0; i < size_; ++i) {
+    size_t slot = HashKey(token_[i].key) & mask;
+    while (index_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    index_[slot] = static_cast<uint32>(i + 1);
+  }
 }
 
 EmbeddedDictionary::~EmbeddedDictionary() {}
 
-// do binary-search
 const EmbeddedDictionary::Token*
-EmbeddedDictionary::Lookup(const string &key) const {
-  Token key_token;
-  key_token.key = key.c_str();
-  key_token.value = NULL;
-  key_token.value_size = 0;
-  const Token *result = lower_bound(token_, token_ + size_,
-                                    key_token, TokenCompare());
-  if (result == (token_ + size_) || key != result->key) {
-    return NULL;
+EmbeddedDictionary::Lookup(StringPiece key) const {
+  const size_t mask = index_.size() - 1;
+  for (size_t slot = HashKey(key) & mask; index_[slot] != 0;
+       slot = (slot + 1) & mask) {
+    const Token *token = token_ + (index_[slot] - 1);
+    if (KeyEquals(token->key, key)) {
+      return token;
+    }
   }
-  return result;
+  return NULL;
 }
 
 const EmbeddedDictionary::Token *
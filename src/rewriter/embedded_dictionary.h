@@ -31,7 +31,9 @@
 #define MOZC_REWRITER_EMBEDDED_DICTIONARY_H_
 
 #include <string>
+#include <vector>
 #include "base/port.h"
+#include "base/string_piece.h"
 
 namespace mozc {
 
@@ -70,7 +72,7 @@ class EmbeddedDictionary {
   //     cout << token->value[i].value;
   //   }
   // }
-  const Token *Lookup(const string &key) const;
+  const Token *Lookup(StringPiece key) const;
 
   // return All tokens this dictionary holds.
   const Token *AllToken() const;
@@ -87,6 +89,12 @@ class EmbeddedDictionary {
  private:
   const Token *token_;
   const size_t size_;
+  // Open addressing hash index of the tokens built in the constructor.
+  // Each slot holds the index of a token plus 1, or 0 if empty. The size is
+  // a power of 2 and at least twice as large as |size_|.
+  vector<uint32> index_;
+
+  DISALLOW_COPY_AND_ASSIGN(EmbeddedDictionary);
 };
 
 }  // namespace mozc
@@ -0,0 +1,136 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Benchmark of EmbeddedDictionary::Lookup() on the symbol dictionary.
+// Compares the hash index with the binary search over the sorted token
+// table, which Lookup() used before the index was added.
+//
+// Usage:
+//   embedded_dictionary_benchmark_main --iterations=100
+//
+// Every key of the dictionary is looked up, together with the same number
+// of keys which are not in the dictionary, as most of the lookups by the
+// rewriters miss.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/flags.h"
+#include "base/logging.h"
+#include "base/stopwatch.h"
+#include "base/string_piece.h"
+#include "data_manager/testing/mock_data_manager.h"
+#include "rewriter/embedded_dictionary.h"
+
+DEFINE_int32(iterations, 100, "number of iterations");
+
+namespace mozc {
+namespace {
+
+struct TokenLess {
+  bool operator()(const EmbeddedDictionary::Token &token,
+                  const string &key) const {
+    return strcmp(token.key, key.c_str()) < 0;
+  }
+};
+
+// The lookup used before the hash index.
+const EmbeddedDictionary::Token *BinarySearch(
+    const EmbeddedDictionary::Token *tokens, size_t size, const string &key) {
+  const EmbeddedDictionary::Token *end = tokens + size;
+  const EmbeddedDictionary::Token *it =
+      lower_bound(tokens, end, key, TokenLess());
+  if (it == end || strcmp(it->key, key.c_str()) != 0) {
+    return NULL;
+  }
+  return it;
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  InitGoogle(argv[0], &argc, &argv, false);
+
+  const mozc::EmbeddedDictionary::Token *tokens = NULL;
+  size_t size = 0;
+  mozc::testing::MockDataManager data_manager;
+  data_manager.GetSymbolRewriterData(&tokens, &size);
+  CHECK_GT(size, 0);
+
+  vector<string> keys;
+  for (size_t i = 0; i < size; ++i) {
+    keys.push_back(tokens[i].key);
+    // Keys never contain tabs as they are compiled from a TSV file.
+    keys.push_back(string(tokens[i].key) + "\t");
+  }
+
+  mozc::Stopwatch stopwatch = mozc::Stopwatch::StartNew();
+  mozc::EmbeddedDictionary dictionary(tokens, size);
+  stopwatch.Stop();
+  cout << "tokens: " << size << ", index build: "
+       << stopwatch.GetElapsedMicroseconds() << " usec" << endl;
+
+  size_t found_binary = 0;
+  stopwatch.Reset();
+  stopwatch.Start();
+  for (int n = 0; n < FLAGS_iterations; ++n) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (mozc::BinarySearch(tokens, size, keys[i]) != NULL) {
+        ++found_binary;
+      }
+    }
+  }
+  stopwatch.Stop();
+  const double binary_usec = stopwatch.GetElapsedMicroseconds();
+
+  size_t found_hash = 0;
+  stopwatch.Reset();
+  stopwatch.Start();
+  for (int n = 0; n < FLAGS_iterations; ++n) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (dictionary.Lookup(keys[i]) != NULL) {
+        ++found_hash;
+      }
+    }
+  }
+  stopwatch.Stop();
+  const double hash_usec = stopwatch.GetElapsedMicroseconds();
+  CHECK_EQ(found_binary, found_hash);
+
+  const double lookups = static_cast<double>(keys.size()) * FLAGS_iterations;
+  cout << "binary search " << binary_usec * 1000 / lookups << " ns/lookup, "
+       << "hash index " << hash_usec * 1000 / lookups << " ns/lookup, "
+       << "speedup " << binary_usec / hash_usec << "x" << endl;
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "rewriter/embedded_dictionary.h"
+
+#include <string>
+
+#include "base/port.h"
+#include "base/string_piece.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace {
+
+const EmbeddedDictionary::Value kTestValue[] = {
+  { "value_a", NULL, NULL, 1, 1, 100 },
+  { "value_ab1", "desc", NULL, 2, 2, 200 },
+  { "value_ab2", NULL, "additional", 3, 3, 300 },
+  { "value_b", NULL, NULL, 4, 4, 400 },
+  { NULL, NULL, NULL, 0, 0, 0 },
+};
+
+// Sorted by key as generated by EmbeddedDictionary::Compile().
+const EmbeddedDictionary::Token kTestToken[] = {
+  { "a", kTestValue + 0, 1 },
+  { "ab", kTestValue + 1, 2 },
+  { "b", kTestValue + 3, 1 },
+  { NULL, kTestValue, 4 },
+};
+
+TEST(EmbeddedDictionaryTest, Lookup) {
+  EmbeddedDictionary dictionary(kTestToken, arraysize(kTestToken) - 1);
+
+  const EmbeddedDictionary::Token *token = dictionary.Lookup("a");
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(1, token->value_size);
+  EXPECT_STREQ("value_a", token->value[0].value);
+
+  token = dictionary.Lookup(string("ab"));
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(2, token->value_size);
+  EXPECT_STREQ("value_ab1", token->value[0].value);
+  EXPECT_STREQ("value_ab2", token->value[1].value);
+
+  // Looks up a substring without copying it.
+  const StringPiece kText("xbx");
+  token = dictionary.Lookup(kText.substr(1, 1));
+  ASSERT_TRUE(token != NULL);
+  EXPECT_STREQ("value_b", token->value[0].value);
+
+  // Prefixes and extensions of the keys are not found.
+  EXPECT_TRUE(dictionary.Lookup("") == NULL);
+  EXPECT_TRUE(dictionary.Lookup("abc") == NULL);
+  EXPECT_TRUE(dictionary.Lookup("c") == NULL);
+  EXPECT_TRUE(dictionary.Lookup(StringPiece("ab", 1)) != NULL);
+
+  // Keys with null characters never match the null-terminated keys.
+  EXPECT_TRUE(dictionary.Lookup(StringPiece("a\0", 2)) == NULL);
+  EXPECT_TRUE(dictionary.Lookup(StringPiece("a\0b", 3)) == NULL);
+  EXPECT_TRUE(dictionary.Lookup(StringPiece("\0", 1)) == NULL);
+}
+
+TEST(EmbeddedDictionaryTest, AllToken) {
+  EmbeddedDictionary dictionary(kTestToken, arraysize(kTestToken) - 1);
+  const EmbeddedDictionary::Token *all_token = dictionary.AllToken();
+  ASSERT_TRUE(all_token != NULL);
+  EXPECT_EQ(4, all_token->value_size);
+}
+
+}  // namespace
+}  // namespace mozc
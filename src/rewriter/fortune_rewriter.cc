@@ -38,6 +38,7 @@
 #include "base/util.h"
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
+#include "rewriter/rewrite_trigger.h"
 #include "rewriter/rewriter_interface.h"
 
 namespace mozc {
@@ -182,6 +183,12 @@ FortuneRewriter::FortuneRewriter() {}
 
 FortuneRewriter::~FortuneRewriter() {}
 
+bool FortuneRewriter::MayRewrite(const RewriteTrigger &trigger) const {
+  // "おみくじ" is a single segment of hiragana.
+  return trigger.conversion_segments_size() == 1 &&
+      trigger.KeyCharTypesAreOnly(RewriteTrigger::HIRAGANA_KEY);
+}
+
 bool FortuneRewriter::Rewrite(const ConversionRequest &request,
                               Segments *segments) const {
   if (segments->conversion_segments_size() != 1) {
@@ -42,6 +42,8 @@ class FortuneRewriter : public RewriterInterface  {
   FortuneRewriter();
   virtual ~FortuneRewriter();
 
+  virtual bool MayRewrite(const RewriteTrigger &trigger) const;
+
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const;
 };
@@ -32,19 +32,41 @@
 
 #include <vector>
 
+#include "base/mutex.h"
 #include "base/stl_util.h"
+#include "base/stopwatch.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
+#include "rewriter/rewrite_trigger.h"
 #include "rewriter/rewriter_interface.h"
 #include "session/commands.pb.h"
+#include "usage_stats/usage_stats.h"
 
 namespace mozc {
 
 class MergerRewriter : public RewriterInterface {
  public:
-  MergerRewriter() {}
+  // Counters of each rewriter recorded while profiling is enabled.
+  struct RewriterStats {
+    RewriterStats()
+        : name(NULL), rewrite_count(0), skip_count(0), total_time_usec(0),
+          warmup_time_usec(0) {}
+
+    // The name given to AddRewriter(), or NULL.
+    const char *name;
+    // The number of Rewrite() calls.
+    uint64 rewrite_count;
+    // The number of calls skipped because MayRewrite() returned false.
+    uint64 skip_count;
+    // Total time spent in Rewrite().
+    uint64 total_time_usec;
+    // Time spent in Warmup().  Always recorded, 0 until Warmup() finishes.
+    uint64 warmup_time_usec;
+  };
+
+  MergerRewriter() : profiling_enabled_(false) {}
   virtual ~MergerRewriter() {
     STLDeleteElements(&rewriters_);
   }
@@ -73,16 +95,93 @@ class MergerRewriter : public RewriterInterface {
     }
   }
 
-  // This instance owns the rewriter.
-  void AddRewriter(RewriterInterface *rewriter) {
-    rewriters_.push_back(rewriter);
+  // This instance owns the rewriter.  |name| is used in the profile and
+  // must be a string literal if given.
+  void AddRewriter(RewriterInterface *rewriter, const char *name = NULL) {
+    AddRewriterInternal(rewriter, name, false);
+  }
+
+  // Same as AddRewriter(), but the rewriter runs even after the latency
+  // budget of the request is used up. Use this only for cheap rewriters
+  // whose output is relied on, e.g., normalization.
+  void AddRequiredRewriter(RewriterInterface *rewriter,
+                           const char *name = NULL) {
+    AddRewriterInternal(rewriter, name, true);
+  }
+
+  // Enables recording of RewriterStats. The counters are updated without
+  // locking, so this is meant for profiling tools and debug builds.
+  void set_profiling_enabled(bool enabled) {
+    profiling_enabled_ = enabled;
+  }
+
+  bool profiling_enabled() const {
+    return profiling_enabled_;
+  }
+
+  size_t rewriters_size() const {
+    return rewriters_.size();
+  }
+
+  // Returns the counters of the |index|-th rewriter in the order of
+  // AddRewriter() and AddRequiredRewriter().  Can be called while Warmup()
+  // runs on another thread.
+  RewriterStats stats(size_t index) const {
+    RewriterStats rewriter_stats = stats_[index];
+    scoped_lock l(&warmup_mutex_);
+    if (index < warmup_time_usec_.size()) {
+      rewriter_stats.warmup_time_usec = warmup_time_usec_[index];
+    }
+    return rewriter_stats;
+  }
+
+  // Clears the counters of Rewrite().  The names and the warmup times are
+  // kept.
+  void ClearStats() {
+    for (size_t i = 0; i < stats_.size(); ++i) {
+      RewriterStats cleared_stats;
+      cleared_stats.name = stats_[i].name;
+      stats_[i] = cleared_stats;
+    }
   }
 
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const {
     bool result = false;
+    bool deadline_exceeded = false;
+    // The trigger reads the current segments, so it stays valid after a
+    // rewriter resizes them.
+    const RewriteTrigger trigger(*segments);
     for (size_t i = 0; i < rewriters_.size(); ++i) {
-      if (CheckCapablity(request, segments, rewriters_[i])) {
+      // Once the latency budget is used up, the remaining rewriters are
+      // skipped except for the required ones.
+      if (!required_[i]) {
+        if (deadline_exceeded) {
+          continue;
+        }
+        if (request.IsDeadlineExceeded()) {
+          usage_stats::UsageStats::IncrementCount(
+              "SuggestionDeadlineExceededInRewriter");
+          deadline_exceeded = true;
+          continue;
+        }
+      }
+      if (!CheckCapablity(request, segments, rewriters_[i])) {
+        continue;
+      }
+      if (!rewriters_[i]->MayRewrite(trigger)) {
+        if (profiling_enabled_) {
+          ++stats_[i].skip_count;
+        }
+        continue;
+      }
+      if (profiling_enabled_) {
+        Stopwatch stopwatch = Stopwatch::StartNew();
+        result |= rewriters_[i]->Rewrite(request, segments);
+        ++stats_[i].rewrite_count;
+        stats_[i].total_time_usec +=
+            static_cast<uint64>(stopwatch.GetElapsedMicroseconds());
+      } else {
         result |= rewriters_[i]->Rewrite(request, segments);
       }
     }
@@ -150,8 +249,49 @@ class MergerRewriter : public RewriterInterface {
     }
   }
 
+  // Builds the deferred data of all the rewriters.  Usually called on a
+  // background thread while Rewrite() runs, so the times are published to
+  // stats() under |warmup_mutex_| instead of being written to |stats_|.
+  virtual void Warmup() {
+    vector<uint64> warmup_time_usec(rewriters_.size(), 0);
+    for (size_t i = 0; i < rewriters_.size(); ++i) {
+      Stopwatch stopwatch = Stopwatch::StartNew();
+      rewriters_[i]->Warmup();
+      warmup_time_usec[i] =
+          static_cast<uint64>(stopwatch.GetElapsedMicroseconds());
+    }
+    scoped_lock l(&warmup_mutex_);
+    warmup_time_usec_.swap(warmup_time_usec);
+  }
+
+  virtual bool TrimMemory() {
+    bool result = false;
+    for (size_t i = 0; i < rewriters_.size(); ++i) {
+      result |= rewriters_[i]->TrimMemory();
+    }
+    return result;
+  }
+
  private:
+  void AddRewriterInternal(RewriterInterface *rewriter, const char *name,
+                           bool required) {
+    rewriters_.push_back(rewriter);
+    required_.push_back(required);
+    stats_.push_back(RewriterStats());
+    stats_.back().name = name;
+  }
+
   vector<RewriterInterface *> rewriters_;
+  // required_[i] is true if rewriters_[i] ignores the latency budget.
+  vector<bool> required_;
+  bool profiling_enabled_;
+  // stats_[i] holds the counters of rewriters_[i].  Their warmup_time_usec
+  // is not used.
+  mutable vector<RewriterStats> stats_;
+  // warmup_time_usec_[i] is the time rewriters_[i] spent in Warmup().  Empty
+  // until Warmup() finishes.
+  mutable Mutex warmup_mutex_;
+  vector<uint64> warmup_time_usec_;
 
   DISALLOW_COPY_AND_ASSIGN(MergerRewriter);
 };
@@ -31,11 +31,14 @@
 
 #include <string>
 
+#include "base/clock_mock.h"
 #include "base/system_util.h"
+#include "base/util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
+#include "rewriter/rewrite_trigger.h"
 #include "testing/base/public/gunit.h"
 
 DECLARE_string(test_tmpdir);
@@ -94,6 +97,10 @@ class TestRewriter : public RewriterInterface {
     buffer_->append(name_ + ".Clear();");
   }
 
+  virtual void Warmup() {
+    buffer_->append(name_ + ".Warmup();");
+  }
+
  private:
   string *buffer_;
   const string name_;
@@ -101,6 +108,35 @@ class TestRewriter : public RewriterInterface {
   int capability_;
 };
 
+// Uses up the latency budget of the request in Rewrite().
+class SlowRewriter : public TestRewriter {
+ public:
+  SlowRewriter(string *buffer, const string &name, ClockMock *clock)
+      : TestRewriter(buffer, name, true), clock_(clock) {}
+
+  virtual bool Rewrite(const ConversionRequest &request,
+                       Segments *segments) const {
+    // Takes one second in the ticks.  The wall clock is not used, so that
+    // changes of the system time do not affect the latency budget.
+    clock_->PutClockForwardByTicks(clock_->GetFrequency());
+    return TestRewriter::Rewrite(request, segments);
+  }
+
+ private:
+  ClockMock *clock_;
+};
+
+// Rewrites only segments whose keys contain numbers.
+class NumberKeyRewriter : public TestRewriter {
+ public:
+  NumberKeyRewriter(string *buffer, const string &name)
+      : TestRewriter(buffer, name, true) {}
+
+  virtual bool MayRewrite(const RewriteTrigger &trigger) const {
+    return trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY);
+  }
+};
+
 class MergerRewriterTest : public testing::Test {
  protected:
   virtual void SetUp() {
@@ -261,6 +297,118 @@ TEST_F(MergerRewriterTest, RewriteCheckTest) {
   call_result.clear();
 }
 
+TEST_F(MergerRewriterTest, RewriteWithLatencyBudget) {
+  ClockMock clock(1000, 0);
+  Util::SetClockHandler(&clock);
+
+  string call_result;
+  MergerRewriter merger;
+  Segments segments;
+  segments.set_request_type(Segments::CONVERSION);
+  merger.AddRewriter(new TestRewriter(&call_result, "a", false));
+  merger.AddRewriter(new SlowRewriter(&call_result, "b", &clock));
+  merger.AddRewriter(new TestRewriter(&call_result, "c", false));
+  merger.AddRequiredRewriter(new TestRewriter(&call_result, "d", false));
+
+  // "b" uses up the budget, so "c" is skipped. "d" is required.
+  ConversionRequest request;
+  request.set_latency_budget_msec(500);
+  EXPECT_TRUE(merger.Rewrite(request, &segments));
+  EXPECT_EQ("a.Rewrite();"
+            "b.Rewrite();"
+            "d.Rewrite();",
+            call_result);
+
+  call_result.clear();
+  request.set_latency_budget_msec(0);
+  EXPECT_TRUE(merger.Rewrite(request, &segments));
+  EXPECT_EQ("a.Rewrite();"
+            "b.Rewrite();"
+            "c.Rewrite();"
+            "d.Rewrite();",
+            call_result);
+
+  Util::SetClockHandler(NULL);
+}
+
+TEST_F(MergerRewriterTest, RewriteWithTrigger) {
+  string call_result;
+  MergerRewriter merger;
+  Segments segments;
+  segments.set_request_type(Segments::CONVERSION);
+  Segment *segment = segments.add_segment();
+  const ConversionRequest request;
+  merger.AddRewriter(new TestRewriter(&call_result, "a", false));
+  merger.AddRewriter(new NumberKeyRewriter(&call_result, "b"));
+
+  segment->set_key("\xE3\x81\x82");  // "あ"
+  EXPECT_FALSE(merger.Rewrite(request, &segments));
+  EXPECT_EQ("a.Rewrite();", call_result);
+
+  call_result.clear();
+  segment->set_key("\xE3\x81\x82" "1");  // "あ1"
+  EXPECT_TRUE(merger.Rewrite(request, &segments));
+  EXPECT_EQ("a.Rewrite();"
+            "b.Rewrite();",
+            call_result);
+}
+
+TEST_F(MergerRewriterTest, Profiling) {
+  ClockMock clock(1000, 0);
+  Util::SetClockHandler(&clock);
+
+  string call_result;
+  MergerRewriter merger;
+  Segments segments;
+  segments.set_request_type(Segments::CONVERSION);
+  Segment *segment = segments.add_segment();
+  segment->set_key("abc");
+  const ConversionRequest request;
+  merger.AddRewriter(new SlowRewriter(&call_result, "a", &clock));
+  merger.AddRewriter(new NumberKeyRewriter(&call_result, "b"));
+  ASSERT_EQ(2, merger.rewriters_size());
+
+  // Nothing is recorded until profiling is enabled.
+  merger.Rewrite(request, &segments);
+  EXPECT_EQ(0, merger.stats(0).rewrite_count);
+  EXPECT_EQ(0, merger.stats(1).skip_count);
+
+  merger.set_profiling_enabled(true);
+  merger.Rewrite(request, &segments);
+  merger.Rewrite(request, &segments);
+  EXPECT_EQ(2, merger.stats(0).rewrite_count);
+  EXPECT_EQ(0, merger.stats(0).skip_count);
+  EXPECT_EQ(2000000, merger.stats(0).total_time_usec);
+  EXPECT_EQ(0, merger.stats(1).rewrite_count);
+  EXPECT_EQ(2, merger.stats(1).skip_count);
+  EXPECT_EQ(0, merger.stats(1).total_time_usec);
+
+  merger.ClearStats();
+  EXPECT_EQ(0, merger.stats(0).rewrite_count);
+  EXPECT_EQ(0, merger.stats(1).skip_count);
+
+  Util::SetClockHandler(NULL);
+}
+
+TEST_F(MergerRewriterTest, Warmup) {
+  string call_result;
+  MergerRewriter merger;
+  merger.AddRewriter(new TestRewriter(&call_result, "a", false), "a");
+  merger.AddRewriter(new TestRewriter(&call_result, "b", false));
+  EXPECT_STREQ("a", merger.stats(0).name);
+  EXPECT_TRUE(merger.stats(1).name == NULL);
+  EXPECT_EQ(0, merger.stats(0).warmup_time_usec);
+
+  merger.Warmup();
+  EXPECT_EQ("a.Warmup();"
+            "b.Warmup();",
+            call_result);
+
+  // The name is kept as it is given only once.
+  merger.ClearStats();
+  EXPECT_STREQ("a", merger.stats(0).name);
+}
+
 TEST_F(MergerRewriterTest, Focus) {
   string call_result;
   MergerRewriter merger;
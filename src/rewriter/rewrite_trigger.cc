@@ -0,0 +1,95 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rewriter/rewrite_trigger.h"
+
+#include <string>
+
+#include "base/util.h"
+#include "converter/segments.h"
+
+namespace mozc {
+namespace {
+
+int GetKeyCharType(char32 c) {
+  switch (Util::GetScriptType(c)) {
+    case Util::HIRAGANA:
+      return RewriteTrigger::HIRAGANA_KEY;
+    case Util::KATAKANA:
+      return RewriteTrigger::KATAKANA_KEY;
+    case Util::KANJI:
+      return RewriteTrigger::KANJI_KEY;
+    case Util::NUMBER:
+      return RewriteTrigger::NUMBER_KEY;
+    case Util::ALPHABET:
+      return RewriteTrigger::ALPHABET_KEY;
+    default:
+      return RewriteTrigger::OTHER_KEY;
+  }
+}
+
+// Returns a value which changes when the conversion segments are resized
+// or the keys are re-split, e.g., by CalculatorRewriter. It is never zero.
+uint64 GetKeysSignature(const Segments &segments) {
+  const size_t size = segments.conversion_segments_size();
+  uint64 total_key_length = 0;
+  for (size_t i = 0; i < size; ++i) {
+    total_key_length += segments.conversion_segment(i).key().size();
+  }
+  return (static_cast<uint64>(size) << 32 | total_key_length) + 1;
+}
+
+}  // namespace
+
+RewriteTrigger::RewriteTrigger(const Segments &segments)
+    : segments_(segments),
+      keys_signature_(0),
+      key_char_types_(0) {}
+
+size_t RewriteTrigger::conversion_segments_size() const {
+  return segments_.conversion_segments_size();
+}
+
+int RewriteTrigger::key_char_types() const {
+  const uint64 keys_signature = GetKeysSignature(segments_);
+  if (keys_signature == keys_signature_) {
+    return key_char_types_;
+  }
+  keys_signature_ = keys_signature;
+  key_char_types_ = 0;
+  for (size_t i = 0; i < segments_.conversion_segments_size(); ++i) {
+    const string &key = segments_.conversion_segment(i).key();
+    for (ConstChar32Iterator iter(key); !iter.Done(); iter.Next()) {
+      key_char_types_ |= GetKeyCharType(iter.Get());
+    }
+  }
+  return key_char_types_;
+}
+
+}  // namespace mozc
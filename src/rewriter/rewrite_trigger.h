@@ -0,0 +1,93 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_REWRITER_REWRITE_TRIGGER_H_
+#define MOZC_REWRITER_REWRITE_TRIGGER_H_
+
+#include <cstddef>  // for size_t
+
+#include "base/port.h"
+
+namespace mozc {
+
+class Segments;
+
+// Cheap summary of the conversion segments. MergerRewriter creates it once
+// per request and passes it to RewriterInterface::MayRewrite() so that
+// rewriters with nothing to do for the input are skipped without scanning
+// the segments and candidates. The summary is derived from the current
+// segments, so it follows the rewriters which resize them.
+class RewriteTrigger {
+ public:
+  // Character classes of the keys. See Util::ScriptType.
+  enum KeyCharType {
+    HIRAGANA_KEY = 1,
+    KATAKANA_KEY = 2,
+    KANJI_KEY = 4,
+    NUMBER_KEY = 8,
+    ALPHABET_KEY = 16,
+    OTHER_KEY = 32,  // Symbols, spaces, emoji and so on.
+  };
+
+  // |segments| must outlive this object.
+  explicit RewriteTrigger(const Segments &segments);
+  ~RewriteTrigger() {}
+
+  size_t conversion_segments_size() const;
+
+  // Returns the bitwise OR of KeyCharType of all the characters in the keys
+  // of the conversion segments.
+  int key_char_types() const;
+
+  // Returns true if a key of the conversion segments contains a character
+  // of any of |types|.
+  bool HasKeyCharType(int types) const {
+    return (key_char_types() & types) != 0;
+  }
+
+  // Returns true if the keys of the conversion segments consist only of
+  // characters of |types|. Returns false if the keys are empty.
+  bool KeyCharTypesAreOnly(int types) const {
+    const int key_char_types = this->key_char_types();
+    return key_char_types != 0 && (key_char_types & ~types) == 0;
+  }
+
+ private:
+  const Segments &segments_;
+  // |key_char_types_| is cached for the keys which |keys_signature_| was
+  // computed from, and recomputed once the keys are resized or re-split.
+  mutable uint64 keys_signature_;
+  mutable int key_char_types_;
+
+  DISALLOW_COPY_AND_ASSIGN(RewriteTrigger);
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_REWRITER_REWRITE_TRIGGER_H_
@@ -0,0 +1,103 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rewriter/rewrite_trigger.h"
+
+#include "converter/segments.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace {
+
+TEST(RewriteTriggerTest, KeyCharTypes) {
+  Segments segments;
+  {
+    const RewriteTrigger trigger(segments);
+    EXPECT_EQ(0, trigger.conversion_segments_size());
+    EXPECT_EQ(0, trigger.key_char_types());
+    EXPECT_FALSE(trigger.KeyCharTypesAreOnly(RewriteTrigger::HIRAGANA_KEY));
+  }
+
+  // History segments are ignored.
+  Segment *segment = segments.add_segment();
+  segment->set_segment_type(Segment::HISTORY);
+  segment->set_key("abc");
+
+  segment = segments.add_segment();
+  // "さいころ"
+  segment->set_key("\xE3\x81\x95\xE3\x81\x84\xE3\x81\x93\xE3\x82\x8D");
+  {
+    const RewriteTrigger trigger(segments);
+    EXPECT_EQ(1, trigger.conversion_segments_size());
+    EXPECT_EQ(RewriteTrigger::HIRAGANA_KEY, trigger.key_char_types());
+    EXPECT_TRUE(trigger.KeyCharTypesAreOnly(RewriteTrigger::HIRAGANA_KEY));
+    EXPECT_FALSE(trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY));
+  }
+
+  segment = segments.add_segment();
+  // "１+かな"
+  segment->set_key("\xEF\xBC\x91+\xE3\x81\x8B\xE3\x81\xAA");
+  {
+    const RewriteTrigger trigger(segments);
+    EXPECT_EQ(2, trigger.conversion_segments_size());
+    EXPECT_EQ(RewriteTrigger::HIRAGANA_KEY | RewriteTrigger::NUMBER_KEY |
+              RewriteTrigger::OTHER_KEY,
+              trigger.key_char_types());
+    EXPECT_FALSE(trigger.KeyCharTypesAreOnly(RewriteTrigger::HIRAGANA_KEY));
+    EXPECT_TRUE(trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY |
+                                       RewriteTrigger::ALPHABET_KEY));
+    EXPECT_FALSE(trigger.HasKeyCharType(RewriteTrigger::ALPHABET_KEY));
+  }
+}
+
+TEST(RewriteTriggerTest, FollowsResizedSegments) {
+  Segments segments;
+  Segment *segment = segments.add_segment();
+  // "かな"
+  segment->set_key("\xE3\x81\x8B\xE3\x81\xAA");
+  segment = segments.add_segment();
+  segment->set_key("12");
+
+  const RewriteTrigger trigger(segments);
+  EXPECT_EQ(2, trigger.conversion_segments_size());
+  EXPECT_TRUE(trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY));
+
+  // Merges the segments into one, e.g., as CalculatorRewriter does.
+  segments.erase_segment(1);
+  segments.mutable_segment(0)->set_key("12");
+  EXPECT_EQ(1, trigger.conversion_segments_size());
+  EXPECT_EQ(RewriteTrigger::NUMBER_KEY, trigger.key_char_types());
+  EXPECT_TRUE(trigger.KeyCharTypesAreOnly(RewriteTrigger::NUMBER_KEY));
+
+  segments.mutable_segment(0)->set_key("abc");
+  EXPECT_EQ(RewriteTrigger::ALPHABET_KEY, trigger.key_char_types());
+}
+
+}  // namespace
+}  // namespace mozc
@@ -29,7 +29,9 @@
 
 #include "rewriter/rewriter.h"
 
+#include "base/executor.h"
 #include "base/logging.h"
+#include "base/startup_trace.h"
 #include "converter/converter_interface.h"
 #include "data_manager/data_manager_interface.h"
 #include "dictionary/pos_group.h"
@@ -67,6 +69,11 @@
 #endif  // NO_USAGE_REWRITER
 
 DEFINE_bool(use_history_rewriter, true, "Use history rewriter or not.");
+DEFINE_bool(profile_rewriters, false,
+            "Records the time spent in each rewriter and logs it at exit.");
+DEFINE_bool(warmup_rewriters, true,
+            "Builds the data of rewriters in the background after the first "
+            "conversion instead of on the first use.");
 
 namespace {
 // When updating the emoji dictionary,
@@ -81,10 +88,35 @@ namespace {
 
 namespace mozc {
 
+class RewriterImpl::WarmupTask : public BackgroundTask {
+ public:
+  explicit WarmupTask(RewriterImpl *rewriter)
+      : BackgroundTask("RewriterWarmup", Executor::LOW),
+        rewriter_(rewriter) {}
+
+  virtual ~WarmupTask() {
+    Join();
+  }
+
+  virtual void Run() {
+    // The warmup starts after the first conversion, which usually comes
+    // after the startup trace is written.  Then this records nothing.
+    ScopedStartupTrace trace("RewriterWarmup");
+    rewriter_->Warmup();
+  }
+
+ private:
+  RewriterImpl *rewriter_;
+
+  DISALLOW_COPY_AND_ASSIGN(WarmupTask);
+};
+
 RewriterImpl::RewriterImpl(const ConverterInterface *parent_converter,
                            const DataManagerInterface *data_manager,
                            const PosGroup *pos_group,
-                           const DictionaryInterface *dictionary) {
+                           const DictionaryInterface *dictionary)
+    : warmup_task_(new WarmupTask(this)),
+      warmup_started_(!FLAGS_warmup_rewriters) {
   DCHECK(parent_converter);
   DCHECK(data_manager);
   DCHECK(pos_group);
@@ -92,47 +124,164 @@ RewriterImpl::RewriterImpl(const ConverterInterface *parent_converter,
   DCHECK(pos_matcher);
   // |dictionary| can be NULL
 
-  AddRewriter(new UserDictionaryRewriter);
-  AddRewriter(new FocusCandidateRewriter(data_manager));
-  AddRewriter(new LanguageAwareRewriter(*pos_matcher, dictionary));
-  AddRewriter(new TransliterationRewriter(*pos_matcher));
-  AddRewriter(new EnglishVariantsRewriter);
-  AddRewriter(new NumberRewriter(data_manager));
-  AddRewriter(new CollocationRewriter(data_manager));
-  AddRewriter(new SingleKanjiRewriter(*pos_matcher));
-  AddRewriter(new EmojiRewriter(
-      kEmojiDataList, arraysize(kEmojiDataList),
-      kEmojiTokenList, arraysize(kEmojiTokenList),
-      kEmojiValueList));
-  AddRewriter(new EmoticonRewriter);
-  AddRewriter(new CalculatorRewriter(parent_converter));
-  AddRewriter(new SymbolRewriter(parent_converter, data_manager));
-  AddRewriter(new UnicodeRewriter(parent_converter));
-  AddRewriter(new VariantsRewriter(pos_matcher));
-  AddRewriter(new ZipcodeRewriter(pos_matcher));
-  AddRewriter(new DiceRewriter);
+  // The time spent in the constructor of each rewriter is recorded as
+  // a startup trace event.
+  {
+    ScopedStartupTrace trace("UserDictionaryRewriter");
+    AddRewriter(new UserDictionaryRewriter, "UserDictionaryRewriter");
+  }
+  {
+    ScopedStartupTrace trace("FocusCandidateRewriter");
+    AddRewriter(new FocusCandidateRewriter(data_manager),
+                "FocusCandidateRewriter");
+  }
+  {
+    ScopedStartupTrace trace("LanguageAwareRewriter");
+    AddRewriter(new LanguageAwareRewriter(*pos_matcher, dictionary),
+                "LanguageAwareRewriter");
+  }
+  {
+    ScopedStartupTrace trace("TransliterationRewriter");
+    AddRewriter(new TransliterationRewriter(*pos_matcher),
+                "TransliterationRewriter");
+  }
+  {
+    ScopedStartupTrace trace("EnglishVariantsRewriter");
+    AddRewriter(new EnglishVariantsRewriter, "EnglishVariantsRewriter");
+  }
+  {
+    ScopedStartupTrace trace("NumberRewriter");
+    AddRewriter(new NumberRewriter(data_manager), "NumberRewriter");
+  }
+  {
+    ScopedStartupTrace trace("CollocationRewriter");
+    AddRewriter(new CollocationRewriter(data_manager), "CollocationRewriter");
+  }
+  {
+    ScopedStartupTrace trace("SingleKanjiRewriter");
+    AddRewriter(new SingleKanjiRewriter(*pos_matcher), "SingleKanjiRewriter");
+  }
+  {
+    ScopedStartupTrace trace("EmojiRewriter");
+    AddRewriter(new EmojiRewriter(
+        kEmojiDataList, arraysize(kEmojiDataList),
+        kEmojiTokenList, arraysize(kEmojiTokenList),
+        kEmojiValueList), "EmojiRewriter");
+  }
+  {
+    ScopedStartupTrace trace("EmoticonRewriter");
+    AddRewriter(new EmoticonRewriter, "EmoticonRewriter");
+  }
+  {
+    ScopedStartupTrace trace("CalculatorRewriter");
+    AddRewriter(new CalculatorRewriter(parent_converter), "CalculatorRewriter");
+  }
+  {
+    ScopedStartupTrace trace("SymbolRewriter");
+    AddRewriter(new SymbolRewriter(parent_converter, data_manager),
+                "SymbolRewriter");
+  }
+  {
+    ScopedStartupTrace trace("UnicodeRewriter");
+    AddRewriter(new UnicodeRewriter(parent_converter), "UnicodeRewriter");
+  }
+  {
+    ScopedStartupTrace trace("VariantsRewriter");
+    AddRewriter(new VariantsRewriter(pos_matcher), "VariantsRewriter");
+  }
+  {
+    ScopedStartupTrace trace("ZipcodeRewriter");
+    AddRewriter(new ZipcodeRewriter(pos_matcher), "ZipcodeRewriter");
+  }
+  {
+    ScopedStartupTrace trace("DiceRewriter");
+    AddRewriter(new DiceRewriter, "DiceRewriter");
+  }
 
   if (FLAGS_use_history_rewriter) {
-    AddRewriter(new UserBoundaryHistoryRewriter(parent_converter));
-    AddRewriter(new UserSegmentHistoryRewriter(pos_matcher, pos_group));
+    {
+      ScopedStartupTrace trace("UserBoundaryHistoryRewriter");
+      AddRewriter(new UserBoundaryHistoryRewriter(parent_converter),
+                  "UserBoundaryHistoryRewriter");
+    }
+    {
+      ScopedStartupTrace trace("UserSegmentHistoryRewriter");
+      AddRewriter(new UserSegmentHistoryRewriter(pos_matcher, pos_group),
+                  "UserSegmentHistoryRewriter");
+    }
   }
 
-  AddRewriter(new DateRewriter);
-  AddRewriter(new FortuneRewriter);
+  {
+    ScopedStartupTrace trace("DateRewriter");
+    AddRewriter(new DateRewriter, "DateRewriter");
+  }
+  {
+    ScopedStartupTrace trace("FortuneRewriter");
+    AddRewriter(new FortuneRewriter, "FortuneRewriter");
+  }
 #ifndef OS_ANDROID
   // CommandRewriter is not tested well on Android.
   // So we temporarily disable it.
   // TODO(yukawa, team): Enable CommandRewriter on Android if necessary.
-  AddRewriter(new CommandRewriter);
+  {
+    ScopedStartupTrace trace("CommandRewriter");
+    AddRewriter(new CommandRewriter, "CommandRewriter");
+  }
 #endif  // OS_ANDROID
 #ifndef NO_USAGE_REWRITER
-  AddRewriter(new UsageRewriter(data_manager, dictionary));
+  {
+    ScopedStartupTrace trace("UsageRewriter");
+    AddRewriter(new UsageRewriter(data_manager, dictionary), "UsageRewriter");
+  }
 #endif  // NO_USAGE_REWRITER
 
-  AddRewriter(new VersionRewriter);
-  AddRewriter(CorrectionRewriter::CreateCorrectionRewriter(data_manager));
-  AddRewriter(new NormalizationRewriter);
-  AddRewriter(new RemoveRedundantCandidateRewriter);
+  {
+    ScopedStartupTrace trace("VersionRewriter");
+    AddRewriter(new VersionRewriter, "VersionRewriter");
+  }
+  {
+    ScopedStartupTrace trace("CorrectionRewriter");
+    AddRewriter(CorrectionRewriter::CreateCorrectionRewriter(data_manager),
+                "CorrectionRewriter");
+  }
+  {
+    ScopedStartupTrace trace("NormalizationRewriter");
+    AddRequiredRewriter(new NormalizationRewriter, "NormalizationRewriter");
+  }
+  {
+    ScopedStartupTrace trace("RemoveRedundantCandidateRewriter");
+    AddRequiredRewriter(new RemoveRedundantCandidateRewriter,
+                        "RemoveRedundantCandidateRewriter");
+  }
+
+  set_profiling_enabled(FLAGS_profile_rewriters);
+}
+
+RewriterImpl::~RewriterImpl() {
+  // The rewriters must not be deleted while they are warmed up.
+  warmup_task_.reset();
+  if (!profiling_enabled()) {
+    return;
+  }
+  for (size_t i = 0; i < rewriters_size(); ++i) {
+    const RewriterStats rewriter_stats = stats(i);
+    LOG(INFO) << rewriter_stats.name << ": "
+              << "rewrite_count=" << rewriter_stats.rewrite_count
+              << " skip_count=" << rewriter_stats.skip_count
+              << " total_time_usec=" << rewriter_stats.total_time_usec
+              << " warmup_time_usec=" << rewriter_stats.warmup_time_usec;
+  }
+}
+
+bool RewriterImpl::Rewrite(const ConversionRequest &request,
+                           Segments *segments) const {
+  const bool result = MergerRewriter::Rewrite(request, segments);
+  if (!warmup_started_) {
+    // Rewrite() is called only from the converter thread.
+    warmup_started_ = true;
+    warmup_task_->Start();
+  }
+  return result;
 }
 
 }  // namespace mozc
@@ -64,6 +64,7 @@
         'number_compound_util.cc',
         'number_rewriter.cc',
         'remove_redundant_candidate_rewriter.cc',
+        'rewrite_trigger.cc',
         'rewriter.cc',
         'single_kanji_rewriter.cc',
         'symbol_rewriter.cc',
@@ -30,6 +30,7 @@
 #ifndef MOZC_REWRITER_REWRITER_H_
 #define MOZC_REWRITER_REWRITER_H_
 
+#include "base/scoped_ptr.h"
 #include "rewriter/merger_rewriter.h"
 
 namespace mozc {
@@ -40,12 +41,25 @@ class DictionaryInterface;
 class POSMatcher;
 class PosGroup;
 
+// The data of some rewriters is built on their first use.  After the first
+// Rewrite() call, i.e., once the server has responded to the first key, the
+// rest of the data is built in the background by Warmup().
 class RewriterImpl : public MergerRewriter {
  public:
   RewriterImpl(const ConverterInterface *parent_converter,
                const DataManagerInterface *data_manager,
                const PosGroup *pos_group,
                const DictionaryInterface *dictionary);
+  virtual ~RewriterImpl();
+
+  virtual bool Rewrite(const ConversionRequest &request,
+                       Segments *segments) const;
+
+ private:
+  class WarmupTask;
+
+  scoped_ptr<WarmupTask> warmup_task_;
+  mutable bool warmup_started_;
 };
 
 }  // namespace mozc
@@ -35,6 +35,7 @@
 namespace mozc {
 
 class ConversionRequest;
+class RewriteTrigger;
 class Segments;
 
 class RewriterInterface {
@@ -56,6 +57,14 @@ class RewriterInterface {
     return CONVERSION;
   }
 
+  // Returns false if this rewriter never modifies segments summarized by
+  // |trigger|. MergerRewriter checks this before Rewrite() so that it can
+  // skip the rewriter without scanning the segments. This should be much
+  // cheaper than Rewrite(). Returns true by default.
+  virtual bool MayRewrite(const RewriteTrigger &trigger) const {
+    return true;
+  }
+
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const = 0;
 
@@ -82,6 +91,14 @@ class RewriterInterface {
   // clear internal data
   virtual void Clear() {}
 
+  // Builds the data which is otherwise built on the first Rewrite() call.
+  // This may be called on a background thread while Rewrite() is running.
+  virtual void Warmup() {}
+
+  // Releases the data built by Warmup() or Rewrite().  The data is built
+  // again on the next Rewrite() call.  Returns true if anything was released.
+  virtual bool TrimMemory() { return false; }
+
  protected:
   RewriterInterface() {}
 };
@@ -32,6 +32,8 @@
 #include <cstddef>
 #include <string>
 
+#include "base/file_util.h"
+#include "base/startup_trace.h"
 #include "base/system_util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
@@ -43,6 +45,7 @@
 #include "rewriter/rewriter_interface.h"
 #include "testing/base/public/gunit.h"
 
+DECLARE_string(startup_trace_file);
 DECLARE_string(test_tmpdir);
 
 namespace mozc {
@@ -133,4 +136,23 @@ TEST_F(RewriterTest, CommandRewriterAvailability) {
   }
 }
 
+TEST_F(RewriterTest, StartupTrace) {
+  const string original_trace_file = FLAGS_startup_trace_file;
+  FLAGS_startup_trace_file =
+      FileUtil::JoinPath(FLAGS_test_tmpdir, "rewriter_startup_trace.json");
+  StartupTrace::Reset();
+
+  const testing::MockDataManager data_manager;
+  const DictionaryInterface *kNullDictionary = NULL;
+  RewriterImpl rewriter(converter_mock_.get(), &data_manager,
+                        pos_group_.get(), kNullDictionary);
+  // The construction of each rewriter is recorded.
+  const string json = StartupTrace::ToJson();
+  EXPECT_NE(string::npos, json.find("\"SymbolRewriter\""));
+  EXPECT_NE(string::npos, json.find("\"RemoveRedundantCandidateRewriter\""));
+
+  FLAGS_startup_trace_file = original_trace_file;
+  StartupTrace::Reset();
+}
+
 }  // namespace mozc
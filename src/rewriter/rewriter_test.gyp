@@ -47,6 +47,7 @@
         'dice_rewriter_test.cc',
         'dictionary_generator_test.cc',
         'emoticon_rewriter_test.cc',
+        'embedded_dictionary_test.cc',
         'english_variants_rewriter_test.cc',
         'focus_candidate_rewriter_test.cc',
         'fortune_rewriter_test.cc',
@@ -55,6 +56,7 @@
         'number_compound_util_test.cc',
         'number_rewriter_test.cc',
         'remove_redundant_candidate_rewriter_test.cc',
+        'rewrite_trigger_test.cc',
         'rewriter_test.cc',
         'symbol_rewriter_test.cc',
         'unicode_rewriter_test.cc',
@@ -197,6 +199,18 @@
         'test_size': 'small',
       },
     },
+    {
+      'target_name': 'embedded_dictionary_benchmark_main',
+      'type': 'executable',
+      'sources': [
+        'embedded_dictionary_benchmark_main.cc',
+      ],
+      'dependencies': [
+        '../base/base.gyp:base',
+        '../data_manager/testing/mock_data_manager.gyp:mock_data_manager',
+        'rewriter.gyp:rewriter',
+      ],
+    },
     # Test cases meta target: this target is referred from gyp/tests.gyp
     {
       'target_name': 'rewriter_all_test',
@@ -35,6 +35,7 @@
 #include <set>
 
 #include "base/logging.h"
+#include "base/mutex.h"
 #include "base/singleton.h"
 #include "base/util.h"
 #include "config/config.pb.h"
@@ -272,7 +273,7 @@ bool SymbolRewriter::RewriteEachCandidate(Segments *segments) const {
   bool modified = false;
   for (size_t i = 0; i < segments->conversion_segments_size(); ++i) {
     const string &key = segments->conversion_segment(i).key();
-    const EmbeddedDictionary::Token *token = dictionary_->Lookup(key);
+    const EmbeddedDictionary::Token *token = Lookup(key);
     if (token == NULL) {
       continue;
     }
@@ -297,7 +298,7 @@ bool SymbolRewriter::RewriteEntireCandidate(const ConversionRequest &request,
     key += segments->conversion_segment(i).key();
   }
 
-  const EmbeddedDictionary::Token *token = dictionary_->Lookup(key);
+  const EmbeddedDictionary::Token *token = Lookup(key);
   if (token == NULL) {
     return false;
   }
@@ -327,18 +328,44 @@ bool SymbolRewriter::RewriteEntireCandidate(const ConversionRequest &request,
 
 SymbolRewriter::SymbolRewriter(const ConverterInterface *parent_converter,
                                const DataManagerInterface *data_manager)
-    : parent_converter_(parent_converter) {
+    : parent_converter_(parent_converter), token_(NULL), token_size_(0) {
   DCHECK(parent_converter_);
-  const EmbeddedDictionary::Token *data;
-  size_t size;
-  data_manager->GetSymbolRewriterData(&data, &size);
-  DCHECK(data);
-  DCHECK(size);
-  dictionary_.reset(new EmbeddedDictionary(data, size));
+  data_manager->GetSymbolRewriterData(&token_, &token_size_);
+  DCHECK(token_);
+  DCHECK(token_size_);
 }
 
 SymbolRewriter::~SymbolRewriter() {}
 
+void SymbolRewriter::BuildDictionaryLocked() const {
+  // Building the index of thousands of symbols is deferred until the first
+  // conversion not to slow down the start-up of the server.
+  if (dictionary_.get() == NULL) {
+    dictionary_.reset(new EmbeddedDictionary(token_, token_size_));
+  }
+}
+
+const EmbeddedDictionary::Token *SymbolRewriter::Lookup(
+    const string &key) const {
+  scoped_lock l(&mutex_);
+  BuildDictionaryLocked();
+  return dictionary_->Lookup(key);
+}
+
+void SymbolRewriter::Warmup() {
+  scoped_lock l(&mutex_);
+  BuildDictionaryLocked();
+}
+
+bool SymbolRewriter::TrimMemory() {
+  scoped_lock l(&mutex_);
+  if (dictionary_.get() == NULL) {
+    return false;
+  }
+  dictionary_.reset();
+  return true;
+}
+
 int SymbolRewriter::capability(const ConversionRequest &request) const {
   if (request.request().mixed_conversion()) {
     return RewriterInterface::ALL;
@@ -32,6 +32,7 @@
 
 #include <string>
 
+#include "base/mutex.h"
 #include "base/scoped_ptr.h"
 #include "rewriter/embedded_dictionary.h"
 #include "rewriter/rewriter_interface.h"
@@ -58,11 +59,18 @@ class SymbolRewriter : public RewriterInterface  {
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const;
 
+  virtual void Warmup();
+
+  // Releases the index of the symbol dictionary.
+  virtual bool TrimMemory();
+
  private:
   FRIEND_TEST(SymbolRewriterTest, TriggerRewriteEntireTest);
   FRIEND_TEST(SymbolRewriterTest, TriggerRewriteEachTest);
   FRIEND_TEST(SymbolRewriterTest, TriggerRewriteDescriptionTest);
   FRIEND_TEST(SymbolRewriterTest, SplitDescriptionTest);
+  FRIEND_TEST(SymbolRewriterTest, Warmup);
+  FRIEND_TEST(SymbolRewriterTest, TrimMemory);
 
   // Some characters may have different description for full/half width forms.
   // Here we just change the description in this function.
@@ -101,8 +109,21 @@ class SymbolRewriter : public RewriterInterface  {
   // Insert symbols using single segment.
   bool RewriteEachCandidate(Segments *segments) const;
 
+  // Builds |dictionary_| if it is not built yet.  |mutex_| must be held.
+  void BuildDictionaryLocked() const;
+
+  // Looks up |key| in the dictionary, building its index if it is not built
+  // yet.  The returned token points to the embedded data, so it stays valid
+  // after TrimMemory() releases the index.
+  const EmbeddedDictionary::Token *Lookup(const string &key) const;
+
   const ConverterInterface *parent_converter_;
-  scoped_ptr<EmbeddedDictionary> dictionary_;
+  const EmbeddedDictionary::Token *token_;
+  size_t token_size_;
+  // Guards |dictionary_|, which can be released by TrimMemory() while the
+  // rewriter is used by another thread.
+  mutable Mutex mutex_;
+  mutable scoped_ptr<EmbeddedDictionary> dictionary_;
 };
 
 }  // namespace mozc
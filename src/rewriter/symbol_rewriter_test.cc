@@ -160,6 +160,48 @@ TEST_F(SymbolRewriterTest, TriggerRewriteTest) {
   }
 }
 
+TEST_F(SymbolRewriterTest, Warmup) {
+  SymbolRewriter symbol_rewriter(converter_, data_manager_.get());
+  EXPECT_TRUE(symbol_rewriter.dictionary_.get() == NULL);
+  symbol_rewriter.Warmup();
+  const EmbeddedDictionary *dictionary = symbol_rewriter.dictionary_.get();
+  EXPECT_TRUE(dictionary != NULL);
+
+  // The dictionary built in advance is used by Rewrite().
+  const ConversionRequest request;
+  Segments segments;
+  // "ー"
+  AddSegment("\xe3\x83\xbc", "test", &segments);
+  // ">"
+  AddSegment("\x3e", "test", &segments);
+  EXPECT_TRUE(symbol_rewriter.Rewrite(request, &segments));
+  // "→"
+  EXPECT_TRUE(HasCandidate(segments, 0, "\xe2\x86\x92"));
+  EXPECT_EQ(dictionary, symbol_rewriter.dictionary_.get());
+}
+
+TEST_F(SymbolRewriterTest, TrimMemory) {
+  SymbolRewriter symbol_rewriter(converter_, data_manager_.get());
+  EXPECT_FALSE(symbol_rewriter.TrimMemory());
+  symbol_rewriter.Warmup();
+  EXPECT_TRUE(symbol_rewriter.dictionary_.get() != NULL);
+  EXPECT_TRUE(symbol_rewriter.TrimMemory());
+  EXPECT_TRUE(symbol_rewriter.dictionary_.get() == NULL);
+  EXPECT_FALSE(symbol_rewriter.TrimMemory());
+
+  // The index is built again on the next Rewrite().
+  const ConversionRequest request;
+  Segments segments;
+  // "ー"
+  AddSegment("\xe3\x83\xbc", "test", &segments);
+  // ">"
+  AddSegment("\x3e", "test", &segments);
+  EXPECT_TRUE(symbol_rewriter.Rewrite(request, &segments));
+  // "→"
+  EXPECT_TRUE(HasCandidate(segments, 0, "\xe2\x86\x92"));
+  EXPECT_TRUE(symbol_rewriter.dictionary_.get() != NULL);
+}
+
 TEST_F(SymbolRewriterTest, TriggerRewriteEntireTest) {
   SymbolRewriter symbol_rewriter(converter_, data_manager_.get());
   const ConversionRequest request;
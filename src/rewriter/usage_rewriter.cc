@@ -32,6 +32,7 @@
 #include <string>
 
 #include "base/logging.h"
+#include "base/mutex.h"
 #include "base/util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
@@ -47,38 +48,64 @@ UsageRewriter::UsageRewriter(const DataManagerInterface *data_manager,
                              const DictionaryInterface *dictionary)
     : pos_matcher_(data_manager->GetPOSMatcher()),
       dictionary_(dictionary),
-      base_conjugation_suffix_(NULL) {
-  const ConjugationSuffix *conjugation_suffix_data = NULL;
-  const int *conjugation_suffix_data_index = NULL;
-  const UsageDictItem *usage_data_value = NULL;
+      base_conjugation_suffix_(NULL),
+      conjugation_suffix_data_(NULL),
+      conjugation_suffix_data_index_(NULL),
+      usage_data_value_(NULL) {
   data_manager->GetUsageRewriterData(&base_conjugation_suffix_,
-                                     &conjugation_suffix_data,
-                                     &conjugation_suffix_data_index,
-                                     &usage_data_value);
+                                     &conjugation_suffix_data_,
+                                     &conjugation_suffix_data_index_,
+                                     &usage_data_value_);
   CHECK(base_conjugation_suffix_);
-  CHECK(conjugation_suffix_data);
-  CHECK(conjugation_suffix_data_index);
-  CHECK(conjugation_suffix_data_index);
-  const UsageDictItem *item = usage_data_value;
+  CHECK(conjugation_suffix_data_);
+  CHECK(conjugation_suffix_data_index_);
+  CHECK(usage_data_value_);
+}
+
+UsageRewriter::~UsageRewriter() {
+}
+
+const UsageRewriter::UsageMap &UsageRewriter::GetUsageMapLocked() const {
+  // Expanding all the conjugations takes a while, so it is deferred until
+  // the first conversion not to slow down the start-up of the server.
+  if (key_value_usageitem_map_.get() != NULL) {
+    return *key_value_usageitem_map_;
+  }
+
+  key_value_usageitem_map_.reset(new UsageMap);
+  UsageMap *usage_map = key_value_usageitem_map_.get();
+  const UsageDictItem *item = usage_data_value_;
   // TODO(taku): To reduce memory footprint, better to replace it with
   // binary search over the conjugation_suffix_data diretly.
   for (; item->key != NULL; ++item) {
-    for (size_t i = conjugation_suffix_data_index[item->conjugation_id];
-         i < conjugation_suffix_data_index[item->conjugation_id + 1];
+    for (size_t i = conjugation_suffix_data_index_[item->conjugation_id];
+         i < conjugation_suffix_data_index_[item->conjugation_id + 1];
          ++i) {
       StrPair key_value1(
-          string(item->key) + conjugation_suffix_data[i].key_suffix,
-          string(item->value) + conjugation_suffix_data[i].value_suffix);
-      key_value_usageitem_map_[key_value1] = item;
+          string(item->key) + conjugation_suffix_data_[i].key_suffix,
+          string(item->value) + conjugation_suffix_data_[i].value_suffix);
+      (*usage_map)[key_value1] = item;
       StrPair key_value2(
           "",
-          string(item->value) + conjugation_suffix_data[i].value_suffix);
-      key_value_usageitem_map_[key_value2] = item;
+          string(item->value) + conjugation_suffix_data_[i].value_suffix);
+      (*usage_map)[key_value2] = item;
     }
   }
+  return *usage_map;
 }
 
-UsageRewriter::~UsageRewriter() {
+void UsageRewriter::Warmup() {
+  scoped_lock l(&mutex_);
+  GetUsageMapLocked();
+}
+
+bool UsageRewriter::TrimMemory() {
+  scoped_lock l(&mutex_);
+  if (key_value_usageitem_map_.get() == NULL) {
+    return false;
+  }
+  key_value_usageitem_map_.reset();
+  return true;
 }
 
 // static
@@ -117,6 +144,7 @@ string UsageRewriter::GetKanjiPrefixAndOneHiragana(const string &word) {
 }
 
 const UsageDictItem* UsageRewriter::LookupUnmatchedUsageHeuristically(
+    const UsageMap &usage_map,
     const Segment::Candidate &candidate) const {
   // We check Unknwon POS ("名詞,サ変接続") as well, since
   // target verbs/adjectives may be in web dictionary.
@@ -132,10 +160,9 @@ const UsageDictItem* UsageRewriter::LookupUnmatchedUsageHeuristically(
 
   // key is empty;
   StrPair key_value("", value);
-  const map<StrPair, const UsageDictItem *>::const_iterator itr =
-      key_value_usageitem_map_.find(key_value);
+  const UsageMap::const_iterator itr = usage_map.find(key_value);
   // Check result key part is a prefix of the content_key.
-  if (itr != key_value_usageitem_map_.end() &&
+  if (itr != usage_map.end() &&
       Util::StartsWith(candidate.content_key, itr->second->key)) {
     return itr->second;
   }
@@ -144,17 +171,17 @@ const UsageDictItem* UsageRewriter::LookupUnmatchedUsageHeuristically(
 }
 
 const UsageDictItem* UsageRewriter::LookupUsage(
+    const UsageMap &usage_map,
     const Segment::Candidate &candidate) const {
   const string &key = candidate.content_key;
   const string &value = candidate.content_value;
   StrPair key_value(key, value);
-  const map<StrPair, const UsageDictItem *>::const_iterator itr =
-      key_value_usageitem_map_.find(key_value);
-  if (itr != key_value_usageitem_map_.end()) {
+  const UsageMap::const_iterator itr = usage_map.find(key_value);
+  if (itr != usage_map.end()) {
     return itr->second;
   }
 
-  return LookupUnmatchedUsageHeuristically(candidate);
+  return LookupUnmatchedUsageHeuristically(usage_map, candidate);
 }
 
 bool UsageRewriter::Rewrite(const ConversionRequest &request,
@@ -170,6 +197,10 @@ bool UsageRewriter::Rewrite(const ConversionRequest &request,
     return false;
   }
 
+  // Holds the lock while |usage_map| is used so that TrimMemory() cannot
+  // release it in the middle of the rewrite.
+  scoped_lock l(&mutex_);
+  const UsageMap &usage_map = GetUsageMapLocked();
   bool modified = false;
   // UsageIDs for embedded usage dictionary are generated in advance by
   // gen_usage_rewriter_dictionary_main.cc (which are just sequential numbers).
@@ -178,7 +209,7 @@ bool UsageRewriter::Rewrite(const ConversionRequest &request,
   // dictionary.  Since just the uniqueness in one Segments is sufficient, for
   // usage from the user dictionary, we simply assign sequential numbers larger
   // than the maximum ID of the embedded usage dictionary.
-  int32 usage_id_for_user_comment = key_value_usageitem_map_.size();
+  int32 usage_id_for_user_comment = usage_map.size();
   string comment;
   for (size_t i = 0; i < segments->conversion_segments_size(); ++i) {
     Segment *segment = segments->mutable_conversion_segment(i);
@@ -203,7 +234,8 @@ bool UsageRewriter::Rewrite(const ConversionRequest &request,
 
       // If comment isn't in the user dictionary, search the system usage
       // dictionary.
-      const UsageDictItem *usage = LookupUsage(segment->candidate(j));
+      const UsageDictItem *usage =
+          LookupUsage(usage_map, segment->candidate(j));
       if (usage != NULL) {
         Segment::Candidate *candidate = segment->mutable_candidate(j);
         DCHECK(candidate);
@@ -35,6 +35,8 @@
 #include <string>
 #include <utility>
 
+#include "base/mutex.h"
+#include "base/scoped_ptr.h"
 #include "converter/segments.h"
 #include "rewriter/rewriter_interface.h"
 #include "rewriter/usage_rewriter_data_structs.h"
@@ -60,21 +62,41 @@ class UsageRewriter : public RewriterInterface  {
     return CONVERSION | PREDICTION;
   }
 
+  virtual void Warmup();
+
+  // Releases the map of the conjugated forms.
+  virtual bool TrimMemory();
+
  private:
   FRIEND_TEST(UsageRewriterTest, GetKanjiPrefixAndOneHiragana);
+  FRIEND_TEST(UsageRewriterTest, TrimMemory);
 
   typedef pair<string, string> StrPair;
+  typedef map<StrPair, const UsageDictItem *> UsageMap;
   static string GetKanjiPrefixAndOneHiragana(const string &word);
 
+  // Returns the map from all the conjugated forms to the usage items,
+  // building it if it is not built yet.  |mutex_| must be held while the
+  // returned map is used.
+  const UsageMap &GetUsageMapLocked() const;
+
   const UsageDictItem *LookupUnmatchedUsageHeuristically(
+      const UsageMap &usage_map,
       const Segment::Candidate &candidate) const;
   const UsageDictItem *LookupUsage(
+      const UsageMap &usage_map,
       const Segment::Candidate &candidate) const;
 
-  map<StrPair, const UsageDictItem *> key_value_usageitem_map_;
   const POSMatcher *pos_matcher_;
   const DictionaryInterface *dictionary_;
   const ConjugationSuffix *base_conjugation_suffix_;
+  const ConjugationSuffix *conjugation_suffix_data_;
+  const int *conjugation_suffix_data_index_;
+  const UsageDictItem *usage_data_value_;
+  // Guards |key_value_usageitem_map_|, which can be released by TrimMemory()
+  // while the rewriter is used by another thread.
+  mutable Mutex mutex_;
+  mutable scoped_ptr<UsageMap> key_value_usageitem_map_;
 };
 
 }  // namespace mozc
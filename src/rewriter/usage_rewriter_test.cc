@@ -169,6 +169,33 @@ TEST_F(UsageRewriterTest, SingleSegmentSingleCandidateTest) {
   EXPECT_EQ("", segments.conversion_segment(0).candidate(0).usage_description);
 }
 
+TEST_F(UsageRewriterTest, TrimMemory) {
+  scoped_ptr<UsageRewriter> rewriter(CreateUsageRewriter());
+  EXPECT_FALSE(rewriter->TrimMemory());
+  rewriter->Warmup();
+  EXPECT_TRUE(rewriter->key_value_usageitem_map_.get() != NULL);
+  EXPECT_TRUE(rewriter->TrimMemory());
+  EXPECT_TRUE(rewriter->key_value_usageitem_map_.get() == NULL);
+  EXPECT_FALSE(rewriter->TrimMemory());
+
+  // The map is built again on the next Rewrite().
+  Segments segments;
+  const ConversionRequest request;
+  Segment *seg = segments.push_back_segment();
+  // "あおい"
+  seg->set_key("\xE3\x81\x82\xE3\x81\x8A\xE3\x81\x84");
+  // "あおい", "青い", "あおい", "青い"
+  AddCandidate("\xE3\x81\x82\xE3\x81\x8A\xE3\x81\x84",
+               "\xE9\x9D\x92\xE3\x81\x84",
+               "\xE3\x81\x82\xE3\x81\x8A\xE3\x81\x84",
+               "\xE9\x9D\x92\xE3\x81\x84", seg);
+  EXPECT_TRUE(rewriter->Rewrite(request, &segments));
+  // "青い"
+  EXPECT_EQ("\xE9\x9D\x92\xE3\x81\x84",
+            segments.conversion_segment(0).candidate(0).usage_title);
+  EXPECT_TRUE(rewriter->key_value_usageitem_map_.get() != NULL);
+}
+
 TEST_F(UsageRewriterTest, ConfigTest) {
   Segments segments;
   scoped_ptr<UsageRewriter> rewriter(CreateUsageRewriter());
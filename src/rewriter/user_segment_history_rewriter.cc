@@ -70,6 +70,8 @@ const uint32 kMaxCandidatesSize = 255;
 // Note, if sorting operation is called twice, up to 10 (= 5 * 2) candidates
 // could be reranked in total.
 const size_t kMaxRerankSize = 5;
+// Max number of the features looked up for one candidate in GetScore().
+const size_t kMaxFeaturesSize = 18;
 
 const char kFileName[] = "user://segment.db";
 
@@ -96,6 +98,11 @@ class FeatureValue {
 };
 MOZC_CLANG_POP_WARNING();
 
+struct FeatureFingerprint {
+  uint64 fp;
+  uint32 weight;
+};
+
 bool IsPunctuationInternal(const string &str) {
   // return (str == "。" || str == "｡" ||
   // str == "、" || str == "､" ||
@@ -183,149 +190,162 @@ inline void JoinStringsWithTab2(
       .append(s2.data(), s2.size());
 }
 
-inline void JoinStringsWithTab3(
-    const StringPiece s1, const StringPiece s2, const StringPiece s3,
-    string *output) {
-  // Pre-allocate the buffer, including 2 TAB delimiters.
-  output->reserve(s1.size() + s2.size() + s3.size() + 2);
-  output->assign(s1.data(), s1.size()).append("\t")
-      .append(s2.data(), s2.size()).append("\t")
-      .append(s3.data(), s3.size());
+// GetFeatureKeyN returns the fingerprint of N strings joined with TAB
+// delimiters, which is what LRUStorage computes from the joined feature key.
+// The context features are looked up for every candidate of every segment,
+// so the fingerprint is computed from the fields without building the key.
+inline uint64 GetFeatureKey3(uint32 seed, const StringPiece s1,
+                             const StringPiece s2, const StringPiece s3) {
+  FingerprintBuilder builder(seed);
+  builder.Append(s1);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s2);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s3);
+  return builder.Get();
 }
 
-inline void JoinStringsWithTab4(
-    const StringPiece s1, const StringPiece s2, const StringPiece s3,
-    const StringPiece s4, string *output) {
-  // Pre-allocate the buffer, including 3 TAB delimiters.
-  output->reserve(s1.size() + s2.size() + s3.size() + s4.size() + 3);
-  output->assign(s1.data(), s1.size()).append("\t")
-      .append(s2.data(), s2.size()).append("\t")
-      .append(s3.data(), s3.size()).append("\t")
-      .append(s4.data(), s4.size());
+inline uint64 GetFeatureKey4(uint32 seed, const StringPiece s1,
+                             const StringPiece s2, const StringPiece s3,
+                             const StringPiece s4) {
+  FingerprintBuilder builder(seed);
+  builder.Append(s1);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s2);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s3);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s4);
+  return builder.Get();
 }
 
-inline void JoinStringsWithTab5(
-    const StringPiece s1, const StringPiece s2, const StringPiece s3,
-    const StringPiece s4, const StringPiece s5, string *output) {
-  // Pre-allocate the buffer, including 4 TAB delimiters.
-  output->reserve(
-      s1.size() + s2.size() + s3.size() + s4.size() + s5.size() + 4);
-  output->assign(s1.data(), s1.size()).append("\t")
-      .append(s2.data(), s2.size()).append("\t")
-      .append(s3.data(), s3.size()).append("\t")
-      .append(s4.data(), s4.size()).append("\t")
-      .append(s5.data(), s5.size());
+inline uint64 GetFeatureKey5(uint32 seed, const StringPiece s1,
+                             const StringPiece s2, const StringPiece s3,
+                             const StringPiece s4, const StringPiece s5) {
+  FingerprintBuilder builder(seed);
+  builder.Append(s1);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s2);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s3);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s4);
+  builder.Append(StringPiece("\t", 1));
+  builder.Append(s5);
+  return builder.Get();
 }
 
 // Feature "Left Right"
 inline bool GetFeatureLR(const Segments &segments, size_t i,
                          const string &base_key,
-                         const string &base_value, string *value) {
-  DCHECK(value);
+                         const string &base_value, uint32 seed,
+                         uint64 *fp) {
+  DCHECK(fp);
   if (i + 1 >= segments.segments_size() || i <= 0) {
     return false;
   }
   const int j1 = GetDefaultCandidateIndex(segments.segment(i - 1));
   const int j2 = GetDefaultCandidateIndex(segments.segment(i + 1));
-  JoinStringsWithTab5(StringPiece("LR", 2),
-                      base_key,
-                      segments.segment(i - 1).candidate(j1).value,
-                      base_value,
-                      segments.segment(i + 1).candidate(j2).value,
-                      value);
+  *fp = GetFeatureKey5(seed, StringPiece("LR", 2),
+                       base_key,
+                       segments.segment(i - 1).candidate(j1).value,
+                       base_value,
+                       segments.segment(i + 1).candidate(j2).value);
   return true;
 }
 
 // Feature "Left Left"
 inline bool GetFeatureLL(const Segments &segments, size_t i,
                          const string &base_key,
-                         const string &base_value, string *value) {
-  DCHECK(value);
+                         const string &base_value, uint32 seed,
+                         uint64 *fp) {
+  DCHECK(fp);
   if (i < 2) {
     return false;
   }
   const int j1 = GetDefaultCandidateIndex(segments.segment(i - 2));
   const int j2 = GetDefaultCandidateIndex(segments.segment(i - 1));
-  JoinStringsWithTab5(StringPiece("LL", 2),
-                      base_key,
-                      segments.segment(i - 2).candidate(j1).value,
-                      segments.segment(i - 1).candidate(j2).value,
-                      base_value,
-                      value);
+  *fp = GetFeatureKey5(seed, StringPiece("LL", 2),
+                       base_key,
+                       segments.segment(i - 2).candidate(j1).value,
+                       segments.segment(i - 1).candidate(j2).value,
+                       base_value);
   return true;
 }
 
 // Feature "Right Right"
 inline bool GetFeatureRR(const Segments &segments, size_t i,
                          const string &base_key,
-                         const string &base_value, string *value) {
-  DCHECK(value);
+                         const string &base_value, uint32 seed,
+                         uint64 *fp) {
+  DCHECK(fp);
   if (i + 2 >= segments.segments_size()) {
     return false;
   }
   const int j1 = GetDefaultCandidateIndex(segments.segment(i + 1));
   const int j2 = GetDefaultCandidateIndex(segments.segment(i + 2));
-  JoinStringsWithTab5(StringPiece("RR", 2),
-                      base_key,
-                      base_value,
-                      segments.segment(i + 1).candidate(j1).value,
-                      segments.segment(i + 2).candidate(j2).value,
-                      value);
+  *fp = GetFeatureKey5(seed, StringPiece("RR", 2),
+                       base_key,
+                       base_value,
+                       segments.segment(i + 1).candidate(j1).value,
+                       segments.segment(i + 2).candidate(j2).value);
   return true;
 }
 
 // Feature "Left"
 inline bool GetFeatureL(const Segments &segments, size_t i,
                         const string &base_key,
-                        const string &base_value, string *value) {
-  DCHECK(value);
+                        const string &base_value, uint32 seed,
+                        uint64 *fp) {
+  DCHECK(fp);
   if (i < 1) {
     return false;
   }
   const int j = GetDefaultCandidateIndex(segments.segment(i - 1));
-  JoinStringsWithTab4(StringPiece("L", 1),
-                      base_key,
-                      segments.segment(i - 1).candidate(j).value,
-                      base_value,
-                      value);
+  *fp = GetFeatureKey4(seed, StringPiece("L", 1),
+                       base_key,
+                       segments.segment(i - 1).candidate(j).value,
+                       base_value);
   return true;
 }
 
 // Feature "Right"
 inline bool GetFeatureR(const Segments &segments, size_t i,
                         const string &base_key,
-                        const string &base_value, string *value) {
-  DCHECK(value);
+                        const string &base_value, uint32 seed,
+                        uint64 *fp) {
+  DCHECK(fp);
   if (i + 1 >= segments.segments_size()) {
     return false;
   }
   const int j = GetDefaultCandidateIndex(segments.segment(i + 1));
-  JoinStringsWithTab4(StringPiece("R", 1),
-                      base_key,
-                      base_value,
-                      segments.segment(i + 1).candidate(j).value,
-                      value);
+  *fp = GetFeatureKey4(seed, StringPiece("R", 1),
+                       base_key,
+                       base_value,
+                       segments.segment(i + 1).candidate(j).value);
   return true;
 }
 
 // Feature "Current"
 inline bool GetFeatureC(const Segments &segments, size_t i,
                         const string &base_key,
-                        const string &base_value, string *value) {
-  DCHECK(value);
-  JoinStringsWithTab3(StringPiece("C", 1), base_key, base_value, value);
+                        const string &base_value, uint32 seed,
+                        uint64 *fp) {
+  DCHECK(fp);
+  *fp = GetFeatureKey3(seed, StringPiece("C", 1), base_key, base_value);
   return true;
 }
 
 // Feature "Single"
 inline bool GetFeatureS(const Segments &segments, size_t i,
                         const string &base_key,
-                        const string &base_value, string *value) {
-  DCHECK(value);
+                        const string &base_value, uint32 seed,
+                        uint64 *fp) {
+  DCHECK(fp);
   if (segments.segments_size() - segments.history_segments_size() != 1) {
     return false;
   }
-  JoinStringsWithTab3(StringPiece("S", 1), base_key, base_value, value);
+  *fp = GetFeatureKey3(seed, StringPiece("S", 1), base_key, base_value);
   return true;
 }
 
@@ -535,27 +555,27 @@ UserSegmentHistoryRewriter::~UserSegmentHistoryRewriter() {}
 
 #define INSERT_FEATURE(func, base_key, base_value, force_insert) \
 do { \
-  if (func((segments), segment_index, base_key, base_value, &feature_key)) { \
+  uint64 fp = 0; \
+  if (func((segments), segment_index, base_key, base_value, seed, &fp)) { \
     FeatureValue v; \
     DCHECK(v.IsValid()); \
     if (force_insert) { \
-      storage_->Insert(feature_key, reinterpret_cast<const char *>(&v)); \
+      storage_->InsertByFingerprint(fp, reinterpret_cast<const char *>(&v)); \
     } else { \
-      storage_->TryInsert(feature_key, reinterpret_cast<const char *>(&v)); \
+      storage_->TryInsertByFingerprint( \
+          fp, reinterpret_cast<const char *>(&v)); \
     } \
   } \
 } while (0)
 
-#define FETCH_FEATURE(func, base_key, base_value, weight)        \
+// Collects the fingerprint of the feature and its weight into |features|.
+#define FETCH_FEATURE(func, base_key, base_value, feature_weight) \
 do { \
-  if (func(segments, segment_index, base_key, base_value, &feature_key)) { \
-    const FeatureValue *v = \
-      reinterpret_cast<const FeatureValue *> \
-       (storage_->Lookup(feature_key, &last_access_time_result)); \
-    if (v != NULL && v->IsValid()) { \
-       *score = max(*score, weight);                                     \
-       *last_access_time = max(*last_access_time, last_access_time_result); \
-    } \
+  DCHECK_LT(num_features, arraysize(features)); \
+  if (func(segments, segment_index, base_key, base_value, seed, \
+           &features[num_features].fp)) { \
+    features[num_features].weight = (feature_weight); \
+    ++num_features; \
   } \
 } while (0)
 
@@ -587,9 +607,11 @@ bool UserSegmentHistoryRewriter::GetScore(const Segments &segments,
   *score = 0;
   *last_access_time = 0;
 
-  // They are used inside FETCH_FEATURE
-  uint32 last_access_time_result = 0;
-  string feature_key;
+  // They are used inside FETCH_FEATURE. All the features of the candidate
+  // are collected first and then looked up in the storage together.
+  const uint32 seed = storage_->seed();
+  FeatureFingerprint features[kMaxFeaturesSize];
+  size_t num_features = 0;
 
   const uint32 trigram_score       = (segments_size == 3) ? 180 : 30;
   const uint32 bigram_score        = (segments_size == 2) ? 60  : 10;
@@ -608,27 +630,38 @@ bool UserSegmentHistoryRewriter::GetScore(const Segments &segments,
 
   const bool is_replaceable = Replaceable(top_candidate, candidate);
 
-  if (!context_sensitive && is_replaceable) {
-    FETCH_FEATURE(GetFeatureC,  all_key, all_value, unigram_score);
-  }
+  if (is_replaceable) {
+    if (!context_sensitive) {
+      FETCH_FEATURE(GetFeatureC,  all_key, all_value, unigram_score);
+    }
 
-  if (!is_replaceable) {
-    return (*score > 0);
+    FETCH_FEATURE(GetFeatureLR, content_key, content_value, trigram_score / 2);
+    FETCH_FEATURE(GetFeatureLL, content_key, content_value, trigram_score / 2);
+    FETCH_FEATURE(GetFeatureRR, content_key, content_value, trigram_score / 2);
+    FETCH_FEATURE(GetFeatureL,  content_key, content_value, bigram_score / 2);
+    FETCH_FEATURE(GetFeatureR,  content_key, content_value, bigram_score / 2);
+    FETCH_FEATURE(GetFeatureS,  content_key, content_value, single_score / 2);
+    FETCH_FEATURE(GetFeatureLN, content_key,
+                  content_value, bigram_number_score / 2);
+    FETCH_FEATURE(GetFeatureRN, content_key,
+                  content_value, bigram_number_score / 2);
+
+    if (!context_sensitive) {
+      FETCH_FEATURE(GetFeatureC, content_key, content_value,
+                    unigram_score / 2);
+    }
   }
 
-  FETCH_FEATURE(GetFeatureLR, content_key, content_value, trigram_score / 2);
-  FETCH_FEATURE(GetFeatureLL, content_key, content_value, trigram_score / 2);
-  FETCH_FEATURE(GetFeatureRR, content_key, content_value, trigram_score / 2);
-  FETCH_FEATURE(GetFeatureL,  content_key, content_value, bigram_score / 2);
-  FETCH_FEATURE(GetFeatureR,  content_key, content_value, bigram_score / 2);
-  FETCH_FEATURE(GetFeatureS,  content_key, content_value, single_score / 2);
-  FETCH_FEATURE(GetFeatureLN, content_key,
-                content_value, bigram_number_score / 2);
-  FETCH_FEATURE(GetFeatureRN, content_key,
-                content_value, bigram_number_score / 2);
-
-  if (!context_sensitive) {
-    FETCH_FEATURE(GetFeatureC,  content_key, content_value, unigram_score / 2);
+  for (size_t i = 0; i < num_features; ++i) {
+    uint32 last_access_time_result = 0;
+    const FeatureValue *v =
+      reinterpret_cast<const FeatureValue *>
+       (storage_->LookupByFingerprint(features[i].fp,
+                                      &last_access_time_result));
+    if (v != NULL && v->IsValid()) {
+      *score = max(*score, features[i].weight);
+      *last_access_time = max(*last_access_time, last_access_time_result);
+    }
   }
 
   return (*score > 0);
@@ -714,8 +747,8 @@ void UserSegmentHistoryRewriter::RememberFirstCandidate(
   const bool is_replaceable_with_top =
       ((top_index == 0) || Replaceable(seg.candidate(top_index), candidate));
 
-  // |feature_key| is used inside INSERT_FEATURE
-  string feature_key;
+  // |seed| is used inside INSERT_FEATURE
+  const uint32 seed = storage_->seed();
   INSERT_FEATURE(GetFeatureLR, all_key, all_value, force_insert);
   INSERT_FEATURE(GetFeatureLL, all_key, all_value, force_insert);
   INSERT_FEATURE(GetFeatureRR, all_key, all_value, force_insert);
@@ -1052,8 +1085,9 @@ bool UserSegmentHistoryRewriter::GetFeatureLN(const Segments &segments,
                                               size_t i,
                                               const string &base_key,
                                               const string &base_value,
-                                              string *value) const {
-  DCHECK(value);
+                                              uint32 seed,
+                                              uint64 *fp) const {
+  DCHECK(fp);
   if (i < 1) {
     return false;
   }
@@ -1062,7 +1096,7 @@ bool UserSegmentHistoryRewriter::GetFeatureLN(const Segments &segments,
   if (pos_matcher_->IsNumber(candidate.rid) ||
       pos_matcher_->IsKanjiNumber(candidate.rid) ||
       Util::GetScriptType(candidate.value) == Util::NUMBER) {
-    JoinStringsWithTab3(StringPiece("LN", 2), base_key, base_value, value);
+    *fp = GetFeatureKey3(seed, StringPiece("LN", 2), base_key, base_value);
     return true;
   }
   return false;
@@ -1073,8 +1107,9 @@ bool UserSegmentHistoryRewriter::GetFeatureRN(const Segments &segments,
                                               size_t i,
                                               const string &base_key,
                                               const string &base_value,
-                                              string *value) const {
-  DCHECK(value);
+                                              uint32 seed,
+                                              uint64 *fp) const {
+  DCHECK(fp);
   if (i + 1 >= segments.segments_size()) {
     return false;
   }
@@ -1083,7 +1118,7 @@ bool UserSegmentHistoryRewriter::GetFeatureRN(const Segments &segments,
   if (pos_matcher_->IsNumber(candidate.lid) ||
       pos_matcher_->IsKanjiNumber(candidate.lid) ||
       Util::GetScriptType(candidate.value) == Util::NUMBER) {
-    JoinStringsWithTab3(StringPiece("RN", 2), base_key, base_value, value);
+    *fp = GetFeatureKey3(seed, StringPiece("RN", 2), base_key, base_value);
     return true;
   }
   return false;
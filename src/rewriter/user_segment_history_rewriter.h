@@ -94,12 +94,14 @@ class UserSegmentHistoryRewriter : public RewriterInterface {
                     size_t i,
                     const string &base_key,
                     const string &base_value,
-                    string *value) const;
+                    uint32 seed,
+                    uint64 *fp) const;
   bool GetFeatureRN(const Segments &segments,
                     size_t i,
                     const string &base_key,
                     const string &base_value,
-                    string *value) const;
+                    uint32 seed,
+                    uint64 *fp) const;
   bool SortCandidates(const vector<ScoreType> &sorted_scores,
                       Segment *segment) const;
 
@@ -37,6 +37,7 @@
 #include "converter/conversion_request.h"
 #include "converter/segments.h"
 #include "dictionary/pos_matcher.h"
+#include "rewriter/rewrite_trigger.h"
 
 namespace mozc {
 
@@ -129,6 +130,12 @@ ZipcodeRewriter::ZipcodeRewriter(const POSMatcher *pos_matcher)
 
 ZipcodeRewriter::~ZipcodeRewriter() {}
 
+bool ZipcodeRewriter::MayRewrite(const RewriteTrigger &trigger) const {
+  // Zipcode entries are looked up by a key of digits.
+  return trigger.conversion_segments_size() == 1 &&
+      trigger.HasKeyCharType(RewriteTrigger::NUMBER_KEY);
+}
+
 bool ZipcodeRewriter::Rewrite(const ConversionRequest &request,
                               Segments *segments) const {
   if (segments->conversion_segments_size() != 1) {
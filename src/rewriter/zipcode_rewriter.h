@@ -45,6 +45,8 @@ class ZipcodeRewriter : public RewriterInterface  {
   explicit ZipcodeRewriter(const POSMatcher *pos_matcher);
   virtual ~ZipcodeRewriter();
 
+  virtual bool MayRewrite(const RewriteTrigger &trigger) const;
+
   virtual bool Rewrite(const ConversionRequest &request,
                        Segments *segments) const;
 
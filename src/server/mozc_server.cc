@@ -34,21 +34,34 @@
 #endif
 
 #include <cstddef>
+#include <iostream>
 #include <string>
 
 #include "base/init.h"
 #include "base/crash_report_handler.h"
+#include "base/flags.h"
 #include "base/logging.h"
 #include "base/process_mutex.h"
 #include "base/run_level.h"
+#include "base/startup_trace.h"
 #include "base/system_util.h"
 #include "config/stats_config_util.h"
+#include "ipc/ipc.h"
+#include "session/commands.pb.h"
 #include "session/session_server.h"
 
+DEFINE_bool(exit_after_initialization, false,
+            "If true, the server creates and deletes a session by itself "
+            "right after the initialization, and exits without serving "
+            "clients.  Used to benchmark the start-up with "
+            "--startup_trace_file.");
+
 DECLARE_bool(restricted);   // in SessionHandler
 
 namespace {
 mozc::SessionServer *g_session_server = NULL;
+// The time when the server process started, in micro seconds.
+uint64 g_start_usec = 0;
 }
 
 namespace mozc {
@@ -70,6 +83,51 @@ void ShutdownSessionCallback() {
 REGISTER_MODULE_SHUTDOWN_HANDLER(shutdown_session,
                                  ShutdownSessionCallback());
 #endif  // !OS_WIN
+
+// Sends |input| to |session_server| in the same way as the IPC clients.
+bool SendCommand(SessionServer *session_server,
+                 const commands::Input &input,
+                 commands::Output *output) {
+  string request;
+  if (!input.SerializeToString(&request)) {
+    return false;
+  }
+  scoped_ptr<char[]> response(new char[IPC_RESPONSESIZE]);
+  size_t response_size = IPC_RESPONSESIZE;
+  if (!session_server->Process(request.data(), request.size(),
+                               response.get(), &response_size)) {
+    return false;
+  }
+  return output->ParseFromArray(response.get(), response_size);
+}
+
+// Creates and deletes a session as the first client does, and reports the
+// time spent from the process start.
+bool RunFirstSession(SessionServer *session_server) {
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::CREATE_SESSION);
+  if (!SendCommand(session_server, input, &output) ||
+      output.error_code() != commands::Output::SESSION_SUCCESS) {
+    LOG(ERROR) << "CREATE_SESSION failed";
+    return false;
+  }
+  const uint64 elapsed_usec = StartupTrace::GetCurrentTimeUsec() - g_start_usec;
+
+  input.Clear();
+  input.set_type(commands::Input::DELETE_SESSION);
+  input.set_id(output.id());
+  output.Clear();
+  if (!SendCommand(session_server, input, &output)) {
+    LOG(ERROR) << "DELETE_SESSION failed";
+    return false;
+  }
+
+  LOG(INFO) << "The first session is created in " << elapsed_usec
+            << " usec from the process start";
+  cout << "startup_usec: " << elapsed_usec << endl;
+  return true;
+}
 }  // namespace
 
 namespace server {
@@ -78,6 +136,8 @@ void InitGoogleAndMozcServer(const char *arg0,
                              int *argc,
                              char ***argv,
                              bool remove_flags) {
+  // The flags are not parsed yet, so the event is added after InitGoogle().
+  g_start_usec = StartupTrace::GetCurrentTimeUsec();
   mozc::SystemUtil::DisableIME();
 
   // Big endian is not supported. The storage for user history is endian
@@ -105,6 +165,7 @@ void InitGoogleAndMozcServer(const char *arg0,
     mozc::CrashReportHandler::Initialize(false);
   }
   InitGoogle(arg0, argc, argv, remove_flags);
+  StartupTrace::AddEvent("InitGoogleAndMozcServer", g_start_usec);
 
   if (run_level == mozc::RunLevel::RESTRICTED) {
     VLOG(1) << "Mozc server starts with timeout mode";
@@ -123,15 +184,26 @@ int MozcServer::Run() {
   }
 
   {
-    scoped_ptr<mozc::SessionServer> session_server
-        (new mozc::SessionServer);
+    scoped_ptr<mozc::SessionServer> session_server;
+    {
+      ScopedStartupTrace trace("SessionServer");
+      session_server.reset(new mozc::SessionServer);
+    }
     g_session_server = session_server.get();
     CHECK(g_session_server);
     if (!g_session_server->Connected()) {
       LOG(ERROR) << "SessionServer initialization failed";
+      StartupTrace::Finish();
       return -1;
     }
 
+    if (FLAGS_exit_after_initialization) {
+      const bool result = RunFirstSession(g_session_server);
+      StartupTrace::Finish();
+      g_session_server = NULL;
+      return result ? 0 : -1;
+    }
+
 #if defined(OS_WIN)
     // On Windows, ShutdownSessionCallback is not called intentionally in order
     // to avoid crashes oritinates from it. See b/2696087.
@@ -146,6 +218,8 @@ int MozcServer::Run() {
     // Wait until the session server thread finishes.
     g_session_server->Wait();
 #endif
+    // Writes the trace if no session has been created.
+    StartupTrace::Finish();
   }
 
   return 0;
@@ -0,0 +1,168 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "session/candidate_list_delta.h"
+
+#include <string>
+
+#include "base/hash_tables.h"
+#include "base/logging.h"
+#include "session/candidates.pb.h"
+
+namespace mozc {
+namespace {
+
+bool AnnotationEquals(const commands::Annotation &a,
+                      const commands::Annotation &b) {
+  return a.has_prefix() == b.has_prefix() && a.prefix() == b.prefix() &&
+      a.has_suffix() == b.has_suffix() && a.suffix() == b.suffix() &&
+      a.has_description() == b.has_description() &&
+      a.description() == b.description() &&
+      a.has_shortcut() == b.has_shortcut() && a.shortcut() == b.shortcut() &&
+      a.has_deletable() == b.has_deletable() &&
+      a.deletable() == b.deletable();
+}
+
+// Returns true if |a| and |b| are the same except their indices.
+bool WordEquals(const commands::CandidateWord &a,
+                const commands::CandidateWord &b) {
+  if (a.has_id() != b.has_id() || a.id() != b.id() ||
+      a.has_key() != b.has_key() || a.key() != b.key() ||
+      a.has_value() != b.has_value() || a.value() != b.value() ||
+      a.has_annotation() != b.has_annotation()) {
+    return false;
+  }
+  return !a.has_annotation() ||
+      AnnotationEquals(a.annotation(), b.annotation());
+}
+
+}  // namespace
+
+void CandidateListDelta::Encode(const commands::CandidateList &base,
+                                const commands::CandidateList &target,
+                                commands::CandidateList *delta) {
+  DCHECK(delta);
+  DCHECK(base.has_sequence_number());
+  DCHECK(target.has_sequence_number());
+  delta->Clear();
+  if (target.has_focused_index()) {
+    delta->set_focused_index(target.focused_index());
+  }
+  if (target.has_category()) {
+    delta->set_category(target.category());
+  }
+  delta->set_sequence_number(target.sequence_number());
+  delta->set_base_sequence_number(base.sequence_number());
+
+  // Moving the focus or paging keeps the list as it is, so the common prefix
+  // usually covers the whole list.
+  int prefix_size = 0;
+  while (prefix_size < base.candidates_size() &&
+         prefix_size < target.candidates_size() &&
+         base.candidates(prefix_size).index() ==
+             target.candidates(prefix_size).index() &&
+         WordEquals(base.candidates(prefix_size),
+                    target.candidates(prefix_size))) {
+    ++prefix_size;
+  }
+  delta->set_copied_prefix_size(prefix_size);
+  if (prefix_size == target.candidates_size()) {
+    return;
+  }
+
+  // The remaining words refer to the words of |base| with the same value
+  // when possible, which covers re-ranked candidates.
+  hash_map<string, int> base_indices;
+  for (int i = base.candidates_size() - 1; i >= prefix_size; --i) {
+    base_indices[base.candidates(i).value()] = i;
+  }
+  for (int i = prefix_size; i < target.candidates_size(); ++i) {
+    const commands::CandidateWord &word = target.candidates(i);
+    commands::CandidateWord *delta_word = delta->add_candidates();
+    const hash_map<string, int>::const_iterator it =
+        base_indices.find(word.value());
+    if (it != base_indices.end() &&
+        WordEquals(base.candidates(it->second), word)) {
+      delta_word->set_index(word.index());
+      delta_word->set_base_index(it->second);
+    } else {
+      delta_word->CopyFrom(word);
+    }
+  }
+}
+
+bool CandidateListDelta::Decode(const commands::CandidateList &base,
+                                const commands::CandidateList &delta,
+                                commands::CandidateList *target) {
+  DCHECK(target);
+  DCHECK_NE(&base, target);
+  DCHECK_NE(&delta, target);
+  if (!delta.has_base_sequence_number()) {
+    target->CopyFrom(delta);
+    return true;
+  }
+  if (!base.has_sequence_number() ||
+      base.sequence_number() != delta.base_sequence_number() ||
+      delta.copied_prefix_size() >
+          static_cast<uint32>(base.candidates_size())) {
+    LOG(ERROR) << "Unexpected base of the candidate list: "
+               << delta.base_sequence_number();
+    return false;
+  }
+
+  target->Clear();
+  for (size_t i = 0; i < delta.copied_prefix_size(); ++i) {
+    target->add_candidates()->CopyFrom(base.candidates(i));
+  }
+  for (size_t i = 0; i < delta.candidates_size(); ++i) {
+    const commands::CandidateWord &word = delta.candidates(i);
+    commands::CandidateWord *target_word = target->add_candidates();
+    if (!word.has_base_index()) {
+      target_word->CopyFrom(word);
+      continue;
+    }
+    if (word.base_index() >= static_cast<uint32>(base.candidates_size())) {
+      LOG(ERROR) << "Invalid base index: " << word.base_index();
+      target->Clear();
+      return false;
+    }
+    target_word->CopyFrom(base.candidates(word.base_index()));
+    target_word->set_index(word.index());
+  }
+  if (delta.has_focused_index()) {
+    target->set_focused_index(delta.focused_index());
+  }
+  if (delta.has_category()) {
+    target->set_category(delta.category());
+  }
+  target->set_sequence_number(delta.sequence_number());
+  return true;
+}
+
+}  // namespace mozc
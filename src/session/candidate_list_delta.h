@@ -0,0 +1,63 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_SESSION_CANDIDATE_LIST_DELTA_H_
+#define MOZC_SESSION_CANDIDATE_LIST_DELTA_H_
+
+#include "base/port.h"
+
+namespace mozc {
+namespace commands {
+class CandidateList;
+}  // namespace commands
+
+// This class consists of functions to make and apply incremental updates of
+// mozc::commands::CandidateList, which are sent as
+// Output::all_candidate_words when the client has the capability.
+class CandidateListDelta {
+ public:
+  // Makes |delta|, an incremental update which reconstructs |target| from
+  // |base|.  Both |base| and |target| must have sequence_number.
+  static void Encode(const commands::CandidateList &base,
+                     const commands::CandidateList &target,
+                     commands::CandidateList *delta);
+
+  // Reconstructs the complete list from |base| and |delta| into |target|.
+  // When |delta| is a complete list, it is copied as it is.  Returns false
+  // if |delta| is an update against a list other than |base|.
+  static bool Decode(const commands::CandidateList &base,
+                     const commands::CandidateList &delta,
+                     commands::CandidateList *target);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(CandidateListDelta);
+};
+
+}  // namespace mozc
+#endif  // MOZC_SESSION_CANDIDATE_LIST_DELTA_H_
@@ -0,0 +1,152 @@
+// Copyright 2010-2014, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "session/candidate_list_delta.h"
+
+#include <string>
+
+#include "base/number_util.h"
+#include "session/candidates.pb.h"
+#include "testing/base/public/gunit.h"
+
+namespace mozc {
+namespace {
+
+void AddWord(const string &value, commands::CandidateList *list) {
+  commands::CandidateWord *word = list->add_candidates();
+  word->set_id(list->candidates_size() - 1);
+  word->set_index(list->candidates_size() - 1);
+  word->set_key("key");
+  word->set_value(value);
+}
+
+void ExpectRoundTrip(const commands::CandidateList &base,
+                     const commands::CandidateList &target) {
+  commands::CandidateList delta;
+  CandidateListDelta::Encode(base, target, &delta);
+  EXPECT_EQ(base.sequence_number(), delta.base_sequence_number());
+  commands::CandidateList decoded;
+  EXPECT_TRUE(CandidateListDelta::Decode(base, delta, &decoded));
+  EXPECT_EQ(target.SerializeAsString(), decoded.SerializeAsString());
+}
+
+TEST(CandidateListDeltaTest, FocusChange) {
+  commands::CandidateList base;
+  base.set_sequence_number(1);
+  base.set_focused_index(0);
+  for (int i = 0; i < 100; ++i) {
+    AddWord("value" + NumberUtil::SimpleItoa(i), &base);
+  }
+  commands::CandidateList target;
+  target.CopyFrom(base);
+  target.set_sequence_number(2);
+  target.set_focused_index(10);
+
+  commands::CandidateList delta;
+  CandidateListDelta::Encode(base, target, &delta);
+  EXPECT_EQ(100, delta.copied_prefix_size());
+  EXPECT_EQ(0, delta.candidates_size());
+  EXPECT_LT(delta.ByteSize() * 10, target.ByteSize());
+  ExpectRoundTrip(base, target);
+}
+
+TEST(CandidateListDeltaTest, AddRemoveAndRerank) {
+  commands::CandidateList base;
+  base.set_sequence_number(1);
+  AddWord("a", &base);
+  AddWord("b", &base);
+  AddWord("c", &base);
+  AddWord("d", &base);
+  base.mutable_candidates(3)->mutable_annotation()->set_description("desc");
+
+  // "a" is kept, "b" is removed, "e" is added and "d" and "c" are swapped.
+  commands::CandidateList target;
+  target.set_sequence_number(2);
+  target.set_category(commands::PREDICTION);
+  AddWord("a", &target);
+  AddWord("e", &target);
+  target.add_candidates()->CopyFrom(base.candidates(3));
+  target.mutable_candidates(2)->set_index(2);
+  target.add_candidates()->CopyFrom(base.candidates(2));
+  target.mutable_candidates(3)->set_index(3);
+
+  commands::CandidateList delta;
+  CandidateListDelta::Encode(base, target, &delta);
+  EXPECT_EQ(1, delta.copied_prefix_size());
+  ASSERT_EQ(3, delta.candidates_size());
+  EXPECT_FALSE(delta.candidates(0).has_base_index());
+  EXPECT_EQ("e", delta.candidates(0).value());
+  EXPECT_EQ(3, delta.candidates(1).base_index());
+  EXPECT_FALSE(delta.candidates(1).has_value());
+  EXPECT_EQ(2, delta.candidates(2).base_index());
+  ExpectRoundTrip(base, target);
+
+  // A word with a different annotation is sent as it is.
+  target.mutable_candidates(2)->mutable_annotation()->set_description("new");
+  CandidateListDelta::Encode(base, target, &delta);
+  ASSERT_EQ(3, delta.candidates_size());
+  EXPECT_FALSE(delta.candidates(1).has_base_index());
+  ExpectRoundTrip(base, target);
+
+  // Shrinks the list.
+  target.Clear();
+  target.set_sequence_number(3);
+  ExpectRoundTrip(base, target);
+}
+
+TEST(CandidateListDeltaTest, Decode) {
+  commands::CandidateList base;
+  base.set_sequence_number(1);
+  AddWord("a", &base);
+
+  // A complete list is copied as it is.
+  commands::CandidateList list;
+  list.set_sequence_number(2);
+  AddWord("b", &list);
+  commands::CandidateList decoded;
+  EXPECT_TRUE(CandidateListDelta::Decode(base, list, &decoded));
+  EXPECT_EQ(list.SerializeAsString(), decoded.SerializeAsString());
+
+  // An update against another list.
+  commands::CandidateList delta;
+  delta.set_sequence_number(3);
+  delta.set_base_sequence_number(2);
+  EXPECT_FALSE(CandidateListDelta::Decode(base, delta, &decoded));
+
+  // Invalid indices.
+  delta.set_base_sequence_number(1);
+  delta.set_copied_prefix_size(2);
+  EXPECT_FALSE(CandidateListDelta::Decode(base, delta, &decoded));
+  delta.set_copied_prefix_size(0);
+  delta.add_candidates()->set_base_index(1);
+  EXPECT_FALSE(CandidateListDelta::Decode(base, delta, &decoded));
+}
+
+}  // namespace
+}  // namespace mozc
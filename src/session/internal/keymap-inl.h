@@ -32,6 +32,8 @@
 #ifndef MOZC_SESSION_INTERNAL_KEYMAP_INL_H_
 #define MOZC_SESSION_INTERNAL_KEYMAP_INL_H_
 
+#include "base/logging.h"
+#include "base/port.h"
 #include "session/internal/keymap.h"
 #include "session/key_event_util.h"
 
@@ -55,16 +57,20 @@ bool KeyMap<T>::GetCommand(const commands::KeyEvent &key_event,
     return false;
   }
 
-  typename KeyToCommandMap::const_iterator it = keymap_.find(key);
-  if (it != keymap_.end()) {
-    *command = it->second;
+  if (size_ == 0) {
+    return false;
+  }
+
+  const Entry *entry = &entries_[FindSlot(key)];
+  if (entry->used) {
+    *command = entry->command;
     return true;
   }
 
   if (KeyEventUtil::MaybeGetKeyStub(normalized_key_event, &key)) {
-    it = keymap_.find(key);
-    if (it != keymap_.end()) {
-      *command = it->second;
+    entry = &entries_[FindSlot(key)];
+    if (entry->used) {
+      *command = entry->command;
       return true;
     }
   }
@@ -80,13 +86,47 @@ bool KeyMap<T>::AddRule(const commands::KeyEvent &key_event,
     return false;
   }
 
-  keymap_[key] = command;
+  if ((size_ + 1) * 2 > entries_.size()) {
+    Rehash(entries_.empty() ? 16 : entries_.size() * 2);
+  }
+  Entry *entry = &entries_[FindSlot(key)];
+  if (!entry->used) {
+    entry->key = key;
+    entry->used = true;
+    ++size_;
+  }
+  entry->command = command;
   return true;
 }
 
 template<typename T>
 void KeyMap<T>::Clear() {
-  keymap_.clear();
+  entries_.clear();
+  size_ = 0;
+}
+
+template<typename T>
+size_t KeyMap<T>::FindSlot(KeyInformation key) const {
+  DCHECK(!entries_.empty());
+  const size_t mask = entries_.size() - 1;
+  // Fibonacci hashing spreads the modifier and the key code bits.
+  size_t slot = static_cast<size_t>(
+      (key * GG_ULONGLONG(0x9E3779B97F4A7C15)) >> 32) & mask;
+  while (entries_[slot].used && entries_[slot].key != key) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+template<typename T>
+void KeyMap<T>::Rehash(size_t capacity) {
+  vector<Entry> old_entries(capacity);
+  old_entries.swap(entries_);
+  for (size_t i = 0; i < old_entries.size(); ++i) {
+    if (old_entries[i].used) {
+      entries_[FindSlot(old_entries[i].key)] = old_entries[i];
+    }
+  }
 }
 
 }  // namespace keymap
@@ -41,6 +41,7 @@
 #include "base/logging.h"
 #include "base/port.h"
 #include "base/scoped_ptr.h"
+#include "base/startup_trace.h"
 #include "base/util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
@@ -83,8 +84,21 @@ bool KeyMapManager::ReloadWithKeymap(
   if (new_keymap == keymap_ && new_keymap != config::Config::CUSTOM) {
     return true;
   }
+  // KeyMapFactory calls this method for every key event, so CUSTOM keymap
+  // is reloaded only when the table in the config has been changed.
+  if (new_keymap == config::Config::CUSTOM &&
+      keymap_ == config::Config::CUSTOM &&
+      custom_keymap_table_ == GET_CONFIG(custom_keymap_table)) {
+    return true;
+  }
 
+  ScopedStartupTrace trace("KeyMapManager::ReloadWithKeymap");
   keymap_ = new_keymap;
+  if (new_keymap == config::Config::CUSTOM) {
+    custom_keymap_table_ = GET_CONFIG(custom_keymap_table);
+  } else {
+    custom_keymap_table_.clear();
+  }
   const char *keymap_file = GetKeyMapFileName(new_keymap);
 
   // Clear the previous keymaps.
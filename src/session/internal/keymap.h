@@ -36,6 +36,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include "config/config.pb.h"
 #include "session/internal/keymap_interface.h"
 #include "session/key_event_util.h"
@@ -53,14 +54,29 @@ class KeyMap : public KeyMapInterface<typename T::Commands> {
  public:
   typedef typename T::Commands CommandsType;
 
+  KeyMap() : size_(0) {}
+
   bool GetCommand(const commands::KeyEvent &key_event,
                   CommandsType *command) const;
   bool AddRule(const commands::KeyEvent &key_event, CommandsType command);
   void Clear();
 
  private:
-  typedef map<KeyInformation, CommandsType> KeyToCommandMap;
-  KeyToCommandMap keymap_;
+  struct Entry {
+    KeyInformation key;
+    CommandsType command;
+    bool used;
+  };
+
+  // Returns the slot of |key|, which is unused if |key| is not registered.
+  size_t FindSlot(KeyInformation key) const;
+  void Rehash(size_t capacity);
+
+  // Open addressing hash table with linear probing.  The capacity is a
+  // power of two and at most half of the slots are used, so a lookup
+  // usually touches a single cache line.
+  vector<Entry> entries_;
+  size_t size_;
 };
 
 class KeyMapManager {
@@ -147,6 +163,9 @@ class KeyMapManager {
                                  ConversionState::Commands command);
 
   config::Config::SessionKeymap keymap_;
+  // The table loaded for config::Config::CUSTOM, to skip reloading it when
+  // it has not changed.
+  string custom_keymap_table_;
   map<string, DirectInputState::Commands> command_direct_map_;
   map<string, PrecompositionState::Commands> command_precomposition_map_;
   map<string, CompositionState::Commands> command_composition_map_;
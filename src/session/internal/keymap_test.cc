@@ -180,6 +180,44 @@ TEST_F(KeyMapTest, GetCommand) {
   }
 }
 
+TEST_F(KeyMapTest, ManyRules) {
+  KeyMap<CompositionState> keymap;
+  commands::KeyEvent key_event;
+  CompositionState::Commands command;
+
+  // Registers enough rules to grow the table several times.
+  for (int code = 33; code < 127; ++code) {
+    key_event.Clear();
+    key_event.set_key_code(code);
+    EXPECT_TRUE(keymap.AddRule(key_event, CompositionState::COMMIT));
+    key_event.add_modifier_keys(commands::KeyEvent::ALT);
+    EXPECT_TRUE(keymap.AddRule(key_event, CompositionState::CANCEL));
+  }
+  // Overwrites an existing rule.
+  key_event.Clear();
+  key_event.set_key_code(97);
+  EXPECT_TRUE(keymap.AddRule(key_event, CompositionState::IME_OFF));
+
+  for (int code = 33; code < 127; ++code) {
+    key_event.Clear();
+    key_event.set_key_code(code);
+    EXPECT_TRUE(keymap.GetCommand(key_event, &command));
+    EXPECT_EQ(code == 97 ? CompositionState::IME_OFF : CompositionState::COMMIT,
+              command);
+    key_event.add_modifier_keys(commands::KeyEvent::ALT);
+    EXPECT_TRUE(keymap.GetCommand(key_event, &command));
+    EXPECT_EQ(CompositionState::CANCEL, command);
+  }
+  key_event.Clear();
+  key_event.set_special_key(commands::KeyEvent::ENTER);
+  EXPECT_FALSE(keymap.GetCommand(key_event, &command));
+
+  keymap.Clear();
+  key_event.Clear();
+  key_event.set_key_code(97);
+  EXPECT_FALSE(keymap.GetCommand(key_event, &command));
+}
+
 TEST_F(KeyMapTest, GetCommandForKeyString) {
   KeyMap<PrecompositionState> keymap;
 
@@ -560,6 +598,44 @@ TEST_F(KeyMapTest, ReloadWithKeymap) {
   }
 }
 
+TEST_F(KeyMapTest, ReloadWithCustomKeymap) {
+  KeyMapManager manager;
+  commands::KeyEvent key_event;
+  ConversionState::Commands conv_command;
+  KeyParser::ParseKey("Right", &key_event);
+
+  config::Config config;
+  config::ConfigHandler::GetConfig(&config);
+  config.set_session_keymap(config::Config::CUSTOM);
+  config.set_custom_keymap_table(
+      "status\tkey\tcommand\n"
+      "Conversion\tRight\tSegmentWidthExpand\n");
+  config::ConfigHandler::SetConfig(config);
+  EXPECT_TRUE(manager.ReloadWithKeymap(config::Config::CUSTOM));
+  EXPECT_TRUE(manager.GetCommandConversion(key_event, &conv_command));
+  EXPECT_EQ(ConversionState::SEGMENT_WIDTH_EXPAND, conv_command);
+
+  // The same table is not reloaded, and the rules stay available.
+  EXPECT_TRUE(manager.ReloadWithKeymap(config::Config::CUSTOM));
+  EXPECT_TRUE(manager.GetCommandConversion(key_event, &conv_command));
+  EXPECT_EQ(ConversionState::SEGMENT_WIDTH_EXPAND, conv_command);
+
+  // A modified table is reloaded.
+  config.set_custom_keymap_table(
+      "status\tkey\tcommand\n"
+      "Conversion\tRight\tSegmentFocusRight\n");
+  config::ConfigHandler::SetConfig(config);
+  EXPECT_TRUE(manager.ReloadWithKeymap(config::Config::CUSTOM));
+  EXPECT_TRUE(manager.GetCommandConversion(key_event, &conv_command));
+  EXPECT_EQ(ConversionState::SEGMENT_FOCUS_RIGHT, conv_command);
+
+  // Switching to a preset keymap and back reloads the custom table.
+  EXPECT_TRUE(manager.ReloadWithKeymap(config::Config::ATOK));
+  EXPECT_TRUE(manager.ReloadWithKeymap(config::Config::CUSTOM));
+  EXPECT_TRUE(manager.GetCommandConversion(key_event, &conv_command));
+  EXPECT_EQ(ConversionState::SEGMENT_FOCUS_RIGHT, conv_command);
+}
+
 TEST_F(KeyMapTest, AddCommand) {
   KeyMapManager manager;
   commands::KeyEvent key_event;
@@ -58,6 +58,7 @@
 #include "session/internal/keymap.h"
 #include "session/internal/keymap_factory.h"
 #include "session/internal/session_output.h"
+#include "session/candidate_list_delta.h"
 #include "session/key_event_util.h"
 #include "session/session_converter.h"
 #include "session/session_usage_stats_util.h"
@@ -217,7 +218,10 @@ ImeContext::State GetEffectiveStateForTestSendKey(
 
 // TODO(komatsu): Remove these argument by using/making singletons.
 Session::Session(EngineInterface *engine)
-    : engine_(engine), context_(new ImeContext) {
+    : engine_(engine), context_(new ImeContext),
+      last_all_candidate_words_(new commands::CandidateList),
+      all_candidate_words_sequence_number_(0),
+      deferred_suggestion_pending_(false) {
   InitContext(context_.get());
 }
 
@@ -241,6 +245,46 @@ void Session::InitContext(ImeContext *context) const {
   UpdateConfig(config::ConfigHandler::GetConfig(), context);
 }
 
+void Session::EncodeIncrementalOutput(commands::Command *command) {
+  if (!context_->client_capability().incremental_all_candidate_words() ||
+      !command->output().has_all_candidate_words()) {
+    return;
+  }
+  commands::CandidateList *list =
+      command->mutable_output()->mutable_all_candidate_words();
+  list->set_sequence_number(++all_candidate_words_sequence_number_);
+
+  // The update is made only against the list the client says it holds, so
+  // that a lost response does not break the client's list.
+  const commands::Input &input = command->input();
+  if (input.has_all_candidate_words_sequence_number() &&
+      last_all_candidate_words_->has_sequence_number() &&
+      input.all_candidate_words_sequence_number() ==
+          last_all_candidate_words_->sequence_number()) {
+    commands::CandidateList delta;
+    CandidateListDelta::Encode(*last_all_candidate_words_, *list, &delta);
+    last_all_candidate_words_->Swap(list);
+    list->Swap(&delta);
+  } else {
+    last_all_candidate_words_->CopyFrom(*list);
+  }
+}
+
+void Session::RequestDeferredSuggestion(commands::Command *command) {
+  if (!deferred_suggestion_pending_) {
+    return;
+  }
+  if (context_->state() != ImeContext::COMPOSITION ||
+      command->output().has_callback()) {
+    // The composition has been committed or converted in the same command.
+    deferred_suggestion_pending_ = false;
+    return;
+  }
+  commands::SessionCommand *session_command =
+      command->mutable_output()->mutable_callback()->mutable_session_command();
+  session_command->set_type(commands::SessionCommand::GET_ASYNC_RESULT);
+}
+
 
 void Session::PushUndoContext() {
   // TODO(komatsu): Support multiple undo.
@@ -279,6 +323,10 @@ bool Session::SendCommand(commands::Command *command) {
   SessionUsageStatsUtil::AddSendCommandInputStats(command->input());
 
   const commands::SessionCommand &session_command = command->input().command();
+  if (session_command.type() != commands::SessionCommand::GET_ASYNC_RESULT) {
+    // The deferred suggestions are for the composition before this command.
+    deferred_suggestion_pending_ = false;
+  }
   bool result = false;
   if (session_command.type() == commands::SessionCommand::SWITCH_INPUT_MODE) {
     if (!session_command.has_composition_mode()) {
@@ -375,12 +423,16 @@ bool Session::SendCommand(commands::Command *command) {
     case commands::SessionCommand::TURN_OFF_IME:
       result = MakeSureIMEOff(command);
       break;
+    case commands::SessionCommand::GET_ASYNC_RESULT:
+      result = GetAsyncResult(command);
+      break;
     default:
       LOG(WARNING) << "Unknown command" << command->DebugString();
       result = DoNothing(command);
       break;
   }
 
+  EncodeIncrementalOutput(command);
   return result;
 }
 
@@ -492,6 +544,7 @@ bool Session::SendKey(commands::Command *command) {
 
   SessionUsageStatsUtil::AddSendKeyInputStats(command->input());
 
+  deferred_suggestion_pending_ = false;
   bool result = false;
   switch (context_->state()) {
     case ImeContext::DIRECT:
@@ -516,6 +569,8 @@ bool Session::SendKey(commands::Command *command) {
   }
 
   SessionUsageStatsUtil::AddSendKeyOutputStats(command->output());
+  RequestDeferredSuggestion(command);
+  EncodeIncrementalOutput(command);
 
   return result;
 }
@@ -1965,6 +2020,21 @@ bool Session::Suggest(const commands::Input &input) {
     return false;
   }
 
+  if (input.type() == commands::Input::SEND_KEY &&
+      context_->client_capability().deferred_suggestion() &&
+      input.request_suggestion() &&
+      context_->composer().GetInputFieldType() != commands::Context::PASSWORD) {
+    // Answers the key with the preedit only.  The suggestions are computed
+    // when the client sends GET_ASYNC_RESULT, unless another key comes
+    // first.
+    deferred_suggestion_pending_ = true;
+    ConversionPreferences conversion_preferences =
+        context_->converter().conversion_preferences();
+    conversion_preferences.request_suggestion = false;
+    return context_->mutable_converter()->SuggestWithPreferences(
+        context_->composer(), conversion_preferences);
+  }
+
   // |reuqest_suggestion| is not supposed to always ensure suppressing
   // suggestion since this field is used for performance improvement
   // by skipping interim suggestions.  However, the implementation of
@@ -2671,6 +2741,17 @@ bool Session::ExpandSuggestion(commands::Command *command) {
   return true;
 }
 
+bool Session::GetAsyncResult(commands::Command *command) {
+  command->mutable_output()->set_consumed(true);
+  if (deferred_suggestion_pending_ &&
+      context_->state() == ImeContext::COMPOSITION) {
+    context_->mutable_converter()->Suggest(context_->composer());
+  }
+  deferred_suggestion_pending_ = false;
+  Output(command);
+  return true;
+}
+
 void Session::OutputFromState(commands::Command *command) {
   if (context_->state() == ImeContext::PRECOMPOSITION) {
     OutputMode(command);
@@ -47,6 +47,7 @@
         '../converter/converter_base.gyp:converter_util',
         '../transliteration/transliteration.gyp:transliteration',
         '../usage_stats/usage_stats_base.gyp:usage_stats',
+        'session_base.gyp:candidate_list_delta',
         'session_base.gyp:key_parser',
         'session_base.gyp:keymap',
         'session_base.gyp:keymap_factory',
@@ -46,6 +46,7 @@
 namespace mozc {
 namespace commands {
 class ApplicationInfo;
+class CandidateList;
 class Capability;
 class Command;
 class Input;
@@ -170,6 +171,11 @@ class Session : public SessionInterface {
   // Expands suggestion candidates.
   bool ExpandSuggestion(mozc::commands::Command *command);
 
+  // Computes the suggestions deferred by the last key, if any, and returns
+  // the current output.  This function is called when the GET_ASYNC_RESULT
+  // SessionCommand is called.
+  bool GetAsyncResult(mozc::commands::Command *command);
+
   // Commits only the first segment.
   bool CommitSegment(mozc::commands::Command *command);
   // Commits some characters at the head of the preedit.
@@ -289,8 +295,25 @@ class Session : public SessionInterface {
   scoped_ptr<ImeContext> context_;
   scoped_ptr<ImeContext> prev_context_;
 
+  // The last Output::all_candidate_words sent to the client, which is the
+  // base of the next incremental update.
+  scoped_ptr<commands::CandidateList> last_all_candidate_words_;
+  uint32 all_candidate_words_sequence_number_;
+
+  // True while the suggestions for the current composition are deferred to
+  // GET_ASYNC_RESULT.  Any other command clears it.
+  bool deferred_suggestion_pending_;
+
   void InitContext(ImeContext *context) const;
 
+  // Replaces Output::all_candidate_words with an incremental update when the
+  // client supports it.
+  void EncodeIncrementalOutput(commands::Command *command);
+
+  // Asks the client to send GET_ASYNC_RESULT when the suggestions are
+  // deferred by this command.
+  void RequestDeferredSuggestion(commands::Command *command);
+
   void PushUndoContext();
   void PopUndoContext();
   void ClearUndoContext();
@@ -129,6 +129,17 @@
         'session_protocol',
       ],
     },
+    {
+      'target_name': 'candidate_list_delta',
+      'type': 'static_library',
+      'sources': [
+        'candidate_list_delta.cc',
+      ],
+      'dependencies': [
+        '../base/base.gyp:base',
+        'session_protocol',
+      ],
+    },
     {
       'target_name': 'output_util',
       'type': 'static_library',
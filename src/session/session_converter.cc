@@ -65,6 +65,10 @@ DEFINE_bool(use_actual_converter_for_realtime_conversion,
             "If true, use the actual (non-immutable) converter for real "
             "time conversion.");
 
+DEFINE_int32(suggestion_latency_budget_msec, 0,
+             "If positive, the suggestion on each key returns the candidates "
+             "found within this budget in milliseconds.");
+
 namespace mozc {
 namespace session {
 
@@ -112,6 +116,9 @@ SessionConverter::SessionConverter(const ConverterInterface *converter,
   conversion_preferences_.request_suggestion = true;
   operation_preferences_.use_cascading_window = true;
   operation_preferences_.candidate_shortcuts.clear();
+  // |segments_| lives as long as the session, so keep the candidates of the
+  // previous conversion for reuse.
+  segments_->set_recycling_enabled(true);
 }
 
 SessionConverter::~SessionConverter() {}
@@ -150,12 +157,15 @@ bool SessionConverter::ConvertWithPreferences(
   SetConversionPreferences(preferences, segments_.get());
 
   const ConversionRequest conversion_request(&composer, request_);
+  const size_t allocation_count = segments_->allocation_count();
   if (!converter_->StartConversionForRequest(conversion_request,
                                              segments_.get())) {
     LOG(WARNING) << "StartConversionForRequest() failed";
     ResetState();
     return false;
   }
+  VLOG(2) << "StartConversionForRequest() allocations: "
+          << segments_->allocation_count() - allocation_count;
 
   segment_index_ = 0;
   state_ = CONVERSION;
@@ -421,6 +431,11 @@ bool SessionConverter::SuggestWithPreferences(
   SetConversionPreferences(preferences, segments_.get());
 
   ConversionRequest conversion_request(&composer, request_);
+  if (FLAGS_suggestion_latency_budget_msec > 0) {
+    conversion_request.set_latency_budget_msec(
+        FLAGS_suggestion_latency_budget_msec);
+  }
+  const size_t allocation_count = segments_->allocation_count();
   const size_t cursor = composer.GetCursor();
   if (cursor == composer.GetLength() || cursor == 0 ||
       !request_->mixed_conversion()) {
@@ -455,6 +470,8 @@ bool SessionConverter::SuggestWithPreferences(
     }
   }
   DCHECK_EQ(1, segments_->conversion_segments_size());
+  VLOG(2) << "StartSuggestionForRequest() allocations: "
+          << segments_->allocation_count() - allocation_count;
 
   // Copy current suggestions so that we can merge
   // prediction/suggestions later
@@ -572,6 +589,7 @@ bool SessionConverter::ExpandSuggestionWithPreferences(
 
   ConversionRequest conversion_request(&composer, request_);
 
+  const size_t allocation_count = segments_->allocation_count();
   const size_t cursor = composer.GetCursor();
   if (cursor == composer.GetLength() || cursor == 0 ||
       !request_->mixed_conversion()) {
@@ -596,6 +614,8 @@ bool SessionConverter::ExpandSuggestionWithPreferences(
       return false;
     }
   }
+  VLOG(2) << "StartPredictionForRequest() allocations: "
+          << segments_->allocation_count() - allocation_count;
   // Overwrite the request type to SUGGESTION.
   // Without this logic, a candidate gets focused that is unexpected behavior.
   segments_->set_request_type(Segments::SUGGESTION);
@@ -36,9 +36,11 @@
 #include <vector>
 
 #include "base/base.h"
+#include "base/executor.h"
 #include "base/logging.h"
 #include "base/process.h"
 #include "base/singleton.h"
+#include "base/startup_trace.h"
 #include "base/stopwatch.h"
 #include "base/util.h"
 #include "composer/table.h"
@@ -88,6 +90,11 @@ DEFINE_int32(last_create_session_timeout, 300,
              "\"last_create_session_timeout\" sec "
              "after create session command");
 
+DEFINE_int32(memory_trim_idle_timeout, 1800,
+             "release the memory of the components reloaded on demand "
+             "if no command is executed for \"memory_trim_idle_timeout\" sec. "
+             "0 disables it");
+
 DEFINE_bool(restricted, false,
             "Launch server with restricted setting");
 
@@ -129,6 +136,7 @@ SessionHandler::SessionHandler(EngineInterface *engine)
       last_session_empty_time_(Util::GetTime()),
       last_cleanup_time_(0),
       last_create_session_time_(0),
+      last_memory_trim_time_(0),
       engine_(engine),
       observer_handler_(new session::SessionObserverHandler()),
       stopwatch_(new Stopwatch),
@@ -489,6 +497,12 @@ bool SessionHandler::EvalCommand(commands::Command *command) {
     case commands::Input::SEND_USER_DICTIONARY_COMMAND:
       eval_succeeded = SendUserDictionaryCommand(command);
       break;
+    case commands::Input::GET_BACKGROUND_TASKS:
+      eval_succeeded = GetBackgroundTasks(command);
+      break;
+    case commands::Input::TRIM_MEMORY:
+      eval_succeeded = TrimMemory(command);
+      break;
     case commands::Input::NO_OPERATION:
       eval_succeeded = NoOperation(command);
       break;
@@ -577,6 +591,7 @@ bool SessionHandler::CreateSession(commands::Command *command) {
   }
 
   last_create_session_time_ = current_time;
+  const uint64 trace_start_usec = StartupTrace::GetCurrentTimeUsec();
 
   // if session map is FULL, remove the oldest item from the LRU
   SessionElement *oldest_element = NULL;
@@ -630,6 +645,10 @@ bool SessionHandler::CreateSession(commands::Command *command) {
 
   UsageStats::IncrementCount("SessionCreated");
 
+  // The start-up is over once the first session is served.
+  StartupTrace::AddEvent("SessionHandler::CreateSession", trace_start_usec);
+  StartupTrace::Finish();
+
   return true;
 }
 
@@ -677,11 +696,17 @@ bool SessionHandler::Cleanup(commands::Command *command) {
       suspend_time +
       max(10, min(FLAGS_last_command_timeout, 7200));
 
+  // The last time when the engine was used.  Idle sessions are also taken
+  // into account, as they will be removed below.
+  uint64 last_active_time = last_session_empty_time_;
   vector<SessionID> remove_ids;
   for (SessionElement *element =
            const_cast<SessionElement *>(session_map_->Head());
        element != NULL; element = element->next) {
     session::SessionInterface *session = element->value;
+    last_active_time = max(last_active_time,
+                           max(session->create_session_time(),
+                               session->last_command_time()));
     if (!IsApplicationAlive(session)) {
       VLOG(2) << "Application is not alive. Removing: " << element->key;
       remove_ids.push_back(element->key);
@@ -707,6 +732,16 @@ bool SessionHandler::Cleanup(commands::Command *command) {
   // Sync all data. This is a regression bug fix http://b/3033708
   engine_->GetUserDataManager()->Sync();
 
+  // Release the memory which is reloaded on demand once per idle period.
+  if (FLAGS_memory_trim_idle_timeout > 0 &&
+      last_active_time > last_memory_trim_time_ &&
+      (current_time - last_active_time) >=
+      suspend_time + FLAGS_memory_trim_idle_timeout) {
+    // The released components are not reported in the reply to CLEANUP.
+    commands::Command trim_command;
+    TrimMemory(&trim_command);
+  }
+
   // timeout is enabled.
   if (FLAGS_timeout > 0 &&
       last_session_empty_time_ != 0 &&
@@ -734,6 +769,41 @@ bool SessionHandler::SendUserDictionaryCommand(commands::Command *command) {
   return result;
 }
 
+bool SessionHandler::GetBackgroundTasks(commands::Command *command) {
+  vector<Executor::TaskInfo> infos;
+  Executor::GetInstance()->GetTaskInfo(&infos);
+  for (size_t i = 0; i < infos.size(); ++i) {
+    const Executor::TaskInfo &info = infos[i];
+    commands::BackgroundTask *task =
+        command->mutable_output()->add_background_tasks();
+    task->set_name(info.name);
+    task->set_priority(
+        static_cast<commands::BackgroundTask::Priority>(info.priority));
+    task->set_state(static_cast<commands::BackgroundTask::State>(info.state));
+    task->set_latency_usec(info.latency_usec);
+    task->set_run_count(info.run_count);
+    task->set_last_queue_latency_usec(info.last_queue_latency_usec);
+    task->set_last_run_usec(info.last_run_usec);
+  }
+  return true;
+}
+
+bool SessionHandler::TrimMemory(commands::Command *command) {
+  vector<TrimmedComponent> components;
+  engine_->TrimMemory(&components);
+  for (size_t i = 0; i < components.size(); ++i) {
+    const TrimmedComponent &component = components[i];
+    commands::TrimmedComponent *trimmed_component =
+        command->mutable_output()->add_trimmed_components();
+    trimmed_component->set_name(component.name);
+    trimmed_component->set_resident_size_before(
+        component.resident_size_before);
+    trimmed_component->set_resident_size_after(component.resident_size_after);
+  }
+  last_memory_trim_time_ = Util::GetTime();
+  return true;
+}
+
 bool SessionHandler::NoOperation(commands::Command *command) {
   return true;
 }
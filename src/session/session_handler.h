@@ -98,6 +98,7 @@ class SessionHandler : public SessionHandlerInterface {
 
  private:
   FRIEND_TEST(SessionHandlerTest, StorageTest);
+  FRIEND_TEST(SessionHandlerTest, TrimMemoryAfterIdle);
 
   typedef mozc::storage::LRUCache<SessionID, session::SessionInterface*>
       SessionMap;
@@ -129,6 +130,8 @@ class SessionHandler : public SessionHandlerInterface {
   bool ClearStorage(commands::Command *command);
   bool Cleanup(commands::Command *command);
   bool SendUserDictionaryCommand(commands::Command *command);
+  bool GetBackgroundTasks(commands::Command *command);
+  bool TrimMemory(commands::Command *command);
   bool NoOperation(commands::Command *command);
 
   SessionID CreateNewSessionID();
@@ -147,6 +150,7 @@ class SessionHandler : public SessionHandlerInterface {
   uint64 last_session_empty_time_;
   uint64 last_cleanup_time_;
   uint64 last_create_session_time_;
+  uint64 last_memory_trim_time_;
 
   EngineInterface *engine_;
   scoped_ptr<session::SessionObserverHandler> observer_handler_;
@@ -32,11 +32,14 @@
 #include <vector>
 
 #include "base/clock_mock.h"
+#include "base/executor.h"
 #include "base/port.h"
 #include "base/util.h"
 #include "config/config.pb.h"
 #include "config/config_handler.h"
+#include "converter/converter_interface.h"
 #include "converter/converter_mock.h"
+#include "converter/segments.h"
 #include "engine/mock_converter_engine.h"
 #include "engine/mock_data_engine_factory.h"
 #include "engine/user_data_manager_mock.h"
@@ -53,6 +56,8 @@ DECLARE_int32(max_session_size);
 DECLARE_int32(create_session_min_interval);
 DECLARE_int32(last_command_timeout);
 DECLARE_int32(last_create_session_timeout);
+DECLARE_int32(memory_trim_idle_timeout);
+DECLARE_bool(warmup_rewriters);
 
 
 namespace mozc {
@@ -459,4 +464,129 @@ TEST_F(SessionHandlerTest, StorageTest) {
   }
 }
 
+namespace {
+class NopTask : public Executor::Task {
+ public:
+  virtual void Run() {}
+};
+}  // namespace
+
+TEST_F(SessionHandlerTest, GetBackgroundTasks) {
+  scoped_ptr<EngineInterface> engine(MockDataEngineFactory::Create());
+  SessionHandler handler(engine.get());
+
+  NopTask task;
+  const Executor::TaskId id = Executor::GetInstance()->Schedule(
+      "SessionHandlerTestTask", &task, Executor::LOW, 60 * 1000, 0);
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::GET_BACKGROUND_TASKS);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_TRUE(Executor::GetInstance()->Cancel(id));
+
+  bool found = false;
+  for (size_t i = 0; i < command.output().background_tasks_size(); ++i) {
+    const commands::BackgroundTask &background_task =
+        command.output().background_tasks(i);
+    if (background_task.name() != "SessionHandlerTestTask") {
+      continue;
+    }
+    found = true;
+    EXPECT_EQ(commands::BackgroundTask::LOW, background_task.priority());
+    EXPECT_EQ(commands::BackgroundTask::WAITING, background_task.state());
+    EXPECT_LT(0, background_task.latency_usec());
+    EXPECT_EQ(0, background_task.run_count());
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST_F(SessionHandlerTest, TrimMemory) {
+  scoped_ptr<EngineInterface> engine(MockDataEngineFactory::Create());
+  SessionHandler handler(engine.get());
+  engine->GetUserDataManager()->WaitForSyncerForTest();
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::TRIM_MEMORY);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  ASSERT_EQ(1, command.output().trimmed_components_size());
+  EXPECT_EQ("UserHistoryPredictor",
+            command.output().trimmed_components(0).name());
+
+  // Nothing is left to be released.
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::TRIM_MEMORY);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(0, command.output().trimmed_components_size());
+}
+
+TEST_F(SessionHandlerTest, TrimMemoryReleasesRewriterIndex) {
+  // The index would be built again in the background after the conversion.
+  const bool original_warmup_rewriters = FLAGS_warmup_rewriters;
+  FLAGS_warmup_rewriters = false;
+  scoped_ptr<EngineInterface> engine(MockDataEngineFactory::Create());
+  SessionHandler handler(engine.get());
+  engine->GetUserDataManager()->WaitForSyncerForTest();
+
+  // The conversion builds the index of the symbol rewriter.
+  Segments segments;
+  EXPECT_TRUE(engine->GetConverter()->StartConversion(&segments, "a"));
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::TRIM_MEMORY);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  ASSERT_EQ(2, command.output().trimmed_components_size());
+  EXPECT_EQ("UserHistoryPredictor",
+            command.output().trimmed_components(0).name());
+  EXPECT_EQ("Rewriter", command.output().trimmed_components(1).name());
+
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::TRIM_MEMORY);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(0, command.output().trimmed_components_size());
+
+  FLAGS_warmup_rewriters = original_warmup_rewriters;
+}
+
+TEST_F(SessionHandlerTest, TrimMemoryAfterIdle) {
+  const int32 original_timeout = FLAGS_memory_trim_idle_timeout;
+  const int32 timeout = FLAGS_memory_trim_idle_timeout = 10;  // 10 sec
+  ClockMock clock(1000, 0);
+  Util::SetClockHandler(&clock);
+
+  scoped_ptr<EngineInterface> engine(MockDataEngineFactory::Create());
+  SessionHandler handler(engine.get());
+  engine->GetUserDataManager()->WaitForSyncerForTest();
+  uint64 id = 0;
+  EXPECT_TRUE(CreateSession(&handler, &id));
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::CLEANUP);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(0, handler.last_memory_trim_time_);
+
+  clock.PutClockForward(timeout, 0);
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::CLEANUP);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  const uint64 trim_time = handler.last_memory_trim_time_;
+  EXPECT_EQ(Util::GetTime(), trim_time);
+  // The released components are not reported in the reply to CLEANUP.
+  EXPECT_EQ(0, command.output().trimmed_components_size());
+
+  // The memory is released only once while the server is idle.
+  clock.PutClockForward(timeout, 0);
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::CLEANUP);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(trim_time, handler.last_memory_trim_time_);
+
+  // Nothing is left to be released.
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::TRIM_MEMORY);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(0, command.output().trimmed_components_size());
+
+  FLAGS_memory_trim_idle_timeout = original_timeout;
+}
+
 }  // namespace mozc
@@ -2415,6 +2415,139 @@ TEST_F(SessionTest, OutputAllCandidateWords) {
   }
 }
 
+TEST_F(SessionTest, IncrementalAllCandidateWords) {
+  scoped_ptr<Session> session(new Session(engine_.get()));
+  InitSessionToPrecomposition(session.get());
+  commands::Capability capability;
+  capability.set_incremental_all_candidate_words(true);
+  session->set_client_capability(capability);
+  commands::Command command;
+
+  Segments segments;
+  SetAiueo(&segments);
+  InsertCharacterChars("aiueo", session.get(), &command);
+
+  ConversionRequest request;
+  SetComposer(session.get(), &request);
+  FillT13Ns(request, &segments);
+  GetConverterMock()->SetStartConversionForRequest(&segments, true);
+
+  // The first list is sent as it is.
+  SendKey("Space", session.get(), &command);
+  ASSERT_TRUE(command.output().has_all_candidate_words());
+  commands::CandidateList first_list;
+  first_list.CopyFrom(command.output().all_candidate_words());
+  EXPECT_TRUE(first_list.has_sequence_number());
+  EXPECT_FALSE(first_list.has_base_sequence_number());
+  EXPECT_LT(1, first_list.candidates_size());
+
+  // Moving the focus sends only the focused index against the first list.
+  ASSERT_TRUE(SetSendKeyCommand("Space", &command));
+  command.mutable_input()->set_all_candidate_words_sequence_number(
+      first_list.sequence_number());
+  session->SendKey(&command);
+  {
+    const commands::CandidateList &delta =
+        command.output().all_candidate_words();
+    EXPECT_EQ(first_list.sequence_number(), delta.base_sequence_number());
+    EXPECT_NE(first_list.sequence_number(), delta.sequence_number());
+    EXPECT_EQ(first_list.candidates_size(), delta.copied_prefix_size());
+    EXPECT_EQ(0, delta.candidates_size());
+    EXPECT_EQ(1, delta.focused_index());
+  }
+
+  // Without the sequence number, the complete list is sent.
+  SendKey("Space", session.get(), &command);
+  {
+    const commands::CandidateList &list =
+        command.output().all_candidate_words();
+    EXPECT_FALSE(list.has_base_sequence_number());
+    EXPECT_EQ(first_list.candidates_size(), list.candidates_size());
+    EXPECT_EQ(2, list.focused_index());
+  }
+}
+
+TEST_F(SessionTest, DeferredSuggestion) {
+  scoped_ptr<Session> session(new Session(engine_.get()));
+  InitSessionToPrecomposition(session.get());
+  commands::Capability capability;
+  capability.set_deferred_suggestion(true);
+  session->set_client_capability(capability);
+  commands::Command command;
+
+  Segments segments;
+  SetAiueo(&segments);
+  GetConverterMock()->SetStartSuggestionForRequest(&segments, true);
+
+  // The key is answered with the preedit and a request to fetch the
+  // suggestions.
+  SendKey("a", session.get(), &command);
+  // "あ"
+  EXPECT_PREEDIT("\xE3\x81\x82", command);
+  EXPECT_FALSE(command.output().has_candidates());
+  ASSERT_TRUE(command.output().has_callback());
+  EXPECT_EQ(commands::SessionCommand::GET_ASYNC_RESULT,
+            command.output().callback().session_command().type());
+
+  SendCommand(commands::SessionCommand::GET_ASYNC_RESULT, session.get(),
+              &command);
+  EXPECT_PREEDIT("\xE3\x81\x82", command);
+  ASSERT_TRUE(command.output().has_candidates());
+  EXPECT_EQ(kAiueo, command.output().candidates().candidate(0).value());
+  EXPECT_FALSE(command.output().has_callback());
+
+  // The converter returns other candidates from now on, so that a search
+  // made by a stale GET_ASYNC_RESULT shows up in the output.
+  Segments stale_segments;
+  SetLike(&stale_segments);
+  GetConverterMock()->SetStartSuggestionForRequest(&stale_segments, true);
+
+  // A duplicated GET_ASYNC_RESULT does not search again.
+  SendCommand(commands::SessionCommand::GET_ASYNC_RESULT, session.get(),
+              &command);
+  EXPECT_PREEDIT("\xE3\x81\x82", command);
+  ASSERT_TRUE(command.output().has_candidates());
+  EXPECT_EQ(kAiueo, command.output().candidates().candidate(0).value());
+
+  // Another command sent before GET_ASYNC_RESULT drops the suggestions
+  // deferred by the key, so GET_ASYNC_RESULT only returns the preedit.
+  SendKey("i", session.get(), &command);
+  ASSERT_TRUE(command.output().has_callback());
+  EXPECT_FALSE(command.output().has_candidates());
+  commands::Rectangle rectangle;
+  rectangle.set_x(0);
+  rectangle.set_y(0);
+  rectangle.set_width(1);
+  rectangle.set_height(1);
+  SetCaretLocation(rectangle, session.get());
+  SendCommand(commands::SessionCommand::GET_ASYNC_RESULT, session.get(),
+              &command);
+  // "あい"
+  EXPECT_PREEDIT("\xE3\x81\x82\xE3\x81\x84", command);
+  EXPECT_FALSE(command.output().has_candidates());
+  SendKey("Backspace", session.get(), &command);
+
+  // A newer key cancels the suggestions deferred by the previous one, so
+  // the stale GET_ASYNC_RESULT only returns the current output.
+  SendKey("i", session.get(), &command);
+  ASSERT_TRUE(command.output().has_callback());
+  GetConverterMock()->SetStartConversionForRequest(&segments, true);
+  SendKey("Space", session.get(), &command);
+  EXPECT_FALSE(command.output().has_callback());
+  EXPECT_EQ(ImeContext::CONVERSION, session->context().state());
+  SendCommand(commands::SessionCommand::GET_ASYNC_RESULT, session.get(),
+              &command);
+  EXPECT_EQ(ImeContext::CONVERSION, session->context().state());
+  EXPECT_TRUE(command.output().has_preedit());
+
+  // Suggestions are not deferred when the client does not ask for them.
+  SendKey("ESC", session.get(), &command);
+  ASSERT_TRUE(SetSendKeyCommand("u", &command));
+  command.mutable_input()->set_request_suggestion(false);
+  session->SendKey(&command);
+  EXPECT_FALSE(command.output().has_callback());
+}
+
 TEST_F(SessionTest, UndoForComposition) {
   Session session(engine_.get());
   InitSessionToPrecomposition(&session);
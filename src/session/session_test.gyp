@@ -149,6 +149,7 @@
       'target_name': 'session_module_test',
       'type': 'executable',
       'sources': [
+        'candidate_list_delta_test.cc',
         'output_util_test.cc',
         'session_observer_handler_test.cc',
         'session_usage_observer_test.cc',
@@ -167,6 +168,7 @@
         'session.gyp:session_handler',
         'session.gyp:session_usage_observer',
         'session_base.gyp:keymap',
+        'session_base.gyp:candidate_list_delta',
         'session_base.gyp:keymap_factory',
         'session_base.gyp:output_util',
         'session_base.gyp:session_protocol',
@@ -87,6 +87,9 @@ uint32 GetDuration(uint64 base_value) {
 }  // namespace
 
 SessionUsageObserver::SessionUsageObserver() {
+  // Stats updated on every key event are aggregated in memory and written
+  // into the registry by the following job.
+  UsageStats::EnableInMemoryAggregation();
   Scheduler::AddJob(Scheduler::JobSetting(
       kStatsJobName,
       kSaveCacheStatsInterval,  // default interval
@@ -98,8 +101,11 @@ SessionUsageObserver::SessionUsageObserver() {
 }
 
 SessionUsageObserver::~SessionUsageObserver() {
-  SaveCachedStats(&usage_cache_);
   Scheduler::RemoveJob(kStatsJobName);
+  // Other observers may still aggregate the stats. The pending values are
+  // merged by Sync() in SaveCachedStats() in either case.
+  UsageStats::DisableInMemoryAggregation();
+  SaveCachedStats(&usage_cache_);
 }
 
 void SessionUsageObserver::UsageCache::Clear() {
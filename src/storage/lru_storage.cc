@@ -505,7 +505,13 @@ const char* LRUStorage::Lookup(const string &key) const {
 
 const char* LRUStorage::Lookup(const string &key,
                                uint32 *last_access_time) const {
-  const uint64 fp = Util::FingerprintWithSeed(key.data(), key.size(), seed_);
+  return LookupByFingerprint(
+      Util::FingerprintWithSeed(key.data(), key.size(), seed_),
+      last_access_time);
+}
+
+const char* LRUStorage::LookupByFingerprint(uint64 fp,
+                                            uint32 *last_access_time) const {
   map<uint64, Node *>::const_iterator it = map_.find(fp);
   if (it == map_.end()) {
     return NULL;
@@ -548,11 +554,15 @@ bool LRUStorage::Touch(const string &key) {
 }
 
 bool LRUStorage::Insert(const string &key, const char *value) {
+  return InsertByFingerprint(
+      Util::FingerprintWithSeed(key.data(), key.size(), seed_), value);
+}
+
+bool LRUStorage::InsertByFingerprint(uint64 fp, const char *value) {
   if (lru_list_.get() == NULL) {
     return false;
   }
 
-  const uint64 fp = Util::FingerprintWithSeed(key.data(), key.size(), seed_);
   map<uint64, Node *>::iterator it = map_.find(fp);
   if (it != map_.end()) {     // find in the cache
     Update(it->second->value, fp, value, value_size_);
@@ -586,11 +596,15 @@ bool LRUStorage::Insert(const string &key, const char *value) {
 }
 
 bool LRUStorage::TryInsert(const string &key, const char *value) {
+  return TryInsertByFingerprint(
+      Util::FingerprintWithSeed(key.data(), key.size(), seed_), value);
+}
+
+bool LRUStorage::TryInsertByFingerprint(uint64 fp, const char *value) {
   if (lru_list_.get() == NULL) {
     return false;
   }
 
-  const uint64 fp = Util::FingerprintWithSeed(key.data(), key.size(), seed_);
   map<uint64, Node *>::iterator it = map_.find(fp);
   if (it != map_.end()) {     // find in the cache
     Update(it->second->value, fp, value, value_size_);
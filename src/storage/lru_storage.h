@@ -88,6 +88,14 @@ class LRUStorage {
   bool TryInsert(const string &key,
                  const char *value);
 
+  // Same as Lookup(), Insert() and TryInsert() but take the fingerprint of
+  // the key instead of the key itself. |fp| must be computed with seed(),
+  // e.g., Util::FingerprintWithSeed(key, seed()) or FingerprintBuilder.
+  const char *LookupByFingerprint(uint64 fp,
+                                  uint32 *last_access_time) const;
+  bool InsertByFingerprint(uint64 fp, const char *value);
+  bool TryInsertByFingerprint(uint64 fp, const char *value);
+
   size_t value_size() const;
   size_t size() const;
   size_t used_size() const;
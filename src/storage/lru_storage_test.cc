@@ -189,6 +189,39 @@ TEST_F(LRUStorageTest, ReadWriteTest) {
   }
 }
 
+TEST_F(LRUStorageTest, LookupByFingerprint) {
+  const string file = GetTemporaryFilePath();
+  LRUStorage::CreateStorageFile(file.c_str(), 4, 10, 0x76fef);
+  LRUStorage storage;
+  EXPECT_TRUE(storage.Open(file.c_str()));
+
+  const string kKey = "key";
+  const uint64 fp = Util::FingerprintWithSeed(kKey, storage.seed());
+  uint32 last_access_time = 0;
+  EXPECT_TRUE(storage.LookupByFingerprint(fp, &last_access_time) == NULL);
+
+  // TryInsert* doesn't insert a new entry.
+  EXPECT_TRUE(storage.TryInsertByFingerprint(fp, "abcd"));
+  EXPECT_TRUE(storage.Lookup(kKey) == NULL);
+
+  // The entry inserted by fingerprint can be looked up by key, and vice
+  // versa.
+  EXPECT_TRUE(storage.InsertByFingerprint(fp, "abcd"));
+  const char *value = storage.Lookup(kKey);
+  ASSERT_TRUE(value != NULL);
+  EXPECT_EQ("abcd", string(value, 4));
+
+  EXPECT_TRUE(storage.Insert(kKey, "efgh"));
+  value = storage.LookupByFingerprint(fp, &last_access_time);
+  ASSERT_TRUE(value != NULL);
+  EXPECT_EQ("efgh", string(value, 4));
+
+  EXPECT_TRUE(storage.TryInsertByFingerprint(fp, "ijkl"));
+  value = storage.Lookup(kKey);
+  ASSERT_TRUE(value != NULL);
+  EXPECT_EQ("ijkl", string(value, 4));
+}
+
 TEST_F(LRUStorageTest, Merge) {
   const string file1 = GetTemporaryFilePath() + ".tmp1";
   const string file2 = GetTemporaryFilePath() + ".tmp2";
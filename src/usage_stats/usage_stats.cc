@@ -31,8 +31,13 @@
 
 #include <algorithm>
 #include <numeric>
+#include <utility>
+#include <vector>
 
+#include "base/hash_tables.h"
 #include "base/logging.h"
+#include "base/mutex.h"
+#include "base/singleton.h"
 #include "config/stats_config_util.h"
 #include "storage/registry.h"
 #include "usage_stats/usage_stats.pb.h"
@@ -105,18 +110,225 @@ bool SetterInternal(const string &name, const Stats &stats) {
   }
   return true;
 }
-}  // namespace
 
-bool UsageStats::IsListed(const string &name) {
-  for (size_t i = 0; i < arraysize(kStatsList); ++i) {
-    if (name == kStatsList[i]) {
-      return true;
+// Adds |val| to the COUNT stats in the registry.
+void IncrementCountInRegistry(const string &name, uint32 val) {
+  Stats stats;
+  if (GetterInternal(name, Stats::COUNT, &stats)) {
+    stats.set_count(stats.count() + val);
+  } else {
+    stats.set_name(name);
+    stats.set_type(Stats::COUNT);
+    stats.set_count(val);
+  }
+
+  SetterInternal(name, stats);
+}
+
+// Adds |num_timings| timings of |total_time| in total to the TIMING stats in
+// the registry.
+void UpdateTimingInRegistry(const string &name, uint32 num_timings,
+                            uint64 total_time, uint32 min_time,
+                            uint32 max_time) {
+  Stats stats;
+  if (GetterInternal(name, Stats::TIMING, &stats)) {
+    stats.set_num_timings(stats.num_timings() + num_timings);
+    stats.set_total_time(stats.total_time() + total_time);
+    stats.set_avg_time(stats.total_time() / stats.num_timings());
+    stats.set_min_time(min(stats.min_time(), min_time));
+    stats.set_max_time(max(stats.max_time(), max_time));
+  } else {
+    stats.set_name(name);
+    stats.set_type(Stats::TIMING);
+    stats.set_num_timings(num_timings);
+    stats.set_total_time(total_time);
+    stats.set_avg_time(total_time / num_timings);
+    stats.set_min_time(min_time);
+    stats.set_max_time(max_time);
+  }
+
+  SetterInternal(name, stats);
+}
+
+// Aggregates COUNT and TIMING stats in memory while in-memory aggregation is
+// enabled. Updating a stats costs a hash lookup and a few additions under
+// the lock, instead of parsing and serializing the protobuf and inserting
+// it into the registry. The aggregated values are merged into the registry
+// by Flush().
+class StatsAggregator {
+ public:
+  StatsAggregator() : enable_count_(0) {
+    for (size_t i = 0; i < arraysize(kStatsList); ++i) {
+      index_[kStatsList[i]] = i;
+    }
+    ClearEntries();
+  }
+
+  bool IsListed(const string &name) const {
+    return index_.find(name) != index_.end();
+  }
+
+  void Enable() {
+    scoped_lock l(&mutex_);
+    ++enable_count_;
+  }
+
+  // Merges the aggregated values into the registry when the last reference
+  // is released. The values are taken in the same critical section as the
+  // aggregation is disabled, so that no update falls in between.
+  void Disable() {
+    vector<pair<size_t, Entry> > entries;
+    {
+      scoped_lock l(&mutex_);
+      DCHECK_GT(enable_count_, 0);
+      if (enable_count_ == 0 || --enable_count_ > 0) {
+        return;
+      }
+      TakeEntries(&entries);
+    }
+    WriteEntries(entries);
+  }
+
+  // Returns false if the in-memory aggregation is disabled.
+  bool IncrementCountBy(const string &name, uint32 val) {
+    scoped_lock l(&mutex_);
+    Entry *entry = GetEntry(name);
+    if (entry == NULL) {
+      return false;
+    }
+    entry->count += val;
+    entry->has_count = true;
+    return true;
+  }
+
+  // Returns false if the in-memory aggregation is disabled.
+  bool UpdateTiming(const string &name, uint32 val) {
+    scoped_lock l(&mutex_);
+    Entry *entry = GetEntry(name);
+    if (entry == NULL) {
+      return false;
+    }
+    if (entry->num_timings == 0) {
+      entry->min_time = val;
+      entry->max_time = val;
+    } else {
+      entry->min_time = min(entry->min_time, val);
+      entry->max_time = max(entry->max_time, val);
+    }
+    ++entry->num_timings;
+    entry->total_time += val;
+    return true;
+  }
+
+  // Merges the aggregated values into the registry.
+  void Flush() {
+    // Copies the entries so that the registry is updated without blocking
+    // the updates of the stats.
+    vector<pair<size_t, Entry> > entries;
+    {
+      scoped_lock l(&mutex_);
+      TakeEntries(&entries);
+    }
+    WriteEntries(entries);
+  }
+
+  // Discards the aggregated values.
+  void Clear() {
+    scoped_lock l(&mutex_);
+    ClearEntries();
+  }
+
+ private:
+  struct Entry {
+    bool has_count;
+    uint32 count;
+    uint32 num_timings;
+    uint64 total_time;
+    uint32 min_time;
+    uint32 max_time;
+  };
+
+  // Moves the updated entries to |entries|. Must be called under the lock.
+  void TakeEntries(vector<pair<size_t, Entry> > *entries) {
+    for (size_t i = 0; i < arraysize(kStatsList); ++i) {
+      if (entries_[i].has_count || entries_[i].num_timings > 0) {
+        entries->push_back(make_pair(i, entries_[i]));
+      }
+    }
+    ClearEntries();
+  }
+
+  static void WriteEntries(const vector<pair<size_t, Entry> > &entries) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const string name = kStatsList[entries[i].first];
+      const Entry &entry = entries[i].second;
+      if (entry.has_count) {
+        IncrementCountInRegistry(name, entry.count);
+      }
+      if (entry.num_timings > 0) {
+        UpdateTimingInRegistry(name, entry.num_timings, entry.total_time,
+                               entry.min_time, entry.max_time);
+      }
+    }
+  }
+
+  // Returns NULL if the in-memory aggregation is disabled or |name| is not
+  // listed. Must be called under the lock.
+  Entry *GetEntry(const string &name) {
+    if (enable_count_ == 0) {
+      return NULL;
+    }
+    hash_map<string, size_t>::const_iterator it = index_.find(name);
+    if (it == index_.end()) {
+      return NULL;
+    }
+    return &entries_[it->second];
+  }
+
+  void ClearEntries() {
+    for (size_t i = 0; i < arraysize(kStatsList); ++i) {
+      Entry &entry = entries_[i];
+      entry.has_count = false;
+      entry.count = 0;
+      entry.num_timings = 0;
+      entry.total_time = 0;
+      entry.min_time = 0;
+      entry.max_time = 0;
     }
   }
-  return false;
+
+  Mutex mutex_;
+  int enable_count_;
+  // Maps the name of a stats to its index in kStatsList.
+  hash_map<string, size_t> index_;
+  Entry entries_[arraysize(kStatsList)];
+
+  DISALLOW_COPY_AND_ASSIGN(StatsAggregator);
+};
+
+StatsAggregator *GetAggregator() {
+  return Singleton<StatsAggregator>::get();
+}
+}  // namespace
+
+bool UsageStats::IsListed(const string &name) {
+  return GetAggregator()->IsListed(name);
+}
+
+void UsageStats::EnableInMemoryAggregation() {
+  GetAggregator()->Enable();
+}
+
+void UsageStats::DisableInMemoryAggregation() {
+  GetAggregator()->Disable();
+}
+
+void UsageStats::FlushPendingStats() {
+  GetAggregator()->Flush();
 }
 
 void UsageStats::ClearStats() {
+  GetAggregator()->Clear();
   string stats_str;
   Stats stats;
   for (size_t i = 0; i < arraysize(kStatsList); ++i) {
@@ -139,6 +351,7 @@ void UsageStats::ClearStats() {
 }
 
 void UsageStats::ClearAllStatsForTest() {
+  GetAggregator()->Clear();
   for (size_t i = 0; i < arraysize(kStatsList); ++i) {
     const string key = string(kRegistryPrefix) + kStatsList[i];
     storage::Registry::Erase(key);
@@ -151,16 +364,10 @@ void UsageStats::IncrementCountBy(const string &name, uint32 val) {
     return;
   }
 
-  Stats stats;
-  if (GetterInternal(name, Stats::COUNT, &stats)) {
-    stats.set_count(stats.count() + val);
-  } else {
-    stats.set_name(name);
-    stats.set_type(Stats::COUNT);
-    stats.set_count(val);
+  if (GetAggregator()->IncrementCountBy(name, val)) {
+    return;
   }
-
-  SetterInternal(name, stats);
+  IncrementCountInRegistry(name, val);
 }
 
 void UsageStats::UpdateTiming(const string &name, uint32 val) {
@@ -169,24 +376,10 @@ void UsageStats::UpdateTiming(const string &name, uint32 val) {
     return;
   }
 
-  Stats stats;
-  if (GetterInternal(name, Stats::TIMING, &stats)) {
-    stats.set_num_timings(stats.num_timings() + 1);
-    stats.set_total_time(stats.total_time() + val);
-    stats.set_avg_time(stats.total_time() / stats.num_timings());
-    stats.set_min_time(min(stats.min_time(), val));
-    stats.set_max_time(max(stats.max_time(), val));
-  } else {
-    stats.set_name(name);
-    stats.set_type(Stats::TIMING);
-    stats.set_num_timings(1);
-    stats.set_total_time(val);
-    stats.set_avg_time(val);
-    stats.set_min_time(val);
-    stats.set_max_time(val);
+  if (GetAggregator()->UpdateTiming(name, val)) {
+    return;
   }
-
-  SetterInternal(name, stats);
+  UpdateTimingInRegistry(name, 1, val, val, val);
 }
 
 void UsageStats::SetInteger(const string &name, int val) {
@@ -219,6 +412,7 @@ void UsageStats::SetBoolean(const string &name, bool val) {
 
 bool UsageStats::GetCountForTest(const string &name, uint32 *value) {
   CHECK(value != NULL);
+  FlushPendingStats();
   Stats stats;
   if (!GetterInternal(name, Stats::COUNT, &stats)) {
     return false;
@@ -268,6 +462,7 @@ bool UsageStats::GetTimingForTest(const string &name,
                                   uint32 *avg_time,
                                   uint32 *min_time,
                                   uint32 *max_time) {
+  FlushPendingStats();
   Stats stats;
   if (!GetterInternal(name, Stats::TIMING, &stats)) {
     return false;
@@ -316,6 +511,7 @@ bool UsageStats::GetVirtualKeyboardForTest(const string &name, Stats *stats) {
 }
 
 bool UsageStats::GetStatsForTest(const string &name, Stats *stats) {
+  FlushPendingStats();
   return LoadStats(name, stats);
 }
 
@@ -367,6 +563,7 @@ void UsageStats::StoreTouchEventStats(
 }
 
 bool UsageStats::Sync() {
+  FlushPendingStats();
   if (!storage::Registry::Sync()) {
     LOG(ERROR) << "sync failed";
     return false;
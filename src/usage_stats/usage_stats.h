@@ -83,6 +83,22 @@ class UsageStats {
   // Synchronizes (writes) usage data into disk. Returns false on failure.
   static bool Sync();
 
+  // Enables/disables the in-memory aggregation of count and timing stats.
+  // While enabled, IncrementCountBy() and UpdateTiming() only update the
+  // values in memory, which are merged into the registry by Sync() and
+  // FlushPendingStats(). The caller must call Sync() periodically, e.g.,
+  // from a Scheduler job.
+  // The calls are reference counted: the aggregation stays enabled until
+  // every EnableInMemoryAggregation() is matched by a
+  // DisableInMemoryAggregation(). The last one merges the pending values
+  // and disables the aggregation atomically, so no update is lost.
+  static void EnableInMemoryAggregation();
+  static void DisableInMemoryAggregation();
+
+  // Merges the values aggregated in memory into the registry without
+  // writing them into disk.
+  static void FlushPendingStats();
+
   // Clears existing data exept for Integer and Boolean stats.
   static void ClearStats();
 
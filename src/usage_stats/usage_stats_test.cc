@@ -209,6 +209,82 @@ void SetEventStats(
 }
 }  // namespace
 
+TEST_F(UsageStatsTest, InMemoryAggregation) {
+  const char kCountKey[] = "ShutDown";
+  const char kTimingKey[] = "ElapsedTimeUSec";
+  const string kCountRegistryKey = string("usage_stats.") + kCountKey;
+  const string kTimingRegistryKey = string("usage_stats.") + kTimingKey;
+
+  // Stats already in the registry are merged with the aggregated ones.
+  UsageStats::IncrementCount(kCountKey);
+  UsageStats::UpdateTiming(kTimingKey, 10);
+
+  UsageStats::EnableInMemoryAggregation();
+  UsageStats::IncrementCount(kCountKey);
+  UsageStats::IncrementCountBy(kCountKey, 3);
+  UsageStats::UpdateTiming(kTimingKey, 5);
+  UsageStats::UpdateTiming(kTimingKey, 15);
+
+  // The registry is not updated until flushed.
+  string stats_str;
+  Stats stats;
+  ASSERT_TRUE(storage::Registry::Lookup(kCountRegistryKey, &stats_str));
+  ASSERT_TRUE(stats.ParseFromString(stats_str));
+  EXPECT_EQ(1, stats.count());
+  ASSERT_TRUE(storage::Registry::Lookup(kTimingRegistryKey, &stats_str));
+  ASSERT_TRUE(stats.ParseFromString(stats_str));
+  EXPECT_EQ(1, stats.num_timings());
+
+  UsageStats::FlushPendingStats();
+  ASSERT_TRUE(storage::Registry::Lookup(kCountRegistryKey, &stats_str));
+  ASSERT_TRUE(stats.ParseFromString(stats_str));
+  EXPECT_EQ(5, stats.count());
+
+  uint64 total_time = 0;
+  uint32 num_timings = 0;
+  uint32 avg_time = 0;
+  uint32 min_time = 0;
+  uint32 max_time = 0;
+  EXPECT_TRUE(UsageStats::GetTimingForTest(kTimingKey, &total_time,
+                                           &num_timings, &avg_time,
+                                           &min_time, &max_time));
+  EXPECT_EQ(30, total_time);
+  EXPECT_EQ(3, num_timings);
+  EXPECT_EQ(10, avg_time);
+  EXPECT_EQ(5, min_time);
+  EXPECT_EQ(15, max_time);
+
+  // Getters see the pending values.
+  UsageStats::IncrementCount(kCountKey);
+  uint32 count = 0;
+  EXPECT_TRUE(UsageStats::GetCountForTest(kCountKey, &count));
+  EXPECT_EQ(6, count);
+
+  // ClearStats() discards the pending values as well.
+  UsageStats::IncrementCount(kCountKey);
+  UsageStats::ClearStats();
+  EXPECT_FALSE(UsageStats::GetCountForTest(kCountKey, &count));
+
+  // The aggregation stays enabled until every enabler disables it.
+  UsageStats::EnableInMemoryAggregation();
+  UsageStats::IncrementCount(kCountKey);
+  UsageStats::DisableInMemoryAggregation();
+  EXPECT_FALSE(storage::Registry::Lookup(kCountRegistryKey, &stats_str));
+  UsageStats::IncrementCount(kCountKey);
+
+  // Disabling the aggregation by the last enabler merges the pending values.
+  UsageStats::DisableInMemoryAggregation();
+  ASSERT_TRUE(storage::Registry::Lookup(kCountRegistryKey, &stats_str));
+  ASSERT_TRUE(stats.ParseFromString(stats_str));
+  EXPECT_EQ(2, stats.count());
+
+  // Stats are written into the registry directly after that.
+  UsageStats::IncrementCount(kCountKey);
+  ASSERT_TRUE(storage::Registry::Lookup(kCountRegistryKey, &stats_str));
+  ASSERT_TRUE(stats.ParseFromString(stats_str));
+  EXPECT_EQ(3, stats.count());
+}
+
 TEST_F(UsageStatsTest, StoreTouchEventStats) {
   string stats_str;
   EXPECT_FALSE(storage::Registry::Lookup("usage_stats.VirtualKeyboardStats",
@@ -246,6 +246,7 @@ void UsageStatsUploader::SetClientIdHandler(
 
 void UsageStatsUploader::LoadStats(UploadUtil *uploader) {
   DCHECK(uploader);
+  UsageStats::FlushPendingStats();
   string stats_str;
   Stats stats;
   for (size_t i = 0; i < arraysize(kStatsList); ++i) {